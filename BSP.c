@@ -7,6 +7,13 @@
  ******************************************************/
 
 #include "BSP.h"
+#include <sys/attribs.h>
+#include <sys/kmem.h>
+
+static BSP_DMA_Callback spi1_dma_on_complete;
+static uint8_t spi1_dma_dummy[BSP_SPI1_DMA_MAX_LEN];      // MOSI is not used by the Lepton
+static BSP_DMA_Callback tft_dma_on_complete;
+static BSP_I2C_Callback i2c1_on_complete;
 
 void BSP_Initialize_LEDs()
 {
@@ -76,7 +83,8 @@ void BSP_Initialize_SPI2()
     SPI2CONbits.MODE16 = 0; // Do not use 16-bit mode
     SPI2CONbits.MODE32 = 0; // Do not use 32-bit mode (combines with the above line to activate 8-bit mode)
     SPI2BRG = 0;       // (BRG DISARMED) Set Baud Rate Generator to 0
-    SPI2CONbits.ENHBUF = 0; // Disables Enhanced Buffer mode
+    SPI2CONbits.ENHBUF = 1; // Enables Enhanced Buffer mode, pixels are streamed through the FIFO
+    SPI2CON2bits.IGNROV = 1;// Nobody reads back while streaming, a full receive FIFO must not stop the transfer
     SPI2CONbits.ON = 1;     // Configuration is done, turn on SPI1 peripheral
     
     // TFT2 CS = Pin 29 = RB14
@@ -98,13 +106,417 @@ void BSP_Initialize_SPI2()
     RPB9R = 0b0110;
 }
 
+/******************************************************
+ * PMP Peripheral Configuration for ST7789 TFT
+ * 
+ * Master mode 2 (8080): separate active-low strobes,
+ * only PMWR is used. CS and DC stay on their GPIOs, no
+ * address lines are enabled. The strobe timing keeps a
+ * write cycle above the 66 ns the ST7789 asks for at
+ * PBCLK2 = 100 MHz.
+ ******************************************************/
+#ifdef BSP_CONFIG_TFT_PMP
+
+uint8_t BSP_TFT_Stream_Width = 8;
+
+void BSP_Initialize_PMP()
+{
+    PMCON = 0;              // Turn off the PMP before configuring
+    PMMODE = 0;
+    PMAEN = 0;              // No address lines, RB14/RB15 keep CS and DC
+    
+    PMMODEbits.MODE = 0b10; // Master mode 2, PMRD and PMWR strobes
+    PMMODEbits.MODE16 = (BSP_CONFIG_TFT_PMP == 16);
+    PMMODEbits.WAITB = 1;   // 2 Tpb data setup
+    PMMODEbits.WAITM = 3;   // 4 Tpb WRX low
+    PMMODEbits.WAITE = 1;   // 2 Tpb data hold
+    PMMODEbits.IRQM = 0b01; // Interrupt (and DMA event) at the end of every cycle
+    
+    PMCONbits.PTWREN = 1;   // PMWR drives WRX
+    PMCONbits.PTRDEN = 0;   // RDX is tied high
+    PMCONbits.WRSP = 0;     // Active-low write strobe
+    PMCONbits.ON = 1;
+    
+    // TFT D0-D7 = PMD0-PMD7 = RE0-RE7, the PMP owns them once on
+    ANSELECLR = 0x00FF;
+    
+    // TFT CS = Pin 29 = RB14
+    ANSELBbits.ANSB14 = 0;
+    TRISBbits.TRISB14 = 0;
+
+    // TFT DC = Pin 30 = RB15
+    ANSELBbits.ANSB15 = 0;
+    TRISBbits.TRISB15 = 0;
+}
+
+#endif
+
+/******************************************************
+ * TFT Bus Stream Width
+ * 
+ * Waits until the last word has left the bus before
+ * switching. On SPI2, restarting the module also empties
+ * the receive FIFO; on the PMP only the split of the
+ * words into cycles changes.
+ ******************************************************/
+void BSP_TFT_Set_Width(uint8_t bits)
+{
+#ifdef BSP_CONFIG_TFT_PMP
+    while (PMMODEbits.BUSY) ;
+
+    BSP_TFT_Stream_Width = bits;
+#else
+    while (!SPI2STATbits.SPITBE || !SPI2STATbits.SRMT) ;
+
+    SPI2CONbits.ON = 0;
+    SPI2CONbits.MODE32 = (bits == 32);
+    SPI2CONbits.MODE16 = (bits == 16);
+    SPI2CONbits.ON = 1;
+#endif
+}
+
+/******************************************************
+ * SPI1 DMA Capture
+ ******************************************************/
+void BSP_Initialize_SPI1_DMA(BSP_DMA_Callback on_complete)
+{
+    spi1_dma_on_complete = on_complete;
+    
+    DMACONbits.ON = 1;                          // Enable the DMA controller
+    
+    // Channel 0: SPI1BUF => RAM, one byte per SPI1 RX event
+    DCH0CON = 0;
+    DCH0CONbits.CHPRI = 3;                      // Highest priority, RX must never overrun
+    DCH0ECON = 0;
+    DCH0ECONbits.CHSIRQ = _SPI1_RX_VECTOR;
+    DCH0ECONbits.SIRQEN = 1;
+    DCH0SSA = KVA_TO_PA((void *)&SPI1BUF);
+    DCH0SSIZ = 1;
+    DCH0CSIZ = 1;
+    DCH0INTCLR = 0x00FF00FF;                    // Clear all flags and enables
+    DCH0INTbits.CHBCIE = 1;                     // Interrupt on block transfer complete
+    
+    // Channel 1: dummy bytes => SPI1BUF, one byte per SPI1 TX event
+    DCH1CON = 0;
+    DCH1CONbits.CHPRI = 2;
+    DCH1ECON = 0;
+    DCH1ECONbits.CHSIRQ = _SPI1_TX_VECTOR;
+    DCH1ECONbits.SIRQEN = 1;
+    DCH1SSA = KVA_TO_PA((void *)spi1_dma_dummy);
+    DCH1DSA = KVA_TO_PA((void *)&SPI1BUF);
+    DCH1DSIZ = 1;
+    DCH1CSIZ = 1;
+    DCH1INTCLR = 0x00FF00FF;
+    
+    // SPI1 RX event when the buffer is not empty, TX event once the byte is shifted out
+    SPI1CONbits.SRXISEL = 0b01;
+    SPI1CONbits.STXISEL = 0b00;
+    
+    IPC33bits.DMA0IP = 5;
+    IPC33bits.DMA0IS = 0;
+    IFS4bits.DMA0IF = 0;
+    IEC4bits.DMA0IE = 1;
+}
+
+void BSP_SPI1_DMA_Start(uint8_t *dst, uint16_t len)
+{
+    // Drain a stale byte so that the first RX event belongs to this transfer
+    while (SPI1STATbits.SPIRBF) {
+        (void)SPI1BUF;
+    }
+    
+    DCH0DSA = KVA_TO_PA(dst);
+    DCH0DSIZ = len;
+    DCH1SSIZ = len;
+    
+    IFS3CLR = _IFS3_SPI1RXIF_MASK;
+    IFS3CLR = _IFS3_SPI1TXIF_MASK;
+    DCH0INTCLR = 0x000000FF;
+    DCH1INTCLR = 0x000000FF;
+    
+    DCH0CONbits.CHEN = 1;
+    DCH1CONbits.CHEN = 1;
+    DCH1ECONbits.CFORCE = 1;                    // Clock out the first byte, the rest is event driven
+}
+
+void __ISR(_DMA0_VECTOR, IPL5SOFT) BSP_DMA0_Handler(void)
+{
+    DCH0INTCLR = 0x000000FF;
+    IFS4bits.DMA0IF = 0;
+    
+    if (spi1_dma_on_complete) {
+        spi1_dma_on_complete();
+    }
+}
+
+/******************************************************
+ * TFT Bus DMA Transmit
+ ******************************************************/
+void BSP_Initialize_TFT_DMA(BSP_DMA_Callback on_complete)
+{
+    tft_dma_on_complete = on_complete;
+    
+    DMACONbits.ON = 1;                          // Enable the DMA controller
+    
+    DCH2CON = 0;
+    DCH2CONbits.CHPRI = 1;                      // Below the Lepton capture channels
+    DCH2ECON = 0;
+#ifdef BSP_CONFIG_TFT_PMP
+    // Channel 2: RAM => PMDIN, one bus cycle per PMP event
+    DCH2ECONbits.CHSIRQ = _PMP_VECTOR;
+    DCH2ECONbits.SIRQEN = 1;
+    DCH2DSA = KVA_TO_PA((void *)&PMDIN);
+    DCH2DSIZ = BSP_TFT_BUS_WIDTH / 8;
+    DCH2CSIZ = BSP_TFT_BUS_WIDTH / 8;
+#else
+    // Channel 2: RAM => SPI2BUF, one byte per SPI2 TX event
+    DCH2ECONbits.CHSIRQ = _SPI2_TX_VECTOR;
+    DCH2ECONbits.SIRQEN = 1;
+    DCH2DSA = KVA_TO_PA((void *)&SPI2BUF);
+    DCH2DSIZ = 1;
+    DCH2CSIZ = 1;
+#endif
+    DCH2INTCLR = 0x00FF00FF;                    // Clear all flags and enables
+    DCH2INTbits.CHBCIE = 1;                     // Interrupt on block transfer complete
+    
+#ifndef BSP_CONFIG_TFT_PMP
+    // SPI2 TX event while the enhanced buffer has room
+    SPI2CONbits.ON = 0;
+    SPI2CONbits.STXISEL = 0b11;
+    SPI2CONbits.ON = 1;
+#endif
+    
+    IPC34bits.DMA2IP = 4;                       // Below the capture DMA, which must never wait
+    IPC34bits.DMA2IS = 0;
+    IFS4bits.DMA2IF = 0;
+    IEC4bits.DMA2IE = 1;
+}
+
+void BSP_TFT_DMA_Start(const uint8_t *src, uint16_t len)
+{
+    DCH2SSA = KVA_TO_PA((void *)src);
+    DCH2SSIZ = len;
+    
+#ifdef BSP_CONFIG_TFT_PMP
+    IFS4CLR = _IFS4_PMPIF_MASK;
+#else
+    IFS4CLR = _IFS4_SPI2TXIF_MASK;
+#endif
+    DCH2INTCLR = 0x000000FF;
+    
+    DCH2CONbits.CHEN = 1;
+    DCH2ECONbits.CFORCE = 1;                    // Send the first cycle, the rest is event driven
+}
+
+void __ISR(_DMA2_VECTOR, IPL4SOFT) BSP_DMA2_Handler(void)
+{
+    DCH2INTCLR = 0x000000FF;
+    IFS4bits.DMA2IF = 0;
+    
+#ifdef BSP_CONFIG_TFT_PMP
+    // The last cycle may still be on the bus
+    while (PMMODEbits.BUSY) ;
+#else
+    // The block is in the FIFO, at most 16 bytes are still to be shifted out
+    while (!SPI2STATbits.SPITBE || !SPI2STATbits.SRMT) ;
+    
+    // Nobody read back during the block: BSP_TFT_Write() waits for its own byte to come in
+    while (!SPI2STATbits.SPIRBE) {
+        (void)SPI2BUF;
+    }
+#endif
+    
+    if (tft_dma_on_complete) {
+        tft_dma_on_complete();
+    }
+}
+
+/******************************************************
+ * I2C1 Master Transfer
+ * 
+ * Each state names the bus event the interrupt that
+ * follows stands for: the start, an address or data byte
+ * sent, a byte received, its acknowledge sent, the stop.
+ * A bus collision raises the bus interrupt instead and
+ * ends the transaction where it is.
+ ******************************************************/
+#define BSP_I2C1_KHZ                    400
+#define BSP_I2C1_BRG                    (SYSCLK / 2 / (2000 * BSP_I2C1_KHZ) - 2)    // PBCLK2 = SYSCLK / 2
+
+#define BSP_I2C1_IDLE                   0
+#define BSP_I2C1_START                  1
+#define BSP_I2C1_SENT                   2
+#define BSP_I2C1_RESTART                3
+#define BSP_I2C1_READ_ADDRESS           4
+#define BSP_I2C1_RECEIVED               5
+#define BSP_I2C1_ACKNOWLEDGED           6
+#define BSP_I2C1_STOP                   7
+
+static volatile uint8_t i2c1_state = BSP_I2C1_IDLE;
+static uint8_t i2c1_address;
+static const uint8_t *i2c1_tx;
+static uint8_t i2c1_tx_len;
+static uint8_t *i2c1_rx;
+static uint8_t i2c1_rx_len;
+static uint8_t i2c1_count;
+static uint8_t i2c1_ok;
+
+void BSP_Initialize_I2C1(BSP_I2C_Callback on_complete)
+{
+    // FLIR SCL = SCL1 = RD10, FLIR SDA = SDA1 = RD9, taken over by the module
+    i2c1_on_complete = on_complete;
+    i2c1_state = BSP_I2C1_IDLE;
+    
+    I2C1CON = 0;
+    I2C1BRG = BSP_I2C1_BRG;
+    I2C1CONbits.DISSLW = 0;                     // Slew rate control, for 400 kHz
+    I2C1CONbits.ON = 1;
+    
+    IPC29bits.I2C1MIP = 3;                      // Below both DMA interrupts
+    IPC29bits.I2C1MIS = 0;
+    IPC28bits.I2C1BIP = 3;
+    IPC28bits.I2C1BIS = 0;
+    IFS3CLR = _IFS3_I2C1MIF_MASK | _IFS3_I2C1BIF_MASK;
+    IEC3SET = _IEC3_I2C1MIE_MASK | _IEC3_I2C1BIE_MASK;
+}
+
+// Abandons the transaction in progress, without a callback
+void BSP_I2C1_Reset(void)
+{
+    IEC3CLR = _IEC3_I2C1MIE_MASK | _IEC3_I2C1BIE_MASK;
+    
+    I2C1CONbits.ON = 0;
+    I2C1STATbits.BCL = 0;
+    i2c1_state = BSP_I2C1_IDLE;
+    I2C1CONbits.ON = 1;
+    
+    IFS3CLR = _IFS3_I2C1MIF_MASK | _IFS3_I2C1BIF_MASK;
+    IEC3SET = _IEC3_I2C1MIE_MASK | _IEC3_I2C1BIE_MASK;
+}
+
+void BSP_I2C1_Start(uint8_t address, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint8_t rx_len)
+{
+    i2c1_address = address;
+    i2c1_tx = tx;
+    i2c1_tx_len = tx_len;
+    i2c1_rx = rx;
+    i2c1_rx_len = rx_len;
+    i2c1_count = 0;
+    i2c1_ok = 1;
+    
+    i2c1_state = BSP_I2C1_START;
+    I2C1CONbits.SEN = 1;
+}
+
+static void BSP_I2C1_Stop(uint8_t ok)
+{
+    i2c1_ok = i2c1_ok && ok;
+    i2c1_state = BSP_I2C1_STOP;
+    I2C1CONbits.PEN = 1;
+}
+
+void __ISR(_I2C1_MASTER_VECTOR, IPL3SOFT) BSP_I2C1_Handler(void)
+{
+    IFS3CLR = _IFS3_I2C1MIF_MASK;
+    
+    switch (i2c1_state) {
+        case BSP_I2C1_START:
+            if (i2c1_tx_len) {
+                i2c1_state = BSP_I2C1_SENT;
+                I2C1TRN = i2c1_address << 1;
+            } else {
+                i2c1_state = BSP_I2C1_READ_ADDRESS;
+                I2C1TRN = (i2c1_address << 1) | 1;
+            }
+            break;
+            
+        case BSP_I2C1_SENT:
+            if (I2C1STATbits.ACKSTAT) {
+                BSP_I2C1_Stop(0);
+            } else if (i2c1_count < i2c1_tx_len) {
+                I2C1TRN = i2c1_tx[i2c1_count++];
+            } else if (i2c1_rx_len) {
+                i2c1_state = BSP_I2C1_RESTART;
+                I2C1CONbits.RSEN = 1;
+            } else {
+                BSP_I2C1_Stop(1);
+            }
+            break;
+            
+        case BSP_I2C1_RESTART:
+            i2c1_state = BSP_I2C1_READ_ADDRESS;
+            I2C1TRN = (i2c1_address << 1) | 1;
+            break;
+            
+        case BSP_I2C1_READ_ADDRESS:
+            if (I2C1STATbits.ACKSTAT) {
+                BSP_I2C1_Stop(0);
+            } else {
+                i2c1_count = 0;
+                i2c1_state = BSP_I2C1_RECEIVED;
+                I2C1CONbits.RCEN = 1;
+            }
+            break;
+            
+        case BSP_I2C1_RECEIVED:
+            i2c1_rx[i2c1_count++] = I2C1RCV;
+            
+            // The last byte is not acknowledged
+            I2C1CONbits.ACKDT = (i2c1_count == i2c1_rx_len);
+            i2c1_state = BSP_I2C1_ACKNOWLEDGED;
+            I2C1CONbits.ACKEN = 1;
+            break;
+            
+        case BSP_I2C1_ACKNOWLEDGED:
+            if (i2c1_count < i2c1_rx_len) {
+                i2c1_state = BSP_I2C1_RECEIVED;
+                I2C1CONbits.RCEN = 1;
+            } else {
+                BSP_I2C1_Stop(1);
+            }
+            break;
+            
+        case BSP_I2C1_STOP:
+            i2c1_state = BSP_I2C1_IDLE;
+            if (i2c1_on_complete) {
+                i2c1_on_complete(i2c1_ok);
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+void __ISR(_I2C1_BUS_VECTOR, IPL3SOFT) BSP_I2C1_Bus_Handler(void)
+{
+    IFS3CLR = _IFS3_I2C1BIF_MASK;
+    
+    // Lost the bus, there is nothing to stop
+    I2C1STATbits.BCL = 0;
+    if (i2c1_state == BSP_I2C1_IDLE) {
+        return;
+    }
+    
+    i2c1_state = BSP_I2C1_IDLE;
+    if (i2c1_on_complete) {
+        i2c1_on_complete(0);
+    }
+}
+
 /******************************************************
  * BSP Initialization
  ******************************************************/
 void BSP_Initialize()
 {
+    INTCONbits.MVEC = 1;    // Multi-vector interrupts, needed by the DMA handlers
+    
     BSP_Initialize_SPI1();
+#ifdef BSP_CONFIG_TFT_PMP
+    BSP_Initialize_PMP();
+#else
     BSP_Initialize_SPI2();
+#endif
     BSP_Initialize_LEDs();
     
     tft_init(240, 240/*320*/);
@@ -125,12 +537,43 @@ void BSP_Delay_us(unsigned int us)
     // Convert microseconds us into how many clock ticks it will take
 	us *= SYSCLK / 1000000 / 2; // Core Timer updates every 2 ticks
        
-    _CP0_SET_COUNT(0); // Set Core Timer count to 0
+    uint32_t start = _CP0_GET_COUNT(); // Leave the Core Timer running, BSP_Cycle_Count() relies on it
     
-    while (us > _CP0_GET_COUNT()); // Wait until Core Timer count reaches the number we calculated earlier
+    while (us > _CP0_GET_COUNT() - start); // Wait until Core Timer count reaches the number we calculated earlier
 }
 
 void BSP_Delay_ms(int ms)
 {
     BSP_Delay_us(ms * 1000);
+}
+
+// Free-running SYSCLK cycle count, for benchmarks (wraps after ~21 s)
+uint32_t BSP_Cycle_Count(void)
+{
+    return _CP0_GET_COUNT() * 2; // Core Timer updates every 2 ticks
+}
+
+// Microseconds since the first call, for timeouts (wraps after ~71 min)
+// Not from interrupts, and at least every 42 s so no Core Timer wrap goes unseen
+uint32_t BSP_Time_us(void)
+{
+    static uint8_t started = 0;
+    static uint32_t last_count;
+    static uint32_t ticks = 0;          // Core Timer ticks not counted as a whole microsecond yet
+    static uint32_t time_us = 0;
+    uint32_t count = _CP0_GET_COUNT();
+
+    if (!started) {
+        // The Core Timer has run since reset, possibly through a wrap
+        last_count = count;
+        started = 1;
+    }
+
+    ticks += count - last_count;
+    last_count = count;
+
+    time_us += ticks / (SYSCLK / 2000000);
+    ticks %= (SYSCLK / 2000000);
+
+    return time_us;
 }
\ No newline at end of file
@@ -9,7 +9,20 @@
 #ifndef BSP_PIN_H_
 #define BSP_PIN_H_
 
+/*******************************************************
+ * BSP configuration
+ *******************************************************/
+//#define BSP_CONFIG_HOST
+//#define BSP_CONFIG_TFT_PMP 8            // ST7789 on the Parallel Master Port (8080 bus, 8 or 16 data lines) instead of SPI2
+#define BSP_CONFIG_PIN_COUNT 64         // Of the PIC32MZ fitted, a PIC32MZ1024ECH064 on this module
+
+/* End BSP configuration */
+
+#ifdef BSP_CONFIG_HOST
+#include "BSP_host.h"
+#else
 #include <xc.h>
+#endif
 #include "tft_st7789.h"
 
 /******************************************************
@@ -24,12 +37,20 @@
  *	FLIR CS         = Pin 27    = RB12
  *	FLIR SDI1       = Pin 6     = RG8 => PPS: SDI1R = 0001
  *	FLIR MOSI       = Pin 23    = RB10
+ *	FLIR SCL        = SCL1 = RD10 = Pin 44
+ *	FLIR SDA        = SDA1 = RD9  = Pin 43
  * 	
  *	TFT SCLK        = Pin 4
  *	TFT CS          = Pin 29 = RB14
  *	TFT DC          = Pin 30 = RB15
  *	TFT MISO        = SDI2 = RG7 = Pin 5    => PPS: SDI2R = 0001
  *	TFT MOSI        = SDO2 = Pin 22 = RB9   => PPS: RPB9R = 0110
+ *
+ *	With BSP_CONFIG_TFT_PMP, CS and DC as above and
+ *	TFT D0-D7       = PMD0-PMD7 = RE0-RE7
+ *	TFT D8-D15      = PMD8-PMD15, 16-bit bus only (100-pin parts and up)
+ *	TFT WRX         = PMWR = RD4
+ *	TFT RDX         = tied high, the panel is never read
  ******************************************************/
 
 // LED Pins
@@ -68,6 +89,133 @@ void BSP_Initialize_LEDs();
 #define BSP_SPI2_On()       BSP_Register_TFT_SPICON.ON = 1;
 #define BSP_SPI2_Off()      BSP_Register_TFT_SPICON.ON = 0;
 
+/******************************************************
+ * SPI1 DMA Capture
+ * 
+ * DMA channel 0 moves received bytes from SPI1BUF to
+ * RAM, channel 1 clocks out the dummy bytes. The
+ * completion callback runs in interrupt context when
+ * the whole block has been received.
+ ******************************************************/
+#define BSP_SPI1_DMA_MAX_LEN            256
+
+// DMA targets live in KSEG1 so the cache never hides received data
+#ifndef BSP_DMA_BUFFER
+#define BSP_DMA_BUFFER                  __attribute__((coherent, aligned(16)))
+#endif
+
+typedef void (*BSP_DMA_Callback)(void);
+
+void BSP_Initialize_SPI1_DMA(BSP_DMA_Callback on_complete);
+void BSP_SPI1_DMA_Start(uint8_t *dst, uint16_t len);
+
+/******************************************************
+ * TFT Display Bus
+ * 
+ * The ST7789 driver reaches the panel only through
+ * these: SPI2, or with BSP_CONFIG_TFT_PMP the Parallel
+ * Master Port as an 8080 bus. A bus cycle carries one
+ * byte, on a 16-bit bus one pixel; command and parameter
+ * bytes take a cycle each on either width.
+ * BSP_TFT_Write() returns once its cycle is out, so DC
+ * may change right after. BSP_TFT_Stream() only waits
+ * for room, its word is as wide as set last and goes out
+ * MSB first; setting the width waits for the bus to
+ * drain.
+ ******************************************************/
+#if defined(BSP_CONFIG_TFT_PMP) && (BSP_CONFIG_TFT_PMP == 16) && (BSP_CONFIG_PIN_COUNT < 100)
+#error "A 16-bit PMP bus needs PMD8-PMD15, which parts under 100 pins do not have"
+#endif
+
+#ifdef BSP_CONFIG_TFT_PMP
+#define BSP_TFT_BUS_WIDTH               BSP_CONFIG_TFT_PMP
+#else
+#define BSP_TFT_BUS_WIDTH               8
+#endif
+
+void BSP_TFT_Set_Width(uint8_t bits);      // 8, 16 or 32-bit stream words
+
+#ifndef BSP_CONFIG_HOST
+#ifdef BSP_CONFIG_TFT_PMP
+
+extern uint8_t BSP_TFT_Stream_Width;
+
+static inline void BSP_TFT_Write(uint16_t cycle)
+{
+    while (PMMODEbits.BUSY) ;
+    PMDIN = cycle;
+    while (PMMODEbits.BUSY) ;
+}
+
+// Words wider than the bus take several cycles
+static inline void BSP_TFT_Stream(uint32_t word)
+{
+    int8_t shift = (BSP_TFT_Stream_Width > BSP_TFT_BUS_WIDTH) ? BSP_TFT_Stream_Width - BSP_TFT_BUS_WIDTH : 0;
+
+    for (; shift >= 0; shift -= BSP_TFT_BUS_WIDTH) {
+        while (PMMODEbits.BUSY) ;
+        PMDIN = (uint16_t)(word >> shift);
+    }
+}
+
+#else
+
+static inline void BSP_TFT_Write(uint16_t cycle)
+{
+    BSP_Register_TFT_SPIBUF = cycle;
+    while (BSP_Register_TFT_SPISTAT.SPIRBE) ;
+    (void)BSP_Register_TFT_SPIBUF;
+}
+
+static inline void BSP_TFT_Stream(uint32_t word)
+{
+    while (BSP_Register_TFT_SPISTAT.SPITBF) ;
+    BSP_Register_TFT_SPIBUF = word;
+}
+
+#endif
+#endif
+
+/******************************************************
+ * TFT Bus DMA Transmit
+ * 
+ * DMA channel 2 feeds SPI2BUF in 8-bit mode, keeping the
+ * enhanced buffer full, or PMDIN a cycle at a time; on a
+ * 16-bit bus each cycle is a native halfword. The
+ * completion callback runs in interrupt context once
+ * the last cycle is out. The DMA does not see the data
+ * cache, so sources must be BSP_DMA_BUFFER.
+ ******************************************************/
+#if BSP_TFT_BUS_WIDTH == 16
+#define BSP_TFT_DMA_MAX_LEN             65534   // Whole pixels
+#else
+#define BSP_TFT_DMA_MAX_LEN             65535
+#endif
+
+void BSP_Initialize_TFT_DMA(BSP_DMA_Callback on_complete);
+void BSP_TFT_DMA_Start(const uint8_t *src, uint16_t len);
+
+/******************************************************
+ * I2C1 Master Transfer
+ * 
+ * One transaction at 400 kHz: tx_len bytes written, then
+ * rx_len bytes read after a repeated start; either part
+ * may be empty. The I2C1 master interrupt steps through
+ * the bus events, below the DMA priorities, so the CPU
+ * spends a few microseconds per byte. The completion
+ * callback runs in interrupt context after the stop,
+ * with 0 when a byte was not acknowledged or the
+ * bus was lost. Buffers must stay put until then. A
+ * device holding SCL low keeps a transaction from ever
+ * completing: BSP_I2C1_Reset() abandons it, and no
+ * callback comes.
+ ******************************************************/
+typedef void (*BSP_I2C_Callback)(uint8_t ok);
+
+void BSP_Initialize_I2C1(BSP_I2C_Callback on_complete);
+void BSP_I2C1_Start(uint8_t address, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint8_t rx_len);
+void BSP_I2C1_Reset(void);
+
 /******************************************************
  * BSP Initialization
  ******************************************************/
@@ -78,5 +226,7 @@ void BSP_Initialize();
  ******************************************************/
 void BSP_Delay_us(unsigned int us);
 void BSP_Delay_ms(int ms);
+uint32_t BSP_Cycle_Count(void);
+uint32_t BSP_Time_us(void);
 
 #endif /* BSP_H_ */
\ No newline at end of file
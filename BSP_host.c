@@ -0,0 +1,488 @@
+/******************************************************
+ * NOCTIX-1 Module BSP - Host Stand-in
+ * ****************************************************
+ * File:    BSP_host.c
+ * Date:    16.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Build on the host with -DBSP_CONFIG_HOST in
+ *          place of BSP.c. Not part of the MPLAB project.
+ ******************************************************/
+
+#include "BSP.h"
+#include "flir_cci.h"
+#include <string.h>
+#include <time.h>
+
+/******************************************************
+ * Special Function Register Stand-ins
+ ******************************************************/
+BSP_Host_LATBbits LATBbits;
+BSP_Host_LATGbits LATGbits;
+volatile uint32_t SPI1BUF;
+BSP_Host_SPICONbits SPI1CONbits = { .ON = 1 };
+BSP_Host_SPISTATbits SPI1STATbits = { .SPIRBF = 1, .SPITBE = 1, .SRMT = 1 };
+
+/******************************************************
+ * Simulated SPI1 DMA
+ ******************************************************/
+uint32_t BSP_Host_SPI1_Transfers = 0;
+uint32_t BSP_Host_SPI1_Bytes = 0;
+uint32_t BSP_Host_Time_us = 0;
+
+#define BSP_HOST_SPI1_MHZ               20      // Simulated SCLK, sets the time a transfer takes
+
+static BSP_DMA_Callback spi1_dma_on_complete;
+static BSP_Host_SPI1_Source spi1_source;
+static uint8_t *spi1_dma_dst;
+static uint16_t spi1_dma_len;
+
+void BSP_Host_Set_SPI1_Source(BSP_Host_SPI1_Source source)
+{
+    spi1_source = source;
+}
+
+void BSP_Initialize_SPI1_DMA(BSP_DMA_Callback on_complete)
+{
+    spi1_dma_on_complete = on_complete;
+    spi1_dma_dst = 0;
+    spi1_dma_len = 0;
+}
+
+void BSP_SPI1_DMA_Start(uint8_t *dst, uint16_t len)
+{
+    spi1_dma_dst = dst;
+    spi1_dma_len = len;
+}
+
+int BSP_Host_Step(void)
+{
+    uint8_t *dst = spi1_dma_dst;
+    uint16_t len = spi1_dma_len;
+
+    if (dst == 0) {
+        return 0;
+    }
+
+    // The callback may start the next transfer
+    spi1_dma_dst = 0;
+    spi1_dma_len = 0;
+
+    if (spi1_source) {
+        spi1_source(dst, len);
+    } else {
+        memset(dst, 0xFF, len);
+    }
+
+    BSP_Host_SPI1_Transfers++;
+    BSP_Host_SPI1_Bytes += len;
+    BSP_Host_Time_us += (8 * len) / BSP_HOST_SPI1_MHZ;
+
+    if (spi1_dma_on_complete) {
+        spi1_dma_on_complete();
+    }
+
+    return 1;
+}
+
+/******************************************************
+ * Simulated TFT Display Bus
+ ******************************************************/
+uint8_t BSP_Host_TFT_Width = 8;
+uint32_t BSP_Host_TFT_Recorded = 0;
+uint32_t BSP_Host_TFT_Transfers = 0;
+uint32_t BSP_Host_TFT_Bytes = 0;
+uint32_t BSP_Host_TFT_Byte_ns = 0;
+
+static BSP_Host_TFT_Sink tft_sink;
+static BSP_Host_TFT_Cycle *tft_record;
+static uint32_t tft_record_size;
+static BSP_DMA_Callback tft_dma_on_complete;
+static const uint8_t *tft_dma_src;
+static uint32_t tft_dma_due;
+static uint16_t tft_dma_len;
+
+static void BSP_Host_TFT_Cycle_Out(uint16_t value)
+{
+    BSP_Host_TFT_Cycle cycle;
+
+    cycle.Value = (BSP_TFT_BUS_WIDTH == 16) ? value : (value & 0xFF);
+    cycle.DC = BSP_Pin_TFT_DC;
+    cycle.CS = BSP_Pin_TFT_CS;
+
+    if (BSP_Host_TFT_Recorded < tft_record_size) {
+        tft_record[BSP_Host_TFT_Recorded] = cycle;
+    }
+    BSP_Host_TFT_Recorded++;
+
+    if (tft_sink) {
+        tft_sink(&cycle);
+    }
+}
+
+void BSP_Host_Set_TFT_Sink(BSP_Host_TFT_Sink sink)
+{
+    tft_sink = sink;
+}
+
+// Starts a new record, size 0 stops recording
+void BSP_Host_TFT_Record(BSP_Host_TFT_Cycle *record, uint32_t size)
+{
+    tft_record = record;
+    tft_record_size = size;
+    BSP_Host_TFT_Recorded = 0;
+}
+
+void BSP_TFT_Write(uint16_t cycle)
+{
+    BSP_Host_TFT_Cycle_Out(cycle);
+}
+
+// Split into bus cycles MSB first, as SPI2 shifts a word out or the PMP is fed
+void BSP_TFT_Stream(uint32_t word)
+{
+    int shift = (BSP_Host_TFT_Width > BSP_TFT_BUS_WIDTH) ? BSP_Host_TFT_Width - BSP_TFT_BUS_WIDTH : 0;
+
+    for (; shift >= 0; shift -= BSP_TFT_BUS_WIDTH) {
+        BSP_Host_TFT_Cycle_Out((uint16_t)(word >> shift));
+    }
+}
+
+void BSP_TFT_Set_Width(uint8_t bits)
+{
+    BSP_Host_TFT_Width = bits;
+}
+
+void BSP_Initialize_TFT_DMA(BSP_DMA_Callback on_complete)
+{
+    tft_dma_on_complete = on_complete;
+    tft_dma_src = 0;
+    tft_dma_len = 0;
+}
+
+void BSP_TFT_DMA_Start(const uint8_t *src, uint16_t len)
+{
+    tft_dma_src = src;
+    tft_dma_len = len;
+    tft_dma_due = BSP_Host_Time_us + (len * BSP_Host_TFT_Byte_ns) / 1000;
+}
+
+int BSP_Host_Step_TFT(void)
+{
+    const uint8_t *src = tft_dma_src;
+    uint16_t len = tft_dma_len;
+
+    if (src == 0) {
+        return 0;
+    }
+
+    // A slow panel still shifting the transfer out
+    if ((int32_t)(BSP_Host_Time_us - tft_dma_due) < 0) {
+        return 0;
+    }
+
+    // The callback may start the next transfer
+    tft_dma_src = 0;
+    tft_dma_len = 0;
+
+    // A 16-bit bus takes each cell as a little-endian halfword
+    for (uint16_t i = 0; i < len; i += BSP_TFT_BUS_WIDTH / 8) {
+        BSP_Host_TFT_Cycle_Out((BSP_TFT_BUS_WIDTH == 16) ? (uint16_t)(src[i] | (src[i + 1] << 8)) : src[i]);
+    }
+
+    BSP_Host_TFT_Transfers++;
+    BSP_Host_TFT_Bytes += len;
+
+    if (tft_dma_on_complete) {
+        tft_dma_on_complete();
+    }
+
+    return 1;
+}
+
+/******************************************************
+ * Simulated I2C1
+ ******************************************************/
+uint32_t BSP_Host_I2C_Transfers = 0;
+uint32_t BSP_Host_I2C_Resets = 0;
+
+#define BSP_HOST_I2C1_KHZ               400
+
+static BSP_Host_I2C_Device i2c1_device = BSP_Host_Lepton_CCI;
+static BSP_I2C_Callback i2c1_on_complete;
+static uint8_t i2c1_pending;
+static uint8_t i2c1_held;
+static uint8_t i2c1_address;
+static const uint8_t *i2c1_tx;
+static uint8_t i2c1_tx_len;
+static uint8_t *i2c1_rx;
+static uint8_t i2c1_rx_len;
+
+void BSP_Host_Set_I2C_Device(BSP_Host_I2C_Device device)
+{
+    i2c1_device = device;
+}
+
+void BSP_Initialize_I2C1(BSP_I2C_Callback on_complete)
+{
+    i2c1_on_complete = on_complete;
+    i2c1_pending = 0;
+    i2c1_held = 0;
+}
+
+void BSP_I2C1_Reset(void)
+{
+    i2c1_pending = 0;
+    i2c1_held = 0;
+    BSP_Host_I2C_Resets++;
+}
+
+void BSP_I2C1_Start(uint8_t address, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint8_t rx_len)
+{
+    i2c1_address = address;
+    i2c1_tx = tx;
+    i2c1_tx_len = tx_len;
+    i2c1_rx = rx;
+    i2c1_rx_len = rx_len;
+    i2c1_pending = 1;
+}
+
+int BSP_Host_Step_I2C(void)
+{
+    uint8_t ok;
+    uint16_t bytes;
+
+    if (!i2c1_pending || i2c1_held) {
+        return 0;
+    }
+
+    ok = i2c1_device ? i2c1_device(i2c1_address, i2c1_tx, i2c1_tx_len, i2c1_rx, i2c1_rx_len) : 0;
+
+    if (ok == BSP_HOST_I2C_HELD) {
+        i2c1_held = 1;
+        return 0;
+    }
+
+    // The callback may start the next transfer
+    i2c1_pending = 0;
+
+    // Address bytes included, one for each part
+    bytes = (i2c1_tx_len ? 1 + i2c1_tx_len : 0) + (i2c1_rx_len ? 1 + i2c1_rx_len : 0);
+
+    BSP_Host_I2C_Transfers++;
+    BSP_Host_Time_us += (9 * bytes * 1000) / BSP_HOST_I2C1_KHZ;
+
+    if (i2c1_on_complete) {
+        i2c1_on_complete(ok);
+    }
+
+    return 1;
+}
+
+/******************************************************
+ * Simulated Lepton CCI
+ ******************************************************/
+uint32_t BSP_Host_Lepton_Commands = 0;
+uint32_t BSP_Host_Lepton_FFCs = 0;
+
+#define BSP_HOST_LEPTON_COMMAND_US      2000
+#define BSP_HOST_LEPTON_FFC_US          150000
+#define BSP_HOST_LEPTON_BOOT_US         1000000
+
+typedef struct
+{
+    uint16_t Command;                   // Without the type
+    uint8_t Words;
+    uint16_t Data[FLIR_CCI_MAX_WORDS];
+} BSP_Host_Lepton_Attribute;
+
+static BSP_Host_Lepton_Attribute lepton_attributes[] =
+{
+    { FLIR_CCI_AGC_ENABLE, 2, { 0 } },
+    { FLIR_CCI_AGC_POLICY, 2, { 1 } },
+    { FLIR_CCI_SYS_STATUS, 4, { 0 } },
+    { FLIR_CCI_SYS_UPTIME, 2, { 0 } },
+    { FLIR_CCI_SYS_FPA_TEMPERATURE, 1, { 30000 } },
+    { FLIR_CCI_SYS_TELEMETRY_ENABLE, 2, { 0 } },
+    { FLIR_CCI_SYS_TELEMETRY_LOCATION, 2, { 0 } },
+    { FLIR_CCI_SYS_FFC_SHUTTER_MODE, 16, { 1 } },
+    { FLIR_CCI_SYS_FFC_STATUS, 2, { 0 } },
+    { FLIR_CCI_VID_POLARITY, 2, { 0 } },
+    { FLIR_CCI_VID_LUT_SELECT, 2, { 0 } },
+    { FLIR_CCI_VID_OUTPUT_FORMAT, 2, { 3 } },
+    { FLIR_CCI_RAD_ENABLE, 2, { 1 } },
+    { FLIR_CCI_RAD_TLINEAR_ENABLE, 2, { 1 } },
+    { FLIR_CCI_RAD_TLINEAR_RESOLUTION, 2, { 1 } },
+    { FLIR_CCI_OEM_VIDEO_OUTPUT_FORMAT, 2, { 7 } },
+    { FLIR_CCI_OEM_GPIO_MODE, 2, { 0 } },
+};
+
+static uint16_t lepton_registers[3 + FLIR_CCI_MAX_WORDS];     // Status, command, length, data
+static uint32_t lepton_busy_until = 0;
+static uint32_t lepton_boot_at = 0;                             // BSP_Host_Time_us when booted
+static int8_t lepton_error = 0;
+
+#define LEPTON_REGISTER(address)        lepton_registers[((address) - FLIR_CCI_REG_STATUS) / 2]
+
+static uint16_t BSP_Host_Lepton_Status(void)
+{
+    uint16_t status = (uint8_t)lepton_error << 8;
+
+    if ((int32_t)(BSP_Host_Time_us - lepton_boot_at) < 0) {
+        return status | FLIR_CCI_STATUS_BUSY;
+    }
+    status |= FLIR_CCI_STATUS_BOOT_MODE | FLIR_CCI_STATUS_BOOT_DONE;
+    if ((int32_t)(BSP_Host_Time_us - lepton_busy_until) < 0) {
+        status |= FLIR_CCI_STATUS_BUSY;
+    }
+
+    return status;
+}
+
+static BSP_Host_Lepton_Attribute *BSP_Host_Lepton_Find(uint16_t command)
+{
+    for (unsigned i = 0; i < sizeof(lepton_attributes) / sizeof(lepton_attributes[0]); i++) {
+        if (lepton_attributes[i].Command == command) {
+            return &lepton_attributes[i];
+        }
+    }
+
+    return 0;
+}
+
+static void BSP_Host_Lepton_Execute(uint16_t id)
+{
+    uint16_t command = id & ~0x0003;
+    uint8_t type = id & 0x0003;
+    uint16_t words = LEPTON_REGISTER(FLIR_CCI_REG_LENGTH);
+    uint16_t *data = &LEPTON_REGISTER(FLIR_CCI_REG_DATA);
+    BSP_Host_Lepton_Attribute *attribute = BSP_Host_Lepton_Find(command);
+    uint32_t busy_us = BSP_HOST_LEPTON_COMMAND_US;
+
+    BSP_Host_Lepton_Commands++;
+    lepton_error = FLIR_CCI_OK;
+
+    if (type == FLIR_CCI_RUN) {
+        if (command == FLIR_CCI_SYS_RUN_FFC) {
+            BSP_Host_Lepton_FFCs++;
+            busy_us = BSP_HOST_LEPTON_FFC_US;
+        } else if (command == FLIR_CCI_OEM_REBOOT) {
+            lepton_boot_at = BSP_Host_Time_us + BSP_HOST_LEPTON_BOOT_US;
+        } else if (command != FLIR_CCI_SYS_PING) {
+            lepton_error = FLIR_CCI_UNDEFINED_FUNCTION;
+        }
+    } else if (attribute == 0 || type > FLIR_CCI_SET) {
+        lepton_error = FLIR_CCI_UNDEFINED_FUNCTION;
+    } else if (words != attribute->Words) {
+        lepton_error = FLIR_CCI_DATA_SIZE;
+    } else if (type == FLIR_CCI_GET) {
+        if (command == FLIR_CCI_SYS_UPTIME) {
+            uint32_t uptime_ms = BSP_Host_Time_us / 1000;
+
+            attribute->Data[0] = (uint16_t)uptime_ms;
+            attribute->Data[1] = (uint16_t)(uptime_ms >> 16);
+        }
+        memcpy(data, attribute->Data, 2 * words);
+    } else {
+        memcpy(attribute->Data, data, 2 * words);
+    }
+
+    lepton_busy_until = BSP_Host_Time_us + busy_us;
+}
+
+uint8_t BSP_Host_Lepton_CCI(uint8_t address, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint8_t rx_len)
+{
+    uint16_t reg;
+    uint8_t busy;
+
+    if (address != FLIR_CCI_ADDRESS || tx_len < 2 || (tx_len & 1)) {
+        return 0;
+    }
+
+    reg = (tx[0] << 8) | tx[1];
+    busy = (BSP_Host_Lepton_Status() & FLIR_CCI_STATUS_BUSY) != 0;
+
+    // Writes while busy are lost, as on the camera
+    for (uint8_t i = 2; i < tx_len; i += 2, reg += 2) {
+        if (busy || reg < FLIR_CCI_REG_COMMAND || reg >= FLIR_CCI_REG_DATA + 2 * FLIR_CCI_MAX_WORDS) {
+            continue;
+        }
+        LEPTON_REGISTER(reg) = (tx[i] << 8) | tx[i + 1];
+        if (reg == FLIR_CCI_REG_COMMAND) {
+            BSP_Host_Lepton_Execute(LEPTON_REGISTER(reg));
+        }
+    }
+
+    reg = (tx[0] << 8) | tx[1];
+    for (uint8_t i = 0; i + 1 < rx_len; i += 2, reg += 2) {
+        uint16_t value = 0;
+
+        if (reg == FLIR_CCI_REG_STATUS) {
+            value = BSP_Host_Lepton_Status();
+        } else if (reg >= FLIR_CCI_REG_COMMAND && reg < FLIR_CCI_REG_DATA + 2 * FLIR_CCI_MAX_WORDS) {
+            value = LEPTON_REGISTER(reg);
+        }
+        rx[i] = value >> 8;
+        rx[i + 1] = value;
+    }
+
+    return 1;
+}
+
+/******************************************************
+ * Simulated Concurrency
+ ******************************************************/
+void BSP_Host_Poll(void)
+{
+    int busy = BSP_Host_Step();
+
+    busy |= BSP_Host_Step_TFT();
+    busy |= BSP_Host_Step_I2C();
+
+    if (!busy) {
+        // Nothing in flight, the CPU only spins: time passes all the same
+        BSP_Host_Time_us += BSP_HOST_POLL_US;
+    }
+}
+
+/******************************************************
+ * BSP Initialization
+ ******************************************************/
+void BSP_Initialize_LEDs()
+{
+}
+
+void BSP_Initialize()
+{
+    BSP_Initialize_LEDs();
+
+    tft_init(240, 240);
+}
+
+/******************************************************
+ * BSP Timing Functions
+ ******************************************************/
+void BSP_Delay_us(unsigned int us)
+{
+    BSP_Host_Time_us += us;
+}
+
+void BSP_Delay_ms(int ms)
+{
+    BSP_Delay_us(ms * 1000);
+}
+
+// Host time expressed in SYSCLK cycles, so benchmarks read alike on both sides
+uint32_t BSP_Cycle_Count(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec) / (1000000000ull / SYSCLK));
+}
+
+// Simulated time, unlike the cycle count
+uint32_t BSP_Time_us(void)
+{
+    return BSP_Host_Time_us;
+}
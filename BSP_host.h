@@ -0,0 +1,164 @@
+/******************************************************
+ * NOCTIX-1 Module BSP - Host Stand-in
+ * ****************************************************
+ * File:    BSP_host.h
+ * Date:    16.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Replaces <xc.h> when BSP_CONFIG_HOST is
+ *          defined, so the drivers build on a Linux
+ *          host against simulated peripherals.
+ ******************************************************/
+
+#ifndef BSP_HOST_H_
+#define BSP_HOST_H_
+
+#include <stdint.h>
+
+/******************************************************
+ * Special Function Register Stand-ins
+ ******************************************************/
+typedef struct
+{
+    unsigned LATB12 : 1;
+    unsigned LATB14 : 1;
+    unsigned LATB15 : 1;
+} BSP_Host_LATBbits;
+
+typedef struct
+{
+    unsigned LATG7 : 1;
+} BSP_Host_LATGbits;
+
+typedef struct
+{
+    unsigned ON : 1;
+    unsigned MODE16 : 1;
+    unsigned MODE32 : 1;
+    unsigned ENHBUF : 1;
+} BSP_Host_SPICONbits;
+
+typedef struct
+{
+    unsigned SPIRBF : 1;
+    unsigned SPIRBE : 1;
+    unsigned SPITBF : 1;
+    unsigned SPITBE : 1;
+    unsigned SRMT : 1;
+} BSP_Host_SPISTATbits;
+
+extern BSP_Host_LATBbits LATBbits;
+extern BSP_Host_LATGbits LATGbits;
+extern volatile uint32_t SPI1BUF;
+extern BSP_Host_SPICONbits SPI1CONbits;
+extern BSP_Host_SPISTATbits SPI1STATbits;
+
+#define BSP_DMA_BUFFER                  __attribute__((aligned(16)))
+
+/******************************************************
+ * Simulated SPI1 DMA
+ *
+ * A started transfer stays pending until BSP_Host_Step()
+ * fills it from the source and runs the completion
+ * callback, standing in for the DMA0 interrupt. Each
+ * transfer advances BSP_Host_Time_us by the time it
+ * takes on the bus; BSP_Time_us() reads that clock, so
+ * a replay sees the same timing on every run.
+ ******************************************************/
+#define BSP_HOST_POLL_US                10      // A poll with nothing to complete
+
+typedef void (*BSP_Host_SPI1_Source)(uint8_t *dst, uint16_t len);
+
+void BSP_Host_Set_SPI1_Source(BSP_Host_SPI1_Source source);
+int BSP_Host_Step(void);
+
+extern uint32_t BSP_Host_SPI1_Transfers;
+extern uint32_t BSP_Host_SPI1_Bytes;
+extern uint32_t BSP_Host_Time_us;
+
+/******************************************************
+ * Simulated TFT Display Bus
+ *
+ * Records what the panel would see: every bus cycle,
+ * written or sent by DMA, with the levels of DC and CS.
+ * Cycles go to the sink as they happen and into the
+ * record while it has room, BSP_Host_TFT_Recorded
+ * counts them all. A started DMA transfer stays pending
+ * until BSP_Host_Step_TFT() sends it and runs the
+ * completion callback, as for SPI1. It takes no time
+ * unless BSP_Host_TFT_Byte_ns is set, then it completes
+ * that many ns per byte after the start.
+ ******************************************************/
+typedef struct
+{
+    uint16_t Value;         // A byte, or a pixel on a 16-bit bus
+    uint8_t DC;             // 0 for a command byte
+    uint8_t CS;
+} BSP_Host_TFT_Cycle;
+
+typedef void (*BSP_Host_TFT_Sink)(const BSP_Host_TFT_Cycle *cycle);
+
+void BSP_TFT_Write(uint16_t cycle);
+void BSP_TFT_Stream(uint32_t word);
+
+void BSP_Host_Set_TFT_Sink(BSP_Host_TFT_Sink sink);
+void BSP_Host_TFT_Record(BSP_Host_TFT_Cycle *record, uint32_t size);
+int BSP_Host_Step_TFT(void);
+
+extern uint8_t BSP_Host_TFT_Width;
+extern uint32_t BSP_Host_TFT_Recorded;
+extern uint32_t BSP_Host_TFT_Transfers;
+extern uint32_t BSP_Host_TFT_Bytes;
+extern uint32_t BSP_Host_TFT_Byte_ns;
+
+/******************************************************
+ * Simulated I2C1
+ *
+ * A started transaction stays pending until
+ * BSP_Host_Step_I2C() hands it to the device and runs
+ * the completion callback with what the device returned,
+ * 0 for a byte not acknowledged. A device returning
+ * BSP_HOST_I2C_HELD holds SCL low: the transaction never
+ * completes until BSP_I2C1_Reset(). The time on the bus,
+ * nine clocks a byte, goes on BSP_Host_Time_us. The
+ * default device is the simulated Lepton below.
+ ******************************************************/
+#define BSP_HOST_I2C_HELD               2
+
+typedef uint8_t (*BSP_Host_I2C_Device)(uint8_t address, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint8_t rx_len);
+
+void BSP_Host_Set_I2C_Device(BSP_Host_I2C_Device device);
+int BSP_Host_Step_I2C(void);
+
+extern uint32_t BSP_Host_I2C_Transfers;
+extern uint32_t BSP_Host_I2C_Resets;
+
+/******************************************************
+ * Simulated Lepton CCI
+ *
+ * The register side of the camera at address 0x2A: the
+ * status, command, length and 16 data registers, with
+ * the busy time of each command taken from the simulated
+ * clock. Gets and sets go to a table of the attributes
+ * flir_cci.h names, anything else fails with an undefined
+ * function error and a wrong length with a data size
+ * error. Reboots take the camera through its boot time.
+ ******************************************************/
+uint8_t BSP_Host_Lepton_CCI(uint8_t address, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint8_t rx_len);
+
+extern uint32_t BSP_Host_Lepton_Commands;
+extern uint32_t BSP_Host_Lepton_FFCs;
+
+/******************************************************
+ * Simulated Concurrency
+ *
+ * There are no interrupts on the host. The drivers call
+ * BSP_Host_Poll() where they wait on a transfer, and it
+ * completes what is pending on each bus, SPI1, the
+ * display and I2C1, as the DMA and the I2C interrupt
+ * would have done in the meantime. With nothing pending
+ * it moves the clock on a little instead, so that waits
+ * on BSP_Time_us() alone come to an end.
+ ******************************************************/
+void BSP_Host_Poll(void);
+
+#endif /* BSP_HOST_H_ */
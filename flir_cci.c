@@ -0,0 +1,286 @@
+/******************************************************
+ * FLIR Lepton 3.5 Command and Control Interface
+ * ****************************************************
+ * File:    flir_cci.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ ******************************************************/
+
+#include "flir_cci.h"
+#include "BSP.h"
+
+/******************************************************
+ * Request State
+ *
+ * Each state names the transfer in flight, or the one
+ * to repeat once the status is read again:
+ *   READY   status, until the camera is booted and idle
+ *   DATA    data registers, for a set
+ *   LENGTH  data length in words
+ *   COMMAND command, which the camera starts on
+ *   DONE    status, until the command is through
+ *   RESULT  data registers, for a get
+ ******************************************************/
+#define FLIR_CCI_IDLE                       0
+#define FLIR_CCI_READY                      1
+#define FLIR_CCI_DATA                       2
+#define FLIR_CCI_LENGTH                     3
+#define FLIR_CCI_COMMAND                    4
+#define FLIR_CCI_DONE                       5
+#define FLIR_CCI_RESULT                     6
+
+typedef struct
+{
+    uint16_t Command;                           // With the type
+    uint8_t Words;
+    uint16_t Data[FLIR_CCI_MAX_WORDS];
+    FLIR_CCI_Callback On_Done;
+} FLIR_CCI_Request;
+
+static FLIR_CCI_Request cci_queue[FLIR_CCI_QUEUE];
+static uint8_t cci_head = 0;
+static uint8_t cci_count = 0;
+
+static uint8_t cci_state = FLIR_CCI_IDLE;
+static uint8_t cci_in_flight = 0;
+static uint8_t cci_repoll = 0;                  // Status busy, read it again after FLIR_CCI_POLL_US
+static uint32_t cci_started_at;                 // BSP_Time_us() when the request was taken
+static uint32_t cci_polled_at;
+static volatile uint8_t cci_transfer_done;
+static volatile uint8_t cci_transfer_ok;
+
+static uint8_t cci_tx[2 + 2 * FLIR_CCI_MAX_WORDS];
+static uint8_t cci_rx[2 * FLIR_CCI_MAX_WORDS];
+
+/******************************************************
+ * I2C Transfers
+ ******************************************************/
+static void FLIR_CCI_OnTransfer(uint8_t ok)
+{
+    cci_transfer_ok = ok;
+    cci_transfer_done = 1;
+}
+
+static void FLIR_CCI_Transfer(uint8_t tx_len, uint8_t rx_len)
+{
+    cci_transfer_done = 0;
+    cci_in_flight = 1;
+    BSP_I2C1_Start(FLIR_CCI_ADDRESS, cci_tx, tx_len, cci_rx, rx_len);
+}
+
+static void FLIR_CCI_Read(uint16_t reg, uint8_t words)
+{
+    cci_tx[0] = reg >> 8;
+    cci_tx[1] = reg;
+    FLIR_CCI_Transfer(2, 2 * words);
+}
+
+static void FLIR_CCI_Write(uint16_t reg, const uint16_t *data, uint8_t words)
+{
+    cci_tx[0] = reg >> 8;
+    cci_tx[1] = reg;
+    for (uint8_t i = 0; i < words; i++) {
+        cci_tx[2 + 2 * i] = data[i] >> 8;
+        cci_tx[3 + 2 * i] = data[i];
+    }
+    FLIR_CCI_Transfer(2 + 2 * words, 0);
+}
+
+static void FLIR_CCI_Write_Word(uint16_t reg, uint16_t value)
+{
+    FLIR_CCI_Write(reg, &value, 1);
+}
+
+/******************************************************
+ * Request Sequencing
+ ******************************************************/
+static void FLIR_CCI_Finish(int8_t result)
+{
+    FLIR_CCI_Request request = cci_queue[cci_head];
+
+    // Out of the queue first, the callback may queue the next request
+    cci_head = (cci_head + 1) % FLIR_CCI_QUEUE;
+    cci_count--;
+    cci_state = FLIR_CCI_IDLE;
+    cci_repoll = 0;
+
+    if (request.On_Done) {
+        uint8_t words = ((request.Command & 0x0003) == FLIR_CCI_GET && result == FLIR_CCI_OK) ? request.Words : 0;
+
+        request.On_Done(result, request.Data, words);
+    }
+}
+
+// Busy or not booted yet: read the status again later, or give up
+static void FLIR_CCI_Wait(void)
+{
+    if (BSP_Time_us() - cci_started_at >= FLIR_CCI_TIMEOUT_US) {
+        FLIR_CCI_Finish(FLIR_CCI_TIMEOUT);
+        return;
+    }
+
+    cci_repoll = 1;
+    cci_polled_at = BSP_Time_us();
+}
+
+static void FLIR_CCI_Advance(void)
+{
+    FLIR_CCI_Request *request = &cci_queue[cci_head];
+    uint8_t type = request->Command & 0x0003;
+    uint16_t status = (cci_rx[0] << 8) | cci_rx[1];
+
+    switch (cci_state) {
+        case FLIR_CCI_READY:
+            if ((status & (FLIR_CCI_STATUS_BUSY | FLIR_CCI_STATUS_BOOT_DONE)) != FLIR_CCI_STATUS_BOOT_DONE) {
+                FLIR_CCI_Wait();
+            } else if (type == FLIR_CCI_SET && request->Words) {
+                cci_state = FLIR_CCI_DATA;
+                FLIR_CCI_Write(FLIR_CCI_REG_DATA, request->Data, request->Words);
+            } else {
+                cci_state = FLIR_CCI_LENGTH;
+                FLIR_CCI_Write_Word(FLIR_CCI_REG_LENGTH, request->Words);
+            }
+            break;
+
+        case FLIR_CCI_DATA:
+            cci_state = FLIR_CCI_LENGTH;
+            FLIR_CCI_Write_Word(FLIR_CCI_REG_LENGTH, request->Words);
+            break;
+
+        case FLIR_CCI_LENGTH:
+            cci_state = FLIR_CCI_COMMAND;
+            FLIR_CCI_Write_Word(FLIR_CCI_REG_COMMAND, request->Command);
+            break;
+
+        case FLIR_CCI_COMMAND:
+            if (request->Command == (FLIR_CCI_OEM_REBOOT | FLIR_CCI_RUN)) {
+                // Nothing to wait for, the next request waits out the boot
+                FLIR_CCI_Finish(FLIR_CCI_OK);
+                break;
+            }
+            cci_state = FLIR_CCI_DONE;
+            FLIR_CCI_Read(FLIR_CCI_REG_STATUS, 1);
+            break;
+
+        case FLIR_CCI_DONE:
+            if (status & FLIR_CCI_STATUS_BUSY) {
+                FLIR_CCI_Wait();
+            } else if ((int8_t)(status >> 8) != FLIR_CCI_OK) {
+                FLIR_CCI_Finish((int8_t)(status >> 8));
+            } else if (type == FLIR_CCI_GET && request->Words) {
+                cci_state = FLIR_CCI_RESULT;
+                FLIR_CCI_Read(FLIR_CCI_REG_DATA, request->Words);
+            } else {
+                FLIR_CCI_Finish(FLIR_CCI_OK);
+            }
+            break;
+
+        case FLIR_CCI_RESULT:
+            for (uint8_t i = 0; i < request->Words; i++) {
+                request->Data[i] = (cci_rx[2 * i] << 8) | cci_rx[2 * i + 1];
+            }
+            FLIR_CCI_Finish(FLIR_CCI_OK);
+            break;
+
+        default:
+            break;
+    }
+}
+
+void FLIR_CCI_Initialize(void)
+{
+    cci_head = 0;
+    cci_count = 0;
+    cci_state = FLIR_CCI_IDLE;
+    cci_in_flight = 0;
+    cci_repoll = 0;
+
+    BSP_Initialize_I2C1(FLIR_CCI_OnTransfer);
+}
+
+void FLIR_CCI_Poll(void)
+{
+    if (cci_in_flight) {
+        if (!cci_transfer_done) {
+            // A device holding the bus keeps the transfer from ever ending
+            if (BSP_Time_us() - cci_started_at >= FLIR_CCI_TIMEOUT_US) {
+                BSP_I2C1_Reset();
+                cci_in_flight = 0;
+                FLIR_CCI_Finish(FLIR_CCI_TIMEOUT);
+            }
+            return;
+        }
+
+        cci_in_flight = 0;
+        if (!cci_transfer_ok) {
+            FLIR_CCI_Finish(FLIR_CCI_NO_DEVICE);
+            return;
+        }
+
+        FLIR_CCI_Advance();
+    } else if (cci_repoll) {
+        if (BSP_Time_us() - cci_polled_at < FLIR_CCI_POLL_US) {
+            return;
+        }
+
+        cci_repoll = 0;
+        FLIR_CCI_Read(FLIR_CCI_REG_STATUS, 1);
+    } else if (cci_state == FLIR_CCI_IDLE && cci_count) {
+        cci_state = FLIR_CCI_READY;
+        cci_started_at = BSP_Time_us();
+        FLIR_CCI_Read(FLIR_CCI_REG_STATUS, 1);
+    }
+}
+
+// Requests queued or in flight
+uint8_t FLIR_CCI_Pending(void)
+{
+    return cci_count;
+}
+
+/******************************************************
+ * Queueing
+ ******************************************************/
+static uint8_t FLIR_CCI_Queue(uint16_t command, const uint16_t *data, uint8_t words, FLIR_CCI_Callback on_done)
+{
+    FLIR_CCI_Request *request;
+
+    if (cci_count == FLIR_CCI_QUEUE || words > FLIR_CCI_MAX_WORDS) {
+        return 0;
+    }
+
+    request = &cci_queue[(cci_head + cci_count) % FLIR_CCI_QUEUE];
+    request->Command = command;
+    request->Words = words;
+    request->On_Done = on_done;
+    for (uint8_t i = 0; i < words; i++) {
+        request->Data[i] = data ? data[i] : 0;
+    }
+
+    cci_count++;
+
+    return 1;
+}
+
+uint8_t FLIR_CCI_Get(uint16_t command, uint8_t words, FLIR_CCI_Callback on_done)
+{
+    return FLIR_CCI_Queue(command | FLIR_CCI_GET, 0, words, on_done);
+}
+
+uint8_t FLIR_CCI_Set(uint16_t command, const uint16_t *data, uint8_t words, FLIR_CCI_Callback on_done)
+{
+    return FLIR_CCI_Queue(command | FLIR_CCI_SET, data, words, on_done);
+}
+
+// The 32-bit enums most commands take
+uint8_t FLIR_CCI_Set_Value(uint16_t command, uint32_t value, FLIR_CCI_Callback on_done)
+{
+    uint16_t data[2] = { (uint16_t)value, (uint16_t)(value >> 16) };
+
+    return FLIR_CCI_Set(command, data, 2, on_done);
+}
+
+uint8_t FLIR_CCI_Run(uint16_t command, FLIR_CCI_Callback on_done)
+{
+    return FLIR_CCI_Queue(command | FLIR_CCI_RUN, 0, 0, on_done);
+}
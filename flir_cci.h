@@ -0,0 +1,111 @@
+/******************************************************
+ * FLIR Lepton 3.5 Command and Control Interface
+ * ****************************************************
+ * File:    flir_cci.h
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ ******************************************************/
+
+#ifndef FLIR_CCI_H_
+#define FLIR_CCI_H_
+
+#include <stdint.h>
+
+/******************************************************
+ * Constants
+ ******************************************************/
+#define FLIR_CCI_ADDRESS                    0x2A    // 7-bit I2C address of the Lepton
+#define FLIR_CCI_MAX_WORDS                  16      // Data registers, longer blocks need the buffer registers
+#define FLIR_CCI_QUEUE                      4       // Requests waiting behind the one in flight
+#define FLIR_CCI_POLL_US                    500     // Between two reads of a busy status
+#define FLIR_CCI_TIMEOUT_US                 2000000 // From taken to done, covers a boot and an FFC
+
+// Registers, 16-bit big-endian, the address increments over a block
+#define FLIR_CCI_REG_POWER                  0x0000
+#define FLIR_CCI_REG_STATUS                 0x0002
+#define FLIR_CCI_REG_COMMAND                0x0004
+#define FLIR_CCI_REG_LENGTH                 0x0006
+#define FLIR_CCI_REG_DATA                   0x0008
+
+#define FLIR_CCI_STATUS_BUSY                0x0001
+#define FLIR_CCI_STATUS_BOOT_MODE           0x0002
+#define FLIR_CCI_STATUS_BOOT_DONE           0x0004
+
+/******************************************************
+ * Commands
+ *
+ * Module base plus command offset; the request adds
+ * the type. OEM and RAD carry the protection bit.
+ ******************************************************/
+#define FLIR_CCI_GET                        0x0000
+#define FLIR_CCI_SET                        0x0001
+#define FLIR_CCI_RUN                        0x0002
+
+#define FLIR_CCI_AGC                        0x0100
+#define FLIR_CCI_SYS                        0x0200
+#define FLIR_CCI_VID                        0x0300
+#define FLIR_CCI_OEM                        0x4800
+#define FLIR_CCI_RAD                        0x4E00
+
+#define FLIR_CCI_AGC_ENABLE                 (FLIR_CCI_AGC + 0x00)   // 2 words, 0 or 1
+#define FLIR_CCI_AGC_POLICY                 (FLIR_CCI_AGC + 0x04)   // 2 words, 0 linear, 1 HEQ
+
+#define FLIR_CCI_SYS_PING                   (FLIR_CCI_SYS + 0x00)   // Run
+#define FLIR_CCI_SYS_STATUS                 (FLIR_CCI_SYS + 0x04)   // 4 words
+#define FLIR_CCI_SYS_UPTIME                 (FLIR_CCI_SYS + 0x0C)   // 2 words, ms
+#define FLIR_CCI_SYS_FPA_TEMPERATURE        (FLIR_CCI_SYS + 0x14)   // 1 word, centikelvin
+#define FLIR_CCI_SYS_TELEMETRY_ENABLE       (FLIR_CCI_SYS + 0x18)   // 2 words, 0 or 1
+#define FLIR_CCI_SYS_TELEMETRY_LOCATION     (FLIR_CCI_SYS + 0x1C)   // 2 words, 0 header, 1 footer
+#define FLIR_CCI_SYS_FFC_SHUTTER_MODE       (FLIR_CCI_SYS + 0x3C)   // 16 words
+#define FLIR_CCI_SYS_RUN_FFC                (FLIR_CCI_SYS + 0x40)   // Run
+#define FLIR_CCI_SYS_FFC_STATUS             (FLIR_CCI_SYS + 0x44)   // 2 words
+
+#define FLIR_CCI_VID_POLARITY               (FLIR_CCI_VID + 0x00)   // 2 words
+#define FLIR_CCI_VID_LUT_SELECT             (FLIR_CCI_VID + 0x04)   // 2 words
+#define FLIR_CCI_VID_OUTPUT_FORMAT          (FLIR_CCI_VID + 0x30)   // 2 words
+
+#define FLIR_CCI_RAD_ENABLE                 (FLIR_CCI_RAD + 0x10)   // 2 words, 0 or 1
+#define FLIR_CCI_RAD_TLINEAR_ENABLE         (FLIR_CCI_RAD + 0xC0)   // 2 words, 0 or 1
+#define FLIR_CCI_RAD_TLINEAR_RESOLUTION     (FLIR_CCI_RAD + 0xC4)   // 2 words, 0 for 0.1 K, 1 for 0.01 K
+
+#define FLIR_CCI_OEM_VIDEO_OUTPUT_FORMAT    (FLIR_CCI_OEM + 0x28)   // 2 words, 3 RGB888, 7 RAW14
+#define FLIR_CCI_OEM_REBOOT                 (FLIR_CCI_OEM + 0x40)   // Run
+#define FLIR_CCI_OEM_GPIO_MODE              (FLIR_CCI_OEM + 0x54)   // 2 words, 5 VSYNC
+
+/******************************************************
+ * Results
+ *
+ * Zero or the camera's own error code, which is signed
+ * and sits in the upper byte of the status register,
+ * or one of the two the client adds.
+ ******************************************************/
+#define FLIR_CCI_OK                         0
+#define FLIR_CCI_DATA_SIZE                  -6
+#define FLIR_CCI_UNDEFINED_FUNCTION         -7
+#define FLIR_CCI_NO_DEVICE                  -108    // A byte was not acknowledged
+#define FLIR_CCI_TIMEOUT                    -109    // Busy, not booted or the bus held for FLIR_CCI_TIMEOUT_US
+
+/******************************************************
+ * Requests
+ *
+ * Requests are queued and carried out one at a time by
+ * FLIR_CCI_Poll(), which never waits: each call starts
+ * or follows up on a single I2C transfer, so it fits in
+ * the loops that wait for the capture. The callback runs
+ * from FLIR_CCI_Poll() with the result and, for a get,
+ * the words read; a value of several words comes least
+ * significant word first. The queueing functions return
+ * 0 when the queue is full.
+ ******************************************************/
+typedef void (*FLIR_CCI_Callback)(int8_t result, const uint16_t *data, uint8_t words);
+
+void FLIR_CCI_Initialize(void);
+void FLIR_CCI_Poll(void);
+uint8_t FLIR_CCI_Pending(void);
+
+uint8_t FLIR_CCI_Get(uint16_t command, uint8_t words, FLIR_CCI_Callback on_done);
+uint8_t FLIR_CCI_Set(uint16_t command, const uint16_t *data, uint8_t words, FLIR_CCI_Callback on_done);
+uint8_t FLIR_CCI_Set_Value(uint16_t command, uint32_t value, FLIR_CCI_Callback on_done);
+uint8_t FLIR_CCI_Run(uint16_t command, FLIR_CCI_Callback on_done);
+
+#endif /* FLIR_CCI_H_ */
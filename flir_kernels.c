@@ -0,0 +1,450 @@
+/******************************************************
+ * FLIR Lepton 3.5 Pixel Kernels for PIC32 MZ
+ * ****************************************************
+ * File:    flir_kernels.c
+ * Date:    16.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ ******************************************************/
+
+#include "flir_kernels.h"
+#include "BSP.h"
+#include <string.h>
+
+/******************************************************
+ * MIPS DSP ASE Rev 2 Primitives
+ *
+ * On the microAptiv core these map to single paired
+ * 16-bit instructions. Elsewhere (host builds, parts
+ * without the ASE) they are bit-exact C models, so the
+ * DSP kernel can be cross-checked against the reference
+ * on any machine.
+ ******************************************************/
+#if defined(__XC32) && !defined(__mips_dspr2)
+#warning "flir_kernels.c is built without -mdspr2, the DSP kernel falls back to the C models"
+#endif
+
+#if defined(__mips_dspr2)
+
+typedef short v2i16 __attribute__ ((vector_size(4)));
+
+#define DSP_ADDU_PH(a, b)                   ((uint32_t)__builtin_mips_addu_ph((v2i16)(a), (v2i16)(b)))
+#define DSP_SUBU_PH(a, b)                   ((uint32_t)__builtin_mips_subu_ph((v2i16)(a), (v2i16)(b)))
+#define DSP_SUBU_S_PH(a, b)                 ((uint32_t)__builtin_mips_subu_s_ph((v2i16)(a), (v2i16)(b)))
+#define DSP_SHRL_PH(a, s)                   ((uint32_t)__builtin_mips_shrl_ph((v2i16)(a), (s)))
+
+// Swap the bytes of each halfword: two big-endian pixels in one instruction
+static inline uint32_t DSP_WSBH(uint32_t a)
+{
+    uint32_t r;
+
+    __asm__ ("wsbh %0, %1" : "=r" (r) : "r" (a));
+
+    return r;
+}
+
+#else
+
+static inline uint32_t DSP_ADDU_PH(uint32_t a, uint32_t b)
+{
+    return ((a + b) & 0x0000FFFF) | (((a >> 16) + (b >> 16)) << 16);
+}
+
+static inline uint32_t DSP_SUBU_PH(uint32_t a, uint32_t b)
+{
+    return ((a - b) & 0x0000FFFF) | (((a >> 16) - (b >> 16)) << 16);
+}
+
+static inline uint32_t DSP_SUBU_S_PH(uint32_t a, uint32_t b)
+{
+    uint32_t lo = ((a & 0xFFFF) > (b & 0xFFFF)) ? (a & 0xFFFF) - (b & 0xFFFF) : 0;
+    uint32_t hi = ((a >> 16) > (b >> 16)) ? (a >> 16) - (b >> 16) : 0;
+
+    return lo | (hi << 16);
+}
+
+static inline uint32_t DSP_SHRL_PH(uint32_t a, uint8_t s)
+{
+    return ((a & 0xFFFF) >> s) | (((a >> 16) >> s) << 16);
+}
+
+static inline uint32_t DSP_WSBH(uint32_t a)
+{
+    return ((a >> 8) & 0x00FF00FF) | ((a << 8) & 0xFF00FF00);
+}
+
+#endif
+
+/******************************************************
+ * Packet Kernels
+ ******************************************************/
+int FLIR_Kernel_Packet_C(const uint8_t *packet, uint16_t *indices, const FLIR_Kernel_Params *params, FLIR_Kernel_Range *range)
+{
+    const uint8_t *payload = packet + FLIR_KERNEL_HEADER_SIZE;
+    uint16_t min_value = range->Min;
+    uint16_t max_value = range->Max;
+    int i;
+
+    for (i = 0; i < FLIR_KERNEL_PIXELS; i++) {
+        // Flip the MSB and LSB
+        uint16_t value = (payload[2 * i] << 8) | payload[2 * i + 1];
+        uint32_t offset;
+
+        if (value == 0) {
+            break;
+        }
+
+        if (value > max_value) {
+            max_value = value;
+        }
+
+        if (value < min_value) {
+            min_value = value;
+        }
+
+        offset = (value > params->Base) ? value - params->Base : 0;
+        if (offset > params->Limit) {
+            offset = params->Limit;
+        }
+
+        if (params->Mul) {
+            indices[i] = (uint16_t)(((uint64_t)offset * params->Mul) >> params->Shift);
+        } else {
+            indices[i] = (uint16_t)(offset >> params->Shift);
+        }
+    }
+
+    range->Min = min_value;
+    range->Max = max_value;
+
+    return i;
+}
+
+/*
+ * Two pixels per step: the payload is read as words, by
+ * memcpy so it stays a byte buffer to the compiler, and
+ * as the packet is word aligned each is a single lw. The
+ * words are byte-swapped with WSBH and then clamped with
+ * saturating subtractions, using
+ *      max(a, b) = b + (a -sat b)
+ *      min(a, b) = a - (a -sat b)
+ * so no lane compare is needed. A packet holding a zero
+ * pixel is handed to the reference kernel, which knows
+ * where to stop.
+ */
+int FLIR_Kernel_Packet_DSP(const uint8_t *packet, uint16_t *indices, const FLIR_Kernel_Params *params, FLIR_Kernel_Range *range)
+{
+    const uint8_t *payload = __builtin_assume_aligned(packet + FLIR_KERNEL_HEADER_SIZE, 4);
+    uint32_t base = params->Base * 0x00010001u;
+    uint32_t limit = params->Limit * 0x00010001u;
+    uint32_t min_pair = range->Min * 0x00010001u;
+    uint32_t max_pair = range->Max * 0x00010001u;
+    uint32_t zero = 0;
+    uint32_t pair, offset;
+    int i;
+
+    if (params->Mul) {
+        for (i = 0; i < FLIR_KERNEL_PIXELS / 2; i++) {
+            memcpy(&pair, payload + 4 * i, 4);
+            pair = DSP_WSBH(pair);
+
+            zero |= DSP_SUBU_S_PH(0x00010001u, pair);
+            max_pair = DSP_ADDU_PH(max_pair, DSP_SUBU_S_PH(pair, max_pair));
+            min_pair = DSP_SUBU_PH(min_pair, DSP_SUBU_S_PH(min_pair, pair));
+
+            offset = DSP_SUBU_S_PH(pair, base);
+            offset = DSP_SUBU_PH(offset, DSP_SUBU_S_PH(offset, limit));
+
+            indices[2 * i] = (uint16_t)(((uint64_t)(offset & 0xFFFF) * params->Mul) >> params->Shift);
+            indices[2 * i + 1] = (uint16_t)(((uint64_t)(offset >> 16) * params->Mul) >> params->Shift);
+        }
+    } else {
+        for (i = 0; i < FLIR_KERNEL_PIXELS / 2; i++) {
+            memcpy(&pair, payload + 4 * i, 4);
+            pair = DSP_WSBH(pair);
+
+            zero |= DSP_SUBU_S_PH(0x00010001u, pair);
+            max_pair = DSP_ADDU_PH(max_pair, DSP_SUBU_S_PH(pair, max_pair));
+            min_pair = DSP_SUBU_PH(min_pair, DSP_SUBU_S_PH(min_pair, pair));
+
+            offset = DSP_SUBU_S_PH(pair, base);
+            offset = DSP_SUBU_PH(offset, DSP_SUBU_S_PH(offset, limit));
+            offset = DSP_SHRL_PH(offset, params->Shift);
+
+            indices[2 * i] = (uint16_t)offset;
+            indices[2 * i + 1] = (uint16_t)(offset >> 16);
+        }
+    }
+
+    if (zero) {
+        return FLIR_Kernel_Packet_C(packet, indices, params, range);
+    }
+
+    // Fold the two lanes
+    range->Min = ((min_pair & 0xFFFF) < (min_pair >> 16)) ? (min_pair & 0xFFFF) : (min_pair >> 16);
+    range->Max = ((max_pair & 0xFFFF) > (max_pair >> 16)) ? (max_pair & 0xFFFF) : (max_pair >> 16);
+
+    return FLIR_KERNEL_PIXELS;
+}
+
+/******************************************************
+ * Packet CRC
+ *
+ * The sliced kernel folds four bytes per step through
+ * four 256-entry tables: table n holds the CRC of a byte
+ * followed by n zero bytes, so a step is four loads and
+ * XORs instead of 32 shift-and-test rounds. The 160-byte
+ * payload is 40 such steps. The header goes in as a
+ * single step on its own, its last two bytes being zero.
+ ******************************************************/
+#define FLIR_KERNEL_CRC_POLY                0x1021
+
+static uint16_t crc_tables[4][256];
+
+void FLIR_Kernel_CRC_Initialize(void)
+{
+    for (int i = 0; i < 256; i++) {
+        uint8_t byte = (uint8_t)i;
+        
+        crc_tables[0][i] = FLIR_Kernel_CRC_Bitwise(&byte, 1, 0);
+    }
+    
+    for (int n = 1; n < 4; n++) {
+        for (int i = 0; i < 256; i++) {
+            uint16_t crc = crc_tables[n - 1][i];
+            
+            crc_tables[n][i] = (uint16_t)(crc << 8) ^ crc_tables[0][crc >> 8];
+        }
+    }
+}
+
+// Reference, one bit at a time
+uint16_t FLIR_Kernel_CRC_Bitwise(const uint8_t *data, int len, uint16_t crc)
+{
+    while (len-- > 0) {
+        crc ^= (uint16_t)(*data++ << 8);
+        
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ FLIR_KERNEL_CRC_POLY) : (uint16_t)(crc << 1);
+        }
+    }
+    
+    return crc;
+}
+
+uint16_t FLIR_Kernel_CRC_Sliced(const uint8_t *data, int len, uint16_t crc)
+{
+    for (; len >= 4; len -= 4, data += 4) {
+        crc = crc_tables[3][(crc >> 8) ^ data[0]] ^ crc_tables[2][(crc & 0xFF) ^ data[1]] ^ crc_tables[1][data[2]] ^ crc_tables[0][data[3]];
+    }
+    
+    for (; len > 0; len--) {
+        crc = (uint16_t)(crc << 8) ^ crc_tables[0][(crc >> 8) ^ *data++];
+    }
+    
+    return crc;
+}
+
+// True when the packet holds the CRC of its contents
+int FLIR_Kernel_Packet_CRC_OK(const uint8_t *packet)
+{
+    uint16_t crc = crc_tables[3][packet[0] & 0x0F] ^ crc_tables[2][packet[1]];
+    
+    crc = FLIR_Kernel_CRC_Sliced(packet + FLIR_KERNEL_HEADER_SIZE, 2 * FLIR_KERNEL_PIXELS, crc);
+    
+    return crc == ((packet[2] << 8) | packet[3]);
+}
+
+/******************************************************
+ * Verification
+ ******************************************************/
+static uint32_t kernel_seed = 0x4C455054;
+
+static uint32_t FLIR_Kernel_Random(void)
+{
+    kernel_seed = kernel_seed * 1664525u + 1013904223u;
+
+    return kernel_seed >> 8;
+}
+
+// Parameters as the AGC builds them, for a range of diff counts
+static void FLIR_Kernel_Linear_Params(FLIR_Kernel_Params *params, uint16_t base, uint16_t diff)
+{
+    params->Base = base;
+    params->Limit = diff;
+    params->Shift = 24;
+
+    while ((2u << (params->Shift - 24)) <= diff) {
+        params->Shift++;
+    }
+
+    params->Mul = (uint32_t)((((uint64_t)255 << params->Shift) + diff - 1) / diff);
+}
+
+static void FLIR_Kernel_Random_Packet(uint8_t *packet, uint16_t base, uint16_t spread)
+{
+    int zero_at = (FLIR_Kernel_Random() & 7) ? -1 : (int)(FLIR_Kernel_Random() % FLIR_KERNEL_PIXELS);
+
+    for (int i = 0; i < FLIR_KERNEL_PIXELS; i++) {
+        uint16_t value = (i == zero_at) ? 0 : (uint16_t)(base + FLIR_Kernel_Random() % spread);
+
+        packet[FLIR_KERNEL_HEADER_SIZE + 2 * i] = value >> 8;
+        packet[FLIR_KERNEL_HEADER_SIZE + 2 * i + 1] = value & 0xFF;
+    }
+}
+
+// The CRC a packet should hold, with the reference
+static uint16_t FLIR_Kernel_Packet_CRC_Bitwise(const uint8_t *packet)
+{
+    uint8_t header[FLIR_KERNEL_HEADER_SIZE] = { packet[0] & 0x0F, packet[1], 0, 0 };
+    uint16_t crc = FLIR_Kernel_CRC_Bitwise(header, FLIR_KERNEL_HEADER_SIZE, 0);
+    
+    return FLIR_Kernel_CRC_Bitwise(packet + FLIR_KERNEL_HEADER_SIZE, 2 * FLIR_KERNEL_PIXELS, crc);
+}
+
+// Fill in the CRC as the Lepton would
+static void FLIR_Kernel_Set_CRC(uint8_t *packet)
+{
+    uint16_t crc = FLIR_Kernel_Packet_CRC_Bitwise(packet);
+    
+    packet[2] = crc >> 8;
+    packet[3] = crc & 0xFF;
+}
+
+// Cross-check the sliced CRC against the reference, returns the number of mismatches
+static uint32_t FLIR_Kernel_CRC_Self_Test(uint8_t *packet)
+{
+    uint32_t mismatches = 0;
+    
+    FLIR_Kernel_CRC_Initialize();
+    
+    for (int run = 0; run < 1024; run++) {
+        int len = FLIR_Kernel_Random() % (FLIR_KERNEL_HEADER_SIZE + 2 * FLIR_KERNEL_PIXELS + 1);
+        uint16_t crc = (uint16_t)FLIR_Kernel_Random();
+        int byte;
+        
+        FLIR_Kernel_Random_Packet(packet, 0, 65535);
+        packet[0] = (uint8_t)FLIR_Kernel_Random();
+        packet[1] = (uint8_t)FLIR_Kernel_Random();
+        
+        if (FLIR_Kernel_CRC_Bitwise(packet, len, crc) != FLIR_Kernel_CRC_Sliced(packet, len, crc)) {
+            mismatches++;
+        }
+        
+        // The T bits are not covered, any other flipped bit is caught
+        FLIR_Kernel_Set_CRC(packet);
+        packet[0] ^= (uint8_t)(FLIR_Kernel_Random() & 0xF0);
+        if (!FLIR_Kernel_Packet_CRC_OK(packet)) {
+            mismatches++;
+        }
+        
+        byte = FLIR_Kernel_Random() % (FLIR_KERNEL_HEADER_SIZE + 2 * FLIR_KERNEL_PIXELS);
+        packet[byte] ^= (uint8_t)(1 << (FLIR_Kernel_Random() % ((byte == 0) ? 4 : 8)));
+        if (FLIR_Kernel_Packet_CRC_OK(packet)) {
+            mismatches++;
+        }
+    }
+    
+    return mismatches;
+}
+
+// Cross-check the DSP kernel and the sliced CRC against the references, returns the number of mismatching packets
+uint32_t FLIR_Kernel_Self_Test(void)
+{
+    static uint32_t packet_words[(FLIR_KERNEL_HEADER_SIZE + 2 * FLIR_KERNEL_PIXELS) / 4];
+    uint8_t *packet = (uint8_t *)packet_words;
+    uint16_t indices_c[FLIR_KERNEL_PIXELS];
+    uint16_t indices_dsp[FLIR_KERNEL_PIXELS];
+    uint32_t mismatches = 0;
+
+    for (int run = 0; run < 4096; run++) {
+        FLIR_Kernel_Params params;
+        FLIR_Kernel_Range range_c = { 65535, 0 };
+        FLIR_Kernel_Range range_dsp = { 65535, 0 };
+        uint16_t base = (uint16_t)(FLIR_Kernel_Random() & 0x7FFF);
+        uint16_t spread = (uint16_t)(1 + FLIR_Kernel_Random() % (65535 - base));
+        int count_c, count_dsp;
+
+        if (run & 1) {
+            FLIR_Kernel_Linear_Params(&params, base + spread / 8, 1 + spread / 2);
+        } else {
+            params.Base = base + spread / 8;
+            params.Shift = FLIR_Kernel_Random() % 8;
+            params.Limit = (uint16_t)(((1024u << params.Shift) - 1 < 65535u) ? (1024u << params.Shift) - 1 : 65535u);
+            params.Mul = 0;
+        }
+
+        FLIR_Kernel_Random_Packet(packet, base, spread);
+
+        count_c = FLIR_Kernel_Packet_C(packet, indices_c, &params, &range_c);
+        count_dsp = FLIR_Kernel_Packet_DSP(packet, indices_dsp, &params, &range_dsp);
+
+        if ((count_c != count_dsp) || (range_c.Min != range_dsp.Min) || (range_c.Max != range_dsp.Max)) {
+            mismatches++;
+            continue;
+        }
+
+        for (int i = 0; i < count_c; i++) {
+            if (indices_c[i] != indices_dsp[i]) {
+                mismatches++;
+                break;
+            }
+        }
+    }
+
+    return mismatches + FLIR_Kernel_CRC_Self_Test(packet);
+}
+
+// SYSCLK cycles taken by each kernel over one 60-packet segment
+void FLIR_Kernel_Benchmark(uint32_t *cycles_c, uint32_t *cycles_dsp)
+{
+    static uint32_t packet_words[(FLIR_KERNEL_HEADER_SIZE + 2 * FLIR_KERNEL_PIXELS) / 4];
+    uint8_t *packet = (uint8_t *)packet_words;
+    uint16_t indices[FLIR_KERNEL_PIXELS];
+    FLIR_Kernel_Params params;
+    FLIR_Kernel_Range range = { 65535, 0 };
+    uint32_t start;
+
+    FLIR_Kernel_Linear_Params(&params, 29500, 1000);
+
+    // A zero-free packet, so the DSP kernel never falls back
+    do {
+        FLIR_Kernel_Random_Packet(packet, 29000, 2000);
+    } while (FLIR_Kernel_Packet_C(packet, indices, &params, &range) != FLIR_KERNEL_PIXELS);
+
+    start = BSP_Cycle_Count();
+    for (int i = 0; i < 60; i++) {
+        FLIR_Kernel_Packet_C(packet, indices, &params, &range);
+    }
+    *cycles_c = BSP_Cycle_Count() - start;
+
+    start = BSP_Cycle_Count();
+    for (int i = 0; i < 60; i++) {
+        FLIR_Kernel_Packet_DSP(packet, indices, &params, &range);
+    }
+    *cycles_dsp = BSP_Cycle_Count() - start;
+}
+
+// SYSCLK cycles taken to check the CRC of one 60-packet segment, bit by bit and sliced
+void FLIR_Kernel_Benchmark_CRC(uint32_t *cycles_bitwise, uint32_t *cycles_sliced)
+{
+    static uint32_t packet_words[(FLIR_KERNEL_HEADER_SIZE + 2 * FLIR_KERNEL_PIXELS) / 4];
+    uint8_t *packet = (uint8_t *)packet_words;
+    volatile int ok = 0;
+    uint32_t start;
+
+    FLIR_Kernel_CRC_Initialize();
+    FLIR_Kernel_Random_Packet(packet, 29000, 2000);
+    FLIR_Kernel_Set_CRC(packet);
+
+    start = BSP_Cycle_Count();
+    for (int i = 0; i < 60; i++) {
+        ok += FLIR_Kernel_Packet_CRC_Bitwise(packet) == ((packet[2] << 8) | packet[3]);
+    }
+    *cycles_bitwise = BSP_Cycle_Count() - start;
+
+    start = BSP_Cycle_Count();
+    for (int i = 0; i < 60; i++) {
+        ok += FLIR_Kernel_Packet_CRC_OK(packet);
+    }
+    *cycles_sliced = BSP_Cycle_Count() - start;
+}
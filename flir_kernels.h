@@ -0,0 +1,80 @@
+/******************************************************
+ * FLIR Lepton 3.5 Pixel Kernels for PIC32 MZ
+ * ****************************************************
+ * File:    flir_kernels.h
+ * Date:    16.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ ******************************************************/
+
+#ifndef FLIR_KERNELS_H_
+#define FLIR_KERNELS_H_
+
+#include <stdint.h>
+
+/******************************************************
+ * Constants
+ ******************************************************/
+#define FLIR_KERNEL_HEADER_SIZE             4       // Header bytes in front of the payload
+#define FLIR_KERNEL_PIXELS                  80      // Pixels in one VoSPI packet payload
+
+/******************************************************
+ * Data Structures
+ ******************************************************/
+
+// index = ((min(max(value - Base, 0), Limit) * Mul) >> Shift, or without the multiply when Mul == 0
+typedef struct
+{
+    uint16_t Base;
+    uint16_t Limit;
+    uint32_t Mul;
+    uint8_t Shift;
+} FLIR_Kernel_Params;
+
+// Running range of the non-zero pixels seen so far
+typedef struct
+{
+    uint16_t Min;
+    uint16_t Max;
+} FLIR_Kernel_Range;
+
+/******************************************************
+ * Packet Kernels
+ *
+ * Unpack the 80 big-endian pixels of one packet, skip
+ * its header, widen the range and write the table index
+ * of every pixel. Processing stops at the first zero
+ * pixel; the return value is the number of pixels done.
+ * The packet must be 4-byte aligned, as the capture
+ * slots are: the DSP kernel loads its payload in words.
+ ******************************************************/
+int FLIR_Kernel_Packet_C(const uint8_t *packet, uint16_t *indices, const FLIR_Kernel_Params *params, FLIR_Kernel_Range *range);
+int FLIR_Kernel_Packet_DSP(const uint8_t *packet, uint16_t *indices, const FLIR_Kernel_Params *params, FLIR_Kernel_Range *range);
+
+#if defined(__mips_dspr2)
+#define FLIR_Kernel_Packet                  FLIR_Kernel_Packet_DSP
+#else
+#define FLIR_Kernel_Packet                  FLIR_Kernel_Packet_C
+#endif
+
+/******************************************************
+ * Packet CRC
+ *
+ * CRC-16-CCITT as VoSPI uses it: x^16 + x^12 + x^5 + 1,
+ * MSB first from a zero initial value, over the whole
+ * packet with the four upper ID bits and the CRC field
+ * taken as zero. Call FLIR_Kernel_CRC_Initialize() once
+ * to build the tables before any of the others.
+ ******************************************************/
+void FLIR_Kernel_CRC_Initialize(void);
+uint16_t FLIR_Kernel_CRC_Bitwise(const uint8_t *data, int len, uint16_t crc);
+uint16_t FLIR_Kernel_CRC_Sliced(const uint8_t *data, int len, uint16_t crc);
+int FLIR_Kernel_Packet_CRC_OK(const uint8_t *packet);
+
+/******************************************************
+ * Verification
+ ******************************************************/
+uint32_t FLIR_Kernel_Self_Test(void);
+void FLIR_Kernel_Benchmark(uint32_t *cycles_c, uint32_t *cycles_dsp);
+void FLIR_Kernel_Benchmark_CRC(uint32_t *cycles_bitwise, uint32_t *cycles_sliced);
+
+#endif /* FLIR_KERNELS_H_ */
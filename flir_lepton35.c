@@ -7,7 +7,11 @@
  ******************************************************/
 
 #include "flir_lepton35.h"
+#include "flir_kernels.h"
 #include "BSP.h"
+#ifdef FLIR_CONFIG_CCI
+#include "flir_cci.h"
+#endif
 #include <string.h>
 #include <stdlib.h>
 
@@ -15,7 +19,7 @@
  * Constants
  ******************************************************/
 
-#define FLIR_COLORMAP_SIZE                  3 * 256
+#define FLIR_PALETTE_SIZE                   256
 #define PACKET_SIZE                         164
 #define PACKET_SIZE_UINT16                  (PACKET_SIZE / 2)
 #define PACKETS_PER_FRAME                   60
@@ -24,149 +28,1659 @@
 #define true                                1
 #define false                               0
 
-static const int colormap_ironblack[] = {255, 255, 255, 253, 253, 253, 251, 251, 251, 249, 249, 249, 247, 247, 247, 245, 245, 245, 243, 243, 243, 241, 241, 241, 239, 239, 239, 237, 237, 237, 235, 235, 235, 233, 233, 233, 231, 231, 231, 229, 229, 229, 227, 227, 227, 225, 225, 225, 223, 223, 223, 221, 221, 221, 219, 219, 219, 217, 217, 217, 215, 215, 215, 213, 213, 213, 211, 211, 211, 209, 209, 209, 207, 207, 207, 205, 205, 205, 203, 203, 203, 201, 201, 201, 199, 199, 199, 197, 197, 197, 195, 195, 195, 193, 193, 193, 191, 191, 191, 189, 189, 189, 187, 187, 187, 185, 185, 185, 183, 183, 183, 181, 181, 181, 179, 179, 179, 177, 177, 177, 175, 175, 175, 173, 173, 173, 171, 171, 171, 169, 169, 169, 167, 167, 167, 165, 165, 165, 163, 163, 163, 161, 161, 161, 159, 159, 159, 157, 157, 157, 155, 155, 155, 153, 153, 153, 151, 151, 151, 149, 149, 149, 147, 147, 147, 145, 145, 145, 143, 143, 143, 141, 141, 141, 139, 139, 139, 137, 137, 137, 135, 135, 135, 133, 133, 133, 131, 131, 131, 129, 129, 129, 126, 126, 126, 124, 124, 124, 122, 122, 122, 120, 120, 120, 118, 118, 118, 116, 116, 116, 114, 114, 114, 112, 112, 112, 110, 110, 110, 108, 108, 108, 106, 106, 106, 104, 104, 104, 102, 102, 102, 100, 100, 100, 98, 98, 98, 96, 96, 96, 94, 94, 94, 92, 92, 92, 90, 90, 90, 88, 88, 88, 86, 86, 86, 84, 84, 84, 82, 82, 82, 80, 80, 80, 78, 78, 78, 76, 76, 76, 74, 74, 74, 72, 72, 72, 70, 70, 70, 68, 68, 68, 66, 66, 66, 64, 64, 64, 62, 62, 62, 60, 60, 60, 58, 58, 58, 56, 56, 56, 54, 54, 54, 52, 52, 52, 50, 50, 50, 48, 48, 48, 46, 46, 46, 44, 44, 44, 42, 42, 42, 40, 40, 40, 38, 38, 38, 36, 36, 36, 34, 34, 34, 32, 32, 32, 30, 30, 30, 28, 28, 28, 26, 26, 26, 24, 24, 24, 22, 22, 22, 20, 20, 20, 18, 18, 18, 16, 16, 16, 14, 14, 14, 12, 12, 12, 10, 10, 10, 8, 8, 8, 6, 6, 6, 4, 4, 4, 2, 2, 2, 0, 0, 0, 0, 0, 9, 2, 0, 16, 4, 0, 24, 6, 0, 31, 8, 0, 38, 10, 0, 45, 12, 0, 53, 14, 0, 60, 17, 0, 67, 19, 0, 74, 21, 0, 82, 23, 0, 89, 25, 0, 96, 27, 0, 103, 29, 0, 111, 31, 0, 118, 36, 0, 120, 41, 0, 121, 46, 0, 122, 51, 0, 123, 56, 0, 124, 61, 0, 125, 66, 0, 126, 71, 0, 127, 76, 1, 128, 81, 1, 129, 86, 1, 130, 91, 1, 131, 96, 1, 132, 101, 1, 133, 106, 1, 134, 111, 1, 135, 116, 1, 136, 121, 1, 136, 125, 2, 137, 130, 2, 137, 135, 3, 137, 139, 3, 138, 144, 3, 138, 149, 4, 138, 153, 4, 139, 158, 5, 139, 163, 5, 139, 167, 5, 140, 172, 6, 140, 177, 6, 140, 181, 7, 141, 186, 7, 141, 189, 10, 137, 191, 13, 132, 194, 16, 127, 196, 19, 121, 198, 22, 116, 200, 25, 111, 203, 28, 106, 205, 31, 101, 207, 34, 95, 209, 37, 90, 212, 40, 85, 214, 43, 80, 216, 46, 75, 218, 49, 69, 221, 52, 64, 223, 55, 59, 224, 57, 49, 225, 60, 47, 226, 64, 44, 227, 67, 42, 228, 71, 39, 229, 74, 37, 230, 78, 34, 231, 81, 32, 231, 85, 29, 232, 88, 27, 233, 92, 24, 234, 95, 22, 235, 99, 19, 236, 102, 17, 237, 106, 14, 238, 109, 12, 239, 112, 12, 240, 116, 12, 240, 119, 12, 241, 123, 12, 241, 127, 12, 242, 130, 12, 242, 134, 12, 243, 138, 12, 243, 141, 13, 244, 145, 13, 244, 149, 13, 245, 152, 13, 245, 156, 13, 246, 160, 13, 246, 163, 13, 247, 167, 13, 247, 171, 13, 248, 175, 14, 248, 178, 15, 249, 182, 16, 249, 185, 18, 250, 189, 19, 250, 192, 20, 251, 196, 21, 251, 199, 22, 252, 203, 23, 252, 206, 24, 253, 210, 25, 253, 213, 27, 254, 217, 28, 254, 220, 29, 255, 224, 30, 255, 227, 39, 255, 229, 53, 255, 231, 67, 255, 233, 81, 255, 234, 95, 255, 236, 109, 255, 238, 123, 255, 240, 137, 255, 242, 151, 255, 244, 165, 255, 246, 179, 255, 248, 193, 255, 249, 207, 255, 251, 221, 255, 253, 235, 255, 255, 24,
--1};
-
-static const int colormap_grayscale[] = 
-{
-    0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5, 5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10, 10,
-    11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15, 16, 16, 16, 17, 17, 17, 18, 18, 18, 19, 19,
-    19, 20, 20, 20, 21, 21, 21, 22, 22, 22, 23, 23, 23, 24, 24, 24, 25, 25, 25, 26, 26, 26, 27, 27, 27, 28,
-    28, 28, 29, 29, 29, 30, 30, 30, 31, 31, 31, 32, 32, 32, 33, 33, 33, 34, 34, 34, 35, 35, 35, 36, 36, 36,
-    37, 37, 37, 38, 38, 38, 39, 39, 39, 40, 40, 40, 41, 41, 41, 42, 42, 42, 43, 43, 43, 44, 44, 44, 45, 45,
-    45, 46, 46, 46, 47, 47, 47, 48, 48, 48, 49, 49, 49, 50, 50, 50, 51, 51, 51, 52, 52, 52, 53, 53, 53, 54,
-    54, 54, 55, 55, 55, 56, 56, 56, 57, 57, 57, 58, 58, 58, 59, 59, 59, 60, 60, 60, 61, 61, 61, 62, 62, 62,
-    63, 63, 63, 64, 64, 64, 65, 65, 65, 66, 66, 66, 67, 67, 67, 68, 68, 68, 69, 69, 69, 70, 70, 70, 71, 71,
-    71, 72, 72, 72, 73, 73, 73, 74, 74, 74, 75, 75, 75, 76, 76, 76, 77, 77, 77, 78, 78, 78, 79, 79, 79, 80,
-    80, 80, 81, 81, 81, 82, 82, 82, 83, 83, 83, 84, 84, 84, 85, 85, 85, 86, 86, 86, 87, 87, 87, 88, 88, 88,
-    89, 89, 89, 90, 90, 90, 91, 91, 91, 92, 92, 92, 93, 93, 93, 94, 94, 94, 95, 95, 95, 96, 96, 96, 97, 97,
-    97, 98, 98, 98, 99, 99, 99, 100, 100, 100, 101, 101, 101, 102, 102, 102, 103, 103, 103, 104, 104, 104,
-    105, 105, 105, 106, 106, 106, 107, 107, 107, 108, 108, 108, 109, 109, 109, 110, 110, 110, 111, 111, 111,
-    112, 112, 112, 113, 113, 113, 114, 114, 114, 115, 115, 115, 116, 116, 116, 117, 117, 117, 118, 118, 118,
-    119, 119, 119, 120, 120, 120, 121, 121, 121, 122, 122, 122, 123, 123, 123, 124, 124, 124, 125, 125, 125,
-    126, 126, 126, 127, 127, 127, 128, 128, 128, 129, 129, 129, 130, 130, 130, 131, 131, 131, 132, 132, 132,
-    133, 133, 133, 134, 134, 134, 135, 135, 135, 136, 136, 136, 137, 137, 137, 138, 138, 138, 139, 139, 139,
-    140, 140, 140, 141, 141, 141, 142, 142, 142, 143, 143, 143, 144, 144, 144, 145, 145, 145, 146, 146, 146,
-    147, 147, 147, 148, 148, 148, 149, 149, 149, 150, 150, 150, 151, 151, 151, 152, 152, 152, 153, 153, 153,
-    154, 154, 154, 155, 155, 155, 156, 156, 156, 157, 157, 157, 158, 158, 158, 159, 159, 159, 160, 160, 160,
-    161, 161, 161, 162, 162, 162, 163, 163, 163, 164, 164, 164, 165, 165, 165, 166, 166, 166, 167, 167, 167,
-    168, 168, 168, 169, 169, 169, 170, 170, 170, 171, 171, 171, 172, 172, 172, 173, 173, 173, 174, 174, 174,
-    175, 175, 175, 176, 176, 176, 177, 177, 177, 178, 178, 178, 179, 179, 179, 180, 180, 180, 181, 181, 181,
-    182, 182, 182, 183, 183, 183, 184, 184, 184, 185, 185, 185, 186, 186, 186, 187, 187, 187, 188, 188, 188,
-    189, 189, 189, 190, 190, 190, 191, 191, 191, 192, 192, 192, 193, 193, 193, 194, 194, 194, 195, 195, 195,
-    196, 196, 196, 197, 197, 197, 198, 198, 198, 199, 199, 199, 200, 200, 200, 201, 201, 201, 202, 202, 202,
-    203, 203, 203, 204, 204, 204, 205, 205, 205, 206, 206, 206, 207, 207, 207, 208, 208, 208, 209, 209, 209,
-    210, 210, 210, 211, 211, 211, 212, 212, 212, 213, 213, 213, 214, 214, 214, 215, 215, 215, 216, 216, 216,
-    217, 217, 217, 218, 218, 218, 219, 219, 219, 220, 220, 220, 221, 221, 221, 222, 222, 222, 223, 223, 223,
-    224, 224, 224, 225, 225, 225, 226, 226, 226, 227, 227, 227, 228, 228, 228, 229, 229, 229, 230, 230, 230,
-    231, 231, 231, 232, 232, 232, 233, 233, 233, 234, 234, 234, 235, 235, 235, 236, 236, 236, 237, 237, 237,
-    238, 238, 238, 239, 239, 239, 240, 240, 240, 241, 241, 241, 242, 242, 242, 243, 243, 243, 244, 244, 244,
-    245, 245, 245, 246, 246, 246, 247, 247, 247, 248, 248, 248, 249, 249, 249, 250, 250, 250, 251, 251, 251,
-    252, 252, 252, 253, 253, 253, 254, 254, 254, 255, 255, 255, -1
+#define FLIR_CAPTURE_IDLE                   0
+#define FLIR_CAPTURE_BUSY                   1
+#define FLIR_CAPTURE_DONE                   2
+#define FLIR_CAPTURE_RESYNC                 3
+#define FLIR_CAPTURE_SYNC_IDLE              4
+
+#define FLIR_RESYNC_HUNT_US                 40000   // Restarts at packet 0 for a few segment periods before idling
+#define FLIR_RESYNC_IDLE_MS                 200     // CS high for over 185 ms times out the VoSPI stream
+#define FLIR_RESYNC_IDLE_MAX_MS             1600
+#define FLIR_RESYNC_STABLE_SEGMENTS         100     // Segments in sequence that halve the idle period again
+
+#define FLIR_AGC_BINS                       1024
+#define FLIR_AGC_PLATEAU_DEFAULT            300
+#define FLIR_AGC_CLIP_LOW_DEFAULT           10
+#define FLIR_AGC_CLIP_HIGH_DEFAULT          990
+
+#define FLIR_TLINEAR_COUNTS_PER_KELVIN      100     // Radiometric TLinear output at its default 0.01 K resolution
+
+/******************************************************
+ * Palettes
+ * 
+ * 256-entry RGB565 tables, already in ST7789 wire order:
+ * the colorize step is a single indexed load and the AGC
+ * index never exceeds FLIR_PALETTE_SIZE - 1.
+ ******************************************************/
+static const uint16_t palette_ironblack[FLIR_PALETTE_SIZE] =
+{
+    TFT_RGB565_WIRE(255, 255, 255), TFT_RGB565_WIRE(253, 253, 253), TFT_RGB565_WIRE(251, 251, 251), TFT_RGB565_WIRE(249, 249, 249),
+    TFT_RGB565_WIRE(247, 247, 247), TFT_RGB565_WIRE(245, 245, 245), TFT_RGB565_WIRE(243, 243, 243), TFT_RGB565_WIRE(241, 241, 241),
+    TFT_RGB565_WIRE(239, 239, 239), TFT_RGB565_WIRE(237, 237, 237), TFT_RGB565_WIRE(235, 235, 235), TFT_RGB565_WIRE(233, 233, 233),
+    TFT_RGB565_WIRE(231, 231, 231), TFT_RGB565_WIRE(229, 229, 229), TFT_RGB565_WIRE(227, 227, 227), TFT_RGB565_WIRE(225, 225, 225),
+    TFT_RGB565_WIRE(223, 223, 223), TFT_RGB565_WIRE(221, 221, 221), TFT_RGB565_WIRE(219, 219, 219), TFT_RGB565_WIRE(217, 217, 217),
+    TFT_RGB565_WIRE(215, 215, 215), TFT_RGB565_WIRE(213, 213, 213), TFT_RGB565_WIRE(211, 211, 211), TFT_RGB565_WIRE(209, 209, 209),
+    TFT_RGB565_WIRE(207, 207, 207), TFT_RGB565_WIRE(205, 205, 205), TFT_RGB565_WIRE(203, 203, 203), TFT_RGB565_WIRE(201, 201, 201),
+    TFT_RGB565_WIRE(199, 199, 199), TFT_RGB565_WIRE(197, 197, 197), TFT_RGB565_WIRE(195, 195, 195), TFT_RGB565_WIRE(193, 193, 193),
+    TFT_RGB565_WIRE(191, 191, 191), TFT_RGB565_WIRE(189, 189, 189), TFT_RGB565_WIRE(187, 187, 187), TFT_RGB565_WIRE(185, 185, 185),
+    TFT_RGB565_WIRE(183, 183, 183), TFT_RGB565_WIRE(181, 181, 181), TFT_RGB565_WIRE(179, 179, 179), TFT_RGB565_WIRE(177, 177, 177),
+    TFT_RGB565_WIRE(175, 175, 175), TFT_RGB565_WIRE(173, 173, 173), TFT_RGB565_WIRE(171, 171, 171), TFT_RGB565_WIRE(169, 169, 169),
+    TFT_RGB565_WIRE(167, 167, 167), TFT_RGB565_WIRE(165, 165, 165), TFT_RGB565_WIRE(163, 163, 163), TFT_RGB565_WIRE(161, 161, 161),
+    TFT_RGB565_WIRE(159, 159, 159), TFT_RGB565_WIRE(157, 157, 157), TFT_RGB565_WIRE(155, 155, 155), TFT_RGB565_WIRE(153, 153, 153),
+    TFT_RGB565_WIRE(151, 151, 151), TFT_RGB565_WIRE(149, 149, 149), TFT_RGB565_WIRE(147, 147, 147), TFT_RGB565_WIRE(145, 145, 145),
+    TFT_RGB565_WIRE(143, 143, 143), TFT_RGB565_WIRE(141, 141, 141), TFT_RGB565_WIRE(139, 139, 139), TFT_RGB565_WIRE(137, 137, 137),
+    TFT_RGB565_WIRE(135, 135, 135), TFT_RGB565_WIRE(133, 133, 133), TFT_RGB565_WIRE(131, 131, 131), TFT_RGB565_WIRE(129, 129, 129),
+    TFT_RGB565_WIRE(126, 126, 126), TFT_RGB565_WIRE(124, 124, 124), TFT_RGB565_WIRE(122, 122, 122), TFT_RGB565_WIRE(120, 120, 120),
+    TFT_RGB565_WIRE(118, 118, 118), TFT_RGB565_WIRE(116, 116, 116), TFT_RGB565_WIRE(114, 114, 114), TFT_RGB565_WIRE(112, 112, 112),
+    TFT_RGB565_WIRE(110, 110, 110), TFT_RGB565_WIRE(108, 108, 108), TFT_RGB565_WIRE(106, 106, 106), TFT_RGB565_WIRE(104, 104, 104),
+    TFT_RGB565_WIRE(102, 102, 102), TFT_RGB565_WIRE(100, 100, 100), TFT_RGB565_WIRE(98, 98, 98), TFT_RGB565_WIRE(96, 96, 96),
+    TFT_RGB565_WIRE(94, 94, 94), TFT_RGB565_WIRE(92, 92, 92), TFT_RGB565_WIRE(90, 90, 90), TFT_RGB565_WIRE(88, 88, 88),
+    TFT_RGB565_WIRE(86, 86, 86), TFT_RGB565_WIRE(84, 84, 84), TFT_RGB565_WIRE(82, 82, 82), TFT_RGB565_WIRE(80, 80, 80),
+    TFT_RGB565_WIRE(78, 78, 78), TFT_RGB565_WIRE(76, 76, 76), TFT_RGB565_WIRE(74, 74, 74), TFT_RGB565_WIRE(72, 72, 72),
+    TFT_RGB565_WIRE(70, 70, 70), TFT_RGB565_WIRE(68, 68, 68), TFT_RGB565_WIRE(66, 66, 66), TFT_RGB565_WIRE(64, 64, 64),
+    TFT_RGB565_WIRE(62, 62, 62), TFT_RGB565_WIRE(60, 60, 60), TFT_RGB565_WIRE(58, 58, 58), TFT_RGB565_WIRE(56, 56, 56),
+    TFT_RGB565_WIRE(54, 54, 54), TFT_RGB565_WIRE(52, 52, 52), TFT_RGB565_WIRE(50, 50, 50), TFT_RGB565_WIRE(48, 48, 48),
+    TFT_RGB565_WIRE(46, 46, 46), TFT_RGB565_WIRE(44, 44, 44), TFT_RGB565_WIRE(42, 42, 42), TFT_RGB565_WIRE(40, 40, 40),
+    TFT_RGB565_WIRE(38, 38, 38), TFT_RGB565_WIRE(36, 36, 36), TFT_RGB565_WIRE(34, 34, 34), TFT_RGB565_WIRE(32, 32, 32),
+    TFT_RGB565_WIRE(30, 30, 30), TFT_RGB565_WIRE(28, 28, 28), TFT_RGB565_WIRE(26, 26, 26), TFT_RGB565_WIRE(24, 24, 24),
+    TFT_RGB565_WIRE(22, 22, 22), TFT_RGB565_WIRE(20, 20, 20), TFT_RGB565_WIRE(18, 18, 18), TFT_RGB565_WIRE(16, 16, 16),
+    TFT_RGB565_WIRE(14, 14, 14), TFT_RGB565_WIRE(12, 12, 12), TFT_RGB565_WIRE(10, 10, 10), TFT_RGB565_WIRE(8, 8, 8),
+    TFT_RGB565_WIRE(6, 6, 6), TFT_RGB565_WIRE(4, 4, 4), TFT_RGB565_WIRE(2, 2, 2), TFT_RGB565_WIRE(0, 0, 0),
+    TFT_RGB565_WIRE(0, 0, 9), TFT_RGB565_WIRE(2, 0, 16), TFT_RGB565_WIRE(4, 0, 24), TFT_RGB565_WIRE(6, 0, 31),
+    TFT_RGB565_WIRE(8, 0, 38), TFT_RGB565_WIRE(10, 0, 45), TFT_RGB565_WIRE(12, 0, 53), TFT_RGB565_WIRE(14, 0, 60),
+    TFT_RGB565_WIRE(17, 0, 67), TFT_RGB565_WIRE(19, 0, 74), TFT_RGB565_WIRE(21, 0, 82), TFT_RGB565_WIRE(23, 0, 89),
+    TFT_RGB565_WIRE(25, 0, 96), TFT_RGB565_WIRE(27, 0, 103), TFT_RGB565_WIRE(29, 0, 111), TFT_RGB565_WIRE(31, 0, 118),
+    TFT_RGB565_WIRE(36, 0, 120), TFT_RGB565_WIRE(41, 0, 121), TFT_RGB565_WIRE(46, 0, 122), TFT_RGB565_WIRE(51, 0, 123),
+    TFT_RGB565_WIRE(56, 0, 124), TFT_RGB565_WIRE(61, 0, 125), TFT_RGB565_WIRE(66, 0, 126), TFT_RGB565_WIRE(71, 0, 127),
+    TFT_RGB565_WIRE(76, 1, 128), TFT_RGB565_WIRE(81, 1, 129), TFT_RGB565_WIRE(86, 1, 130), TFT_RGB565_WIRE(91, 1, 131),
+    TFT_RGB565_WIRE(96, 1, 132), TFT_RGB565_WIRE(101, 1, 133), TFT_RGB565_WIRE(106, 1, 134), TFT_RGB565_WIRE(111, 1, 135),
+    TFT_RGB565_WIRE(116, 1, 136), TFT_RGB565_WIRE(121, 1, 136), TFT_RGB565_WIRE(125, 2, 137), TFT_RGB565_WIRE(130, 2, 137),
+    TFT_RGB565_WIRE(135, 3, 137), TFT_RGB565_WIRE(139, 3, 138), TFT_RGB565_WIRE(144, 3, 138), TFT_RGB565_WIRE(149, 4, 138),
+    TFT_RGB565_WIRE(153, 4, 139), TFT_RGB565_WIRE(158, 5, 139), TFT_RGB565_WIRE(163, 5, 139), TFT_RGB565_WIRE(167, 5, 140),
+    TFT_RGB565_WIRE(172, 6, 140), TFT_RGB565_WIRE(177, 6, 140), TFT_RGB565_WIRE(181, 7, 141), TFT_RGB565_WIRE(186, 7, 141),
+    TFT_RGB565_WIRE(189, 10, 137), TFT_RGB565_WIRE(191, 13, 132), TFT_RGB565_WIRE(194, 16, 127), TFT_RGB565_WIRE(196, 19, 121),
+    TFT_RGB565_WIRE(198, 22, 116), TFT_RGB565_WIRE(200, 25, 111), TFT_RGB565_WIRE(203, 28, 106), TFT_RGB565_WIRE(205, 31, 101),
+    TFT_RGB565_WIRE(207, 34, 95), TFT_RGB565_WIRE(209, 37, 90), TFT_RGB565_WIRE(212, 40, 85), TFT_RGB565_WIRE(214, 43, 80),
+    TFT_RGB565_WIRE(216, 46, 75), TFT_RGB565_WIRE(218, 49, 69), TFT_RGB565_WIRE(221, 52, 64), TFT_RGB565_WIRE(223, 55, 59),
+    TFT_RGB565_WIRE(224, 57, 49), TFT_RGB565_WIRE(225, 60, 47), TFT_RGB565_WIRE(226, 64, 44), TFT_RGB565_WIRE(227, 67, 42),
+    TFT_RGB565_WIRE(228, 71, 39), TFT_RGB565_WIRE(229, 74, 37), TFT_RGB565_WIRE(230, 78, 34), TFT_RGB565_WIRE(231, 81, 32),
+    TFT_RGB565_WIRE(231, 85, 29), TFT_RGB565_WIRE(232, 88, 27), TFT_RGB565_WIRE(233, 92, 24), TFT_RGB565_WIRE(234, 95, 22),
+    TFT_RGB565_WIRE(235, 99, 19), TFT_RGB565_WIRE(236, 102, 17), TFT_RGB565_WIRE(237, 106, 14), TFT_RGB565_WIRE(238, 109, 12),
+    TFT_RGB565_WIRE(239, 112, 12), TFT_RGB565_WIRE(240, 116, 12), TFT_RGB565_WIRE(240, 119, 12), TFT_RGB565_WIRE(241, 123, 12),
+    TFT_RGB565_WIRE(241, 127, 12), TFT_RGB565_WIRE(242, 130, 12), TFT_RGB565_WIRE(242, 134, 12), TFT_RGB565_WIRE(243, 138, 12),
+    TFT_RGB565_WIRE(243, 141, 13), TFT_RGB565_WIRE(244, 145, 13), TFT_RGB565_WIRE(244, 149, 13), TFT_RGB565_WIRE(245, 152, 13),
+    TFT_RGB565_WIRE(245, 156, 13), TFT_RGB565_WIRE(246, 160, 13), TFT_RGB565_WIRE(246, 163, 13), TFT_RGB565_WIRE(247, 167, 13),
+    TFT_RGB565_WIRE(247, 171, 13), TFT_RGB565_WIRE(248, 175, 14), TFT_RGB565_WIRE(248, 178, 15), TFT_RGB565_WIRE(249, 182, 16),
+    TFT_RGB565_WIRE(249, 185, 18), TFT_RGB565_WIRE(250, 189, 19), TFT_RGB565_WIRE(250, 192, 20), TFT_RGB565_WIRE(251, 196, 21),
+    TFT_RGB565_WIRE(251, 199, 22), TFT_RGB565_WIRE(252, 203, 23), TFT_RGB565_WIRE(252, 206, 24), TFT_RGB565_WIRE(253, 210, 25),
+    TFT_RGB565_WIRE(253, 213, 27), TFT_RGB565_WIRE(254, 217, 28), TFT_RGB565_WIRE(254, 220, 29), TFT_RGB565_WIRE(255, 224, 30),
+    TFT_RGB565_WIRE(255, 227, 39), TFT_RGB565_WIRE(255, 229, 53), TFT_RGB565_WIRE(255, 231, 67), TFT_RGB565_WIRE(255, 233, 81),
+    TFT_RGB565_WIRE(255, 234, 95), TFT_RGB565_WIRE(255, 236, 109), TFT_RGB565_WIRE(255, 238, 123), TFT_RGB565_WIRE(255, 240, 137),
+    TFT_RGB565_WIRE(255, 242, 151), TFT_RGB565_WIRE(255, 244, 165), TFT_RGB565_WIRE(255, 246, 179), TFT_RGB565_WIRE(255, 248, 193),
+    TFT_RGB565_WIRE(255, 249, 207), TFT_RGB565_WIRE(255, 251, 221), TFT_RGB565_WIRE(255, 253, 235), TFT_RGB565_WIRE(255, 255, 249)
+};
+
+static const uint16_t palette_grayscale[FLIR_PALETTE_SIZE] =
+{
+    TFT_RGB565_WIRE(0, 0, 0), TFT_RGB565_WIRE(1, 1, 1), TFT_RGB565_WIRE(2, 2, 2), TFT_RGB565_WIRE(3, 3, 3),
+    TFT_RGB565_WIRE(4, 4, 4), TFT_RGB565_WIRE(5, 5, 5), TFT_RGB565_WIRE(6, 6, 6), TFT_RGB565_WIRE(7, 7, 7),
+    TFT_RGB565_WIRE(8, 8, 8), TFT_RGB565_WIRE(9, 9, 9), TFT_RGB565_WIRE(10, 10, 10), TFT_RGB565_WIRE(11, 11, 11),
+    TFT_RGB565_WIRE(12, 12, 12), TFT_RGB565_WIRE(13, 13, 13), TFT_RGB565_WIRE(14, 14, 14), TFT_RGB565_WIRE(15, 15, 15),
+    TFT_RGB565_WIRE(16, 16, 16), TFT_RGB565_WIRE(17, 17, 17), TFT_RGB565_WIRE(18, 18, 18), TFT_RGB565_WIRE(19, 19, 19),
+    TFT_RGB565_WIRE(20, 20, 20), TFT_RGB565_WIRE(21, 21, 21), TFT_RGB565_WIRE(22, 22, 22), TFT_RGB565_WIRE(23, 23, 23),
+    TFT_RGB565_WIRE(24, 24, 24), TFT_RGB565_WIRE(25, 25, 25), TFT_RGB565_WIRE(26, 26, 26), TFT_RGB565_WIRE(27, 27, 27),
+    TFT_RGB565_WIRE(28, 28, 28), TFT_RGB565_WIRE(29, 29, 29), TFT_RGB565_WIRE(30, 30, 30), TFT_RGB565_WIRE(31, 31, 31),
+    TFT_RGB565_WIRE(32, 32, 32), TFT_RGB565_WIRE(33, 33, 33), TFT_RGB565_WIRE(34, 34, 34), TFT_RGB565_WIRE(35, 35, 35),
+    TFT_RGB565_WIRE(36, 36, 36), TFT_RGB565_WIRE(37, 37, 37), TFT_RGB565_WIRE(38, 38, 38), TFT_RGB565_WIRE(39, 39, 39),
+    TFT_RGB565_WIRE(40, 40, 40), TFT_RGB565_WIRE(41, 41, 41), TFT_RGB565_WIRE(42, 42, 42), TFT_RGB565_WIRE(43, 43, 43),
+    TFT_RGB565_WIRE(44, 44, 44), TFT_RGB565_WIRE(45, 45, 45), TFT_RGB565_WIRE(46, 46, 46), TFT_RGB565_WIRE(47, 47, 47),
+    TFT_RGB565_WIRE(48, 48, 48), TFT_RGB565_WIRE(49, 49, 49), TFT_RGB565_WIRE(50, 50, 50), TFT_RGB565_WIRE(51, 51, 51),
+    TFT_RGB565_WIRE(52, 52, 52), TFT_RGB565_WIRE(53, 53, 53), TFT_RGB565_WIRE(54, 54, 54), TFT_RGB565_WIRE(55, 55, 55),
+    TFT_RGB565_WIRE(56, 56, 56), TFT_RGB565_WIRE(57, 57, 57), TFT_RGB565_WIRE(58, 58, 58), TFT_RGB565_WIRE(59, 59, 59),
+    TFT_RGB565_WIRE(60, 60, 60), TFT_RGB565_WIRE(61, 61, 61), TFT_RGB565_WIRE(62, 62, 62), TFT_RGB565_WIRE(63, 63, 63),
+    TFT_RGB565_WIRE(64, 64, 64), TFT_RGB565_WIRE(65, 65, 65), TFT_RGB565_WIRE(66, 66, 66), TFT_RGB565_WIRE(67, 67, 67),
+    TFT_RGB565_WIRE(68, 68, 68), TFT_RGB565_WIRE(69, 69, 69), TFT_RGB565_WIRE(70, 70, 70), TFT_RGB565_WIRE(71, 71, 71),
+    TFT_RGB565_WIRE(72, 72, 72), TFT_RGB565_WIRE(73, 73, 73), TFT_RGB565_WIRE(74, 74, 74), TFT_RGB565_WIRE(75, 75, 75),
+    TFT_RGB565_WIRE(76, 76, 76), TFT_RGB565_WIRE(77, 77, 77), TFT_RGB565_WIRE(78, 78, 78), TFT_RGB565_WIRE(79, 79, 79),
+    TFT_RGB565_WIRE(80, 80, 80), TFT_RGB565_WIRE(81, 81, 81), TFT_RGB565_WIRE(82, 82, 82), TFT_RGB565_WIRE(83, 83, 83),
+    TFT_RGB565_WIRE(84, 84, 84), TFT_RGB565_WIRE(85, 85, 85), TFT_RGB565_WIRE(86, 86, 86), TFT_RGB565_WIRE(87, 87, 87),
+    TFT_RGB565_WIRE(88, 88, 88), TFT_RGB565_WIRE(89, 89, 89), TFT_RGB565_WIRE(90, 90, 90), TFT_RGB565_WIRE(91, 91, 91),
+    TFT_RGB565_WIRE(92, 92, 92), TFT_RGB565_WIRE(93, 93, 93), TFT_RGB565_WIRE(94, 94, 94), TFT_RGB565_WIRE(95, 95, 95),
+    TFT_RGB565_WIRE(96, 96, 96), TFT_RGB565_WIRE(97, 97, 97), TFT_RGB565_WIRE(98, 98, 98), TFT_RGB565_WIRE(99, 99, 99),
+    TFT_RGB565_WIRE(100, 100, 100), TFT_RGB565_WIRE(101, 101, 101), TFT_RGB565_WIRE(102, 102, 102), TFT_RGB565_WIRE(103, 103, 103),
+    TFT_RGB565_WIRE(104, 104, 104), TFT_RGB565_WIRE(105, 105, 105), TFT_RGB565_WIRE(106, 106, 106), TFT_RGB565_WIRE(107, 107, 107),
+    TFT_RGB565_WIRE(108, 108, 108), TFT_RGB565_WIRE(109, 109, 109), TFT_RGB565_WIRE(110, 110, 110), TFT_RGB565_WIRE(111, 111, 111),
+    TFT_RGB565_WIRE(112, 112, 112), TFT_RGB565_WIRE(113, 113, 113), TFT_RGB565_WIRE(114, 114, 114), TFT_RGB565_WIRE(115, 115, 115),
+    TFT_RGB565_WIRE(116, 116, 116), TFT_RGB565_WIRE(117, 117, 117), TFT_RGB565_WIRE(118, 118, 118), TFT_RGB565_WIRE(119, 119, 119),
+    TFT_RGB565_WIRE(120, 120, 120), TFT_RGB565_WIRE(121, 121, 121), TFT_RGB565_WIRE(122, 122, 122), TFT_RGB565_WIRE(123, 123, 123),
+    TFT_RGB565_WIRE(124, 124, 124), TFT_RGB565_WIRE(125, 125, 125), TFT_RGB565_WIRE(126, 126, 126), TFT_RGB565_WIRE(127, 127, 127),
+    TFT_RGB565_WIRE(128, 128, 128), TFT_RGB565_WIRE(129, 129, 129), TFT_RGB565_WIRE(130, 130, 130), TFT_RGB565_WIRE(131, 131, 131),
+    TFT_RGB565_WIRE(132, 132, 132), TFT_RGB565_WIRE(133, 133, 133), TFT_RGB565_WIRE(134, 134, 134), TFT_RGB565_WIRE(135, 135, 135),
+    TFT_RGB565_WIRE(136, 136, 136), TFT_RGB565_WIRE(137, 137, 137), TFT_RGB565_WIRE(138, 138, 138), TFT_RGB565_WIRE(139, 139, 139),
+    TFT_RGB565_WIRE(140, 140, 140), TFT_RGB565_WIRE(141, 141, 141), TFT_RGB565_WIRE(142, 142, 142), TFT_RGB565_WIRE(143, 143, 143),
+    TFT_RGB565_WIRE(144, 144, 144), TFT_RGB565_WIRE(145, 145, 145), TFT_RGB565_WIRE(146, 146, 146), TFT_RGB565_WIRE(147, 147, 147),
+    TFT_RGB565_WIRE(148, 148, 148), TFT_RGB565_WIRE(149, 149, 149), TFT_RGB565_WIRE(150, 150, 150), TFT_RGB565_WIRE(151, 151, 151),
+    TFT_RGB565_WIRE(152, 152, 152), TFT_RGB565_WIRE(153, 153, 153), TFT_RGB565_WIRE(154, 154, 154), TFT_RGB565_WIRE(155, 155, 155),
+    TFT_RGB565_WIRE(156, 156, 156), TFT_RGB565_WIRE(157, 157, 157), TFT_RGB565_WIRE(158, 158, 158), TFT_RGB565_WIRE(159, 159, 159),
+    TFT_RGB565_WIRE(160, 160, 160), TFT_RGB565_WIRE(161, 161, 161), TFT_RGB565_WIRE(162, 162, 162), TFT_RGB565_WIRE(163, 163, 163),
+    TFT_RGB565_WIRE(164, 164, 164), TFT_RGB565_WIRE(165, 165, 165), TFT_RGB565_WIRE(166, 166, 166), TFT_RGB565_WIRE(167, 167, 167),
+    TFT_RGB565_WIRE(168, 168, 168), TFT_RGB565_WIRE(169, 169, 169), TFT_RGB565_WIRE(170, 170, 170), TFT_RGB565_WIRE(171, 171, 171),
+    TFT_RGB565_WIRE(172, 172, 172), TFT_RGB565_WIRE(173, 173, 173), TFT_RGB565_WIRE(174, 174, 174), TFT_RGB565_WIRE(175, 175, 175),
+    TFT_RGB565_WIRE(176, 176, 176), TFT_RGB565_WIRE(177, 177, 177), TFT_RGB565_WIRE(178, 178, 178), TFT_RGB565_WIRE(179, 179, 179),
+    TFT_RGB565_WIRE(180, 180, 180), TFT_RGB565_WIRE(181, 181, 181), TFT_RGB565_WIRE(182, 182, 182), TFT_RGB565_WIRE(183, 183, 183),
+    TFT_RGB565_WIRE(184, 184, 184), TFT_RGB565_WIRE(185, 185, 185), TFT_RGB565_WIRE(186, 186, 186), TFT_RGB565_WIRE(187, 187, 187),
+    TFT_RGB565_WIRE(188, 188, 188), TFT_RGB565_WIRE(189, 189, 189), TFT_RGB565_WIRE(190, 190, 190), TFT_RGB565_WIRE(191, 191, 191),
+    TFT_RGB565_WIRE(192, 192, 192), TFT_RGB565_WIRE(193, 193, 193), TFT_RGB565_WIRE(194, 194, 194), TFT_RGB565_WIRE(195, 195, 195),
+    TFT_RGB565_WIRE(196, 196, 196), TFT_RGB565_WIRE(197, 197, 197), TFT_RGB565_WIRE(198, 198, 198), TFT_RGB565_WIRE(199, 199, 199),
+    TFT_RGB565_WIRE(200, 200, 200), TFT_RGB565_WIRE(201, 201, 201), TFT_RGB565_WIRE(202, 202, 202), TFT_RGB565_WIRE(203, 203, 203),
+    TFT_RGB565_WIRE(204, 204, 204), TFT_RGB565_WIRE(205, 205, 205), TFT_RGB565_WIRE(206, 206, 206), TFT_RGB565_WIRE(207, 207, 207),
+    TFT_RGB565_WIRE(208, 208, 208), TFT_RGB565_WIRE(209, 209, 209), TFT_RGB565_WIRE(210, 210, 210), TFT_RGB565_WIRE(211, 211, 211),
+    TFT_RGB565_WIRE(212, 212, 212), TFT_RGB565_WIRE(213, 213, 213), TFT_RGB565_WIRE(214, 214, 214), TFT_RGB565_WIRE(215, 215, 215),
+    TFT_RGB565_WIRE(216, 216, 216), TFT_RGB565_WIRE(217, 217, 217), TFT_RGB565_WIRE(218, 218, 218), TFT_RGB565_WIRE(219, 219, 219),
+    TFT_RGB565_WIRE(220, 220, 220), TFT_RGB565_WIRE(221, 221, 221), TFT_RGB565_WIRE(222, 222, 222), TFT_RGB565_WIRE(223, 223, 223),
+    TFT_RGB565_WIRE(224, 224, 224), TFT_RGB565_WIRE(225, 225, 225), TFT_RGB565_WIRE(226, 226, 226), TFT_RGB565_WIRE(227, 227, 227),
+    TFT_RGB565_WIRE(228, 228, 228), TFT_RGB565_WIRE(229, 229, 229), TFT_RGB565_WIRE(230, 230, 230), TFT_RGB565_WIRE(231, 231, 231),
+    TFT_RGB565_WIRE(232, 232, 232), TFT_RGB565_WIRE(233, 233, 233), TFT_RGB565_WIRE(234, 234, 234), TFT_RGB565_WIRE(235, 235, 235),
+    TFT_RGB565_WIRE(236, 236, 236), TFT_RGB565_WIRE(237, 237, 237), TFT_RGB565_WIRE(238, 238, 238), TFT_RGB565_WIRE(239, 239, 239),
+    TFT_RGB565_WIRE(240, 240, 240), TFT_RGB565_WIRE(241, 241, 241), TFT_RGB565_WIRE(242, 242, 242), TFT_RGB565_WIRE(243, 243, 243),
+    TFT_RGB565_WIRE(244, 244, 244), TFT_RGB565_WIRE(245, 245, 245), TFT_RGB565_WIRE(246, 246, 246), TFT_RGB565_WIRE(247, 247, 247),
+    TFT_RGB565_WIRE(248, 248, 248), TFT_RGB565_WIRE(249, 249, 249), TFT_RGB565_WIRE(250, 250, 250), TFT_RGB565_WIRE(251, 251, 251),
+    TFT_RGB565_WIRE(252, 252, 252), TFT_RGB565_WIRE(253, 253, 253), TFT_RGB565_WIRE(254, 254, 254), TFT_RGB565_WIRE(255, 255, 255)
 };
 
+static const uint16_t *palettes[] = { palette_ironblack, palette_grayscale };
+static const uint16_t *palette = palette_ironblack;
+static volatile uint8_t palette_request = FLIR_PALETTE_IRONBLACK;
+
+/******************************************************
+ * Pixel Format
+ *
+ * With FLIR_CONFIG_INDEXED the colorize step stores the
+ * palette index and the display driver looks the colour
+ * up as it sends the frame: a frame takes 19.2 KB instead
+ * of 38.4 KB, and a palette switch needs no new colorize
+ * pass. Without it the pixels are finished RGB565.
+ ******************************************************/
+#ifdef FLIR_CONFIG_INDEXED
+typedef uint8_t FLIR_Pixel;
+typedef FLIR_Indexed_Image FLIR_Frame;
+#define FLIR_PIXEL(index)                   (index)
+#define FLIR_TFT_IMAGE(pixels, width, height, stride) TFT_IMAGE_INDEXED(pixels, palette, width, height, stride)
+#else
+typedef uint16_t FLIR_Pixel;
+typedef FLIR_Image FLIR_Frame;
+#define FLIR_PIXEL(index)                   (palette[index])
+#define FLIR_TFT_IMAGE(pixels, width, height, stride) TFT_IMAGE(pixels, width, height, stride)
+#endif
+
+// The scanline mode keeps no frames to look back at
+#if defined(FLIR_CONFIG_INDEXED) && !defined(FLIR_CONFIG_SCANLINE)
+#define FLIR_HISTORY                        FLIR_CONFIG_INDEXED
+#endif
+
+/******************************************************
+ * Macros
+ ******************************************************/
+#define convert_flir_tft(f)          FLIR_TFT_IMAGE(&(f.Data[0][0]), f.Width, f.Height, sizeof(f.Data[0]) / sizeof(f.Data[0][0]))
+#define convert_flir_tft_rows(f, row, rows) FLIR_TFT_IMAGE(&(f.Data[row][0]), f.Width, (rows), sizeof(f.Data[0]) / sizeof(f.Data[0][0]))
+
+/******************************************************
+ * Global Variables
+ ******************************************************/
+#if defined(FLIR_HISTORY)
+static FLIR_Frame thermal_frames[FLIR_HISTORY] BSP_DMA_BUFFER;     // The last frames, sent to the display by DMA
+static int thermal_live = 0;                    // Slot of the frame being colorized
+static int thermal_held = -1;                   // Slot of the frozen or compared frame, out of the ring
+static int thermal_count = 0;                   // Frames completed, up to FLIR_HISTORY
+#define thermal_frame                       (thermal_frames[thermal_live])
+#elif !defined(FLIR_CONFIG_SCANLINE)
+FLIR_Frame thermal_frame BSP_DMA_BUFFER;      // Sent to the display by DMA
+#endif
+
+static uint8_t auto_range_min = 1;
+static uint8_t auto_range_max = 1;
+static uint16_t range_min = 30000;
+static uint16_t range_max = 32000;
+static int frame_width;
+static int frame_height;
+#ifndef FLIR_CONFIG_SCANLINE
+static uint8_t segment_buffers[5][PACKET_SIZE * PACKETS_PER_FRAME] BSP_DMA_BUFFER;
+static uint8_t *storage[4] = { segment_buffers[0], segment_buffers[1], segment_buffers[2], segment_buffers[3] };
+static uint8_t *capture_buffer = segment_buffers[4];
+#endif
+static uint16_t *frame_buffer;
+static uint16_t n_wrong_segment = 0;
+static uint16_t n_zero_value_drop_frame = 0;
+
+static volatile uint8_t capture_state = FLIR_CAPTURE_IDLE;
+static volatile int capture_packet;
+static volatile int capture_segment;
+static volatile int capture_corrupt_at;         // First packet failing its CRC, PACKETS_PER_FRAME for none
+#ifdef FLIR_CONFIG_SCANLINE
+static volatile int capture_dropped_at;         // First packet past a full ring, PACKETS_PER_FRAME for none
+#endif
+
+static FLIR_Sync_Stats sync_stats;
+static uint8_t sync_lost;
+static uint8_t resync_skipping;                 // Restarting past an invalid segment
+static uint32_t sync_lost_at;                   // BSP_Time_us() when the stream was lost
+static uint32_t resync_since;                   // Start of the current hunt or idle period
+static uint16_t resync_idle_ms = FLIR_RESYNC_IDLE_MS;
+static uint16_t resync_good = FLIR_RESYNC_STABLE_SEGMENTS;  // Segments since the last idle period, saturating
+
+#ifdef FLIR_CONFIG_SCANLINE
+/******************************************************
+ * Scanline Pipeline
+ *
+ * Packets land in a ring instead of whole segments, and
+ * each row is colorized into a small line ring and sent
+ * as soon as its two packets are in; only the range and
+ * histogram survive for the next frame's AGC. The first
+ * 20 packets wait in the ring until packet 20 tells which
+ * segment they belong to, hence its size. Rows are sent
+ * FLIR_SCAN_GROUP at a time, whole display tiles for
+ * delta rendering; the upscaler holds back the last line
+ * of each group until the next one, as it does per
+ * segment in streaming mode.
+ * When the display falls so far behind that the ring is
+ * full, the rest of the segment is read into a scratch
+ * slot: the stream stays in sync and only that segment
+ * is dropped.
+ ******************************************************/
+#define FLIR_SCAN_PACKETS                   40      // Packet ring, even so the two packets of a row are adjacent
+
+#if defined(FLIR_CONFIG_UPSCALE) || defined(FLIR_CONFIG_DELTA_RENDER)
+#define FLIR_SCAN_GROUP                     10      // One row of display tiles, or fewer edges for the bilinear upscaler
+#else
+#define FLIR_SCAN_GROUP                     2
+#endif
+
+#define FLIR_SCAN_LINES                     (2 * FLIR_SCAN_GROUP)   // One group colorized while the other is sent
+
+static uint8_t scan_packets[FLIR_SCAN_PACKETS * PACKET_SIZE] BSP_DMA_BUFFER;
+static uint8_t scan_scratch[PACKET_SIZE] BSP_DMA_BUFFER;
+static FLIR_Pixel scan_lines[FLIR_SCAN_LINES][160] BSP_DMA_BUFFER;
+static volatile int scan_freed;     // Packets of the segment colorized, their ring slots can be refilled
+static int scan_row;                // Rows of the segment colorized
+static int scan_row_sent;           // Rows of the segment handed to the display
+static int scan_head = 0;           // Line ring slot of the next row colorized
+static int scan_tail = 0;           // Line ring slot of the next row sent
+static int scan_pending = 0;        // Rows colorized and not sent yet
+static int scan_taken;              // Whether reassembly takes the segment, -1 until asked
+static FLIR_Kernel_Params scan_params;
+#endif
+
+/******************************************************
+ * DMA Packet Capture
+ * 
+ * Each VoSPI packet is received by DMA into the spare
+ * capture_buffer. The completion interrupt validates the
+ * packet number and chains the next packet, so a whole
+ * segment is captured without the CPU touching SPI1.
+ * 
+ * Once the segment number read at packet 20 proves valid,
+ * the spare is committed by swapping it with the storage
+ * slot of that segment: the previous slot becomes the
+ * new spare and no segment data is ever copied.
+ * 
+ * With FLIR_CONFIG_CRC the handler also checks the CRC of
+ * each packet in sequence, four table loads per payload
+ * word with the sliced kernel. A packet failing it keeps
+ * the capture going, the stream is still in sync, but the
+ * segment is never committed: the poll reports it as
+ * FLIR_CAPTURE_CORRUPT and the scanline pipeline stops
+ * colorizing at the first bad packet. A segment cut
+ * short by a full scanline ring is FLIR_CAPTURE_DROPPED.
+ ******************************************************/
+#ifdef FLIR_CONFIG_SCANLINE
+#define FLIR_CAPTURE_SLOT(packet)           (((packet) < capture_dropped_at) ? &scan_packets[((packet) % FLIR_SCAN_PACKETS) * PACKET_SIZE] : scan_scratch)
+#else
+#define FLIR_CAPTURE_SLOT(packet)           (&capture_buffer[(packet) * PACKET_SIZE])
+#endif
+
+static void FLIR_Capture_Packet(void)
+{
+    BSP_SPI1_CS_Low();
+    BSP_SPI1_DMA_Start(FLIR_CAPTURE_SLOT(capture_packet), PACKET_SIZE);
+}
+
+// Runs in interrupt context on DMA completion
+static void FLIR_Capture_OnPacket(void)
+{
+    uint8_t *packet = FLIR_CAPTURE_SLOT(capture_packet);
+    int packet_number = ((packet[0] & 0x0f) << 8) | packet[1];
+    
+    BSP_SPI1_CS_High();
+    
+    // Discard packets (ID xFxx) hold no data, read the same one again
+    if ((packet_number & 0x0f00) == 0x0f00) {
+        sync_stats.Discards++;
+        FLIR_Capture_Packet();
+        return;
+    }
+    
+    if (packet_number != capture_packet) {
+        capture_state = FLIR_CAPTURE_RESYNC;
+        return;
+    }
+    
+#ifdef FLIR_CONFIG_CRC
+    if ((capture_corrupt_at == PACKETS_PER_FRAME) && !FLIR_Kernel_Packet_CRC_OK(packet)) {
+        capture_corrupt_at = capture_packet;
+    }
+#endif
+    
+    if (packet_number == 20) {
+        capture_segment = (packet[0] >> 4) & 0x0f;
+        if ((capture_segment < 1) || (4 < capture_segment)) {
+            // Wrong segment number
+            capture_state = FLIR_CAPTURE_DONE;
+            return;
+        }
+    }
+    
+    if (++capture_packet == PACKETS_PER_FRAME) {
+        capture_state = FLIR_CAPTURE_DONE;
+        return;
+    }
+    
+#ifdef FLIR_CONFIG_SCANLINE
+    // The ring is full of rows not colorized yet, the rest of the segment is only read
+    if ((capture_dropped_at == PACKETS_PER_FRAME) && (capture_packet - scan_freed >= FLIR_SCAN_PACKETS)) {
+        capture_dropped_at = capture_packet;
+    }
+#endif
+    
+    FLIR_Capture_Packet();
+}
+
+void FLIR_Capture_Initialize(void)
+{
+    capture_state = FLIR_CAPTURE_IDLE;
+    
+    // Not in sync until the first segment is in
+    sync_lost = true;
+    resync_skipping = false;
+    sync_lost_at = BSP_Time_us();
+    resync_since = sync_lost_at;
+    
+#ifdef FLIR_CONFIG_CRC
+    FLIR_Kernel_CRC_Initialize();
+#endif
+    
+    BSP_Initialize_SPI1_DMA(FLIR_Capture_OnPacket);
+}
+
+void FLIR_Capture_Start(void)
+{
+    capture_packet = 0;
+    capture_segment = -1;
+    capture_corrupt_at = PACKETS_PER_FRAME;
+    capture_state = FLIR_CAPTURE_BUSY;
+    
+#ifdef FLIR_CONFIG_SCANLINE
+    // Rows of an abandoned segment not sent yet are dropped
+    capture_dropped_at = PACKETS_PER_FRAME;
+    scan_freed = 0;
+    scan_row = 0;
+    scan_row_sent = 0;
+    scan_head = scan_tail;
+    scan_pending = 0;
+    scan_taken = -1;
+#endif
+    
+    FLIR_Capture_Packet();
+}
+
+/******************************************************
+ * VoSPI Resynchronization
+ * 
+ * A packet out of sequence loses the segment. Capture
+ * restarts at packet 0 at once, which finds the next
+ * segment if only packets went missing; it also skips
+ * the rest of a segment found invalid at packet 20,
+ * which is no loss unless it takes as long. When that has
+ * not worked for FLIR_RESYNC_HUNT_US, CS is held high
+ * for the idle period, over the 185 ms after which the
+ * Lepton restarts its VoSPI stream; the poll only
+ * compares times, nothing waits. An idle period needed
+ * again within FLIR_RESYNC_STABLE_SEGMENTS segments was
+ * too short and doubles the next one, each such run of
+ * segments in sequence halves it again.
+ ******************************************************/
+
+// Counts the loss and restarts capture, or starts idling once restarts take too long
+static void FLIR_Resync_Lost(void)
+{
+    uint32_t now = BSP_Time_us();
+    
+    if (!sync_lost && (!resync_skipping || (now - resync_since >= FLIR_RESYNC_HUNT_US))) {
+        sync_lost = true;
+        sync_lost_at = resync_skipping ? resync_since : now;
+        resync_since = sync_lost_at;
+        sync_stats.Losses++;
+    }
+    
+    if (now - resync_since < FLIR_RESYNC_HUNT_US) {
+        sync_stats.Restarts++;
+        FLIR_Capture_Start();
+        return;
+    }
+    
+    if (resync_good < FLIR_RESYNC_STABLE_SEGMENTS) {
+        resync_idle_ms = (2 * resync_idle_ms < FLIR_RESYNC_IDLE_MAX_MS) ? 2 * resync_idle_ms : FLIR_RESYNC_IDLE_MAX_MS;
+    }
+    resync_good = 0;
+    sync_stats.Idles++;
+    
+    n_wrong_segment = 0;
+    n_zero_value_drop_frame = 0;
+    
+    // CS is already high, the packet handler releases it after each packet
+    resync_since = now;
+    capture_state = FLIR_CAPTURE_SYNC_IDLE;
+}
+
+// A segment came in sequence, the rest of an invalid one is to be skipped
+static void FLIR_Resync_Good(uint8_t skipping)
+{
+    resync_skipping = skipping;
+    resync_since = BSP_Time_us();
+    
+    if (sync_lost) {
+        uint32_t lost_us = BSP_Time_us() - sync_lost_at;
+        
+        sync_lost = false;
+        sync_stats.Out_Of_Sync_us += lost_us;
+        if (lost_us > sync_stats.Longest_us) {
+            sync_stats.Longest_us = lost_us;
+        }
+    }
+    
+    if (resync_good < 0xFFFF) {
+        resync_good++;
+        
+        if (!(resync_good % FLIR_RESYNC_STABLE_SEGMENTS) && (resync_idle_ms > FLIR_RESYNC_IDLE_MS)) {
+            resync_idle_ms /= 2;
+        }
+    }
+}
+
+FLIR_Sync_Stats FLIR_Get_Sync_Stats(void)
+{
+    FLIR_Sync_Stats stats = sync_stats;
+    
+    // The stretch still going on counts too
+    if (sync_lost) {
+        uint32_t lost_us = BSP_Time_us() - sync_lost_at;
+        
+        stats.Out_Of_Sync_us += lost_us;
+        if (lost_us > stats.Longest_us) {
+            stats.Longest_us = lost_us;
+        }
+    }
+    stats.Idle_ms = resync_idle_ms;
+    stats.Lost = sync_lost;
+    
+    return stats;
+}
+
+int FLIR_Capture_Poll(void)
+{
+#ifdef BSP_CONFIG_HOST
+    BSP_Host_Poll(); // No DMA interrupts on the host, the pending transfers complete here
+#endif
+    
+    switch (capture_state) {
+        case FLIR_CAPTURE_DONE:
+            capture_state = FLIR_CAPTURE_IDLE;
+            FLIR_Resync_Good((capture_segment < 1) || (4 < capture_segment));
+            
+            if ((1 <= capture_segment) && (capture_segment <= 4) && (capture_corrupt_at < PACKETS_PER_FRAME)) {
+                return FLIR_CAPTURE_CORRUPT;
+            }
+            
+#ifdef FLIR_CONFIG_SCANLINE
+            if ((1 <= capture_segment) && (capture_segment <= 4) && (capture_dropped_at < PACKETS_PER_FRAME)) {
+                return FLIR_CAPTURE_DROPPED;
+            }
+#endif
+            
+#ifndef FLIR_CONFIG_SCANLINE
+            if ((1 <= capture_segment) && (capture_segment <= 4)) {
+                uint8_t *committed = capture_buffer;
+                
+                capture_buffer = storage[capture_segment - 1];
+                storage[capture_segment - 1] = committed;
+            }
+#endif
+            
+            return capture_segment;
+            
+        case FLIR_CAPTURE_RESYNC:
+            FLIR_Resync_Lost();
+            return FLIR_CAPTURE_PENDING;
+            
+        case FLIR_CAPTURE_SYNC_IDLE:
+            if (BSP_Time_us() - resync_since >= resync_idle_ms * 1000u) {
+                // Hunt again
+                resync_since = BSP_Time_us();
+                FLIR_Capture_Start();
+            }
+            return FLIR_CAPTURE_PENDING;
+            
+        default:
+            return FLIR_CAPTURE_PENDING;
+    }
+}
+
+/******************************************************
+ * Automatic Gain Control
+ * 
+ * Linear mapping of [min, max] onto the palette, without
+ * floating point (the PIC32MZ EC has no FPU). The index
+ * is floor((value - min) * 255 / (max - min)), computed
+ * by the packet kernel as ((value - min) * agc_mul) >>
+ * agc_shift with a reciprocal rounded up once per frame.
+ * The shift keeps the reciprocal error below
+ * 1 / (max - min), so the result is exact for every
+ * 16-bit input.
+ ******************************************************/
+static uint16_t agc_min = 0;
+static uint16_t agc_max = 0;
+static uint32_t agc_mul = 0;
+static uint8_t agc_shift = 24;
+
+static void FLIR_AGC_Set_Range(uint16_t min_value, uint16_t max_value)
+{
+    uint32_t diff = max_value - min_value;
+    
+    agc_min = min_value;
+    agc_max = max_value;
+    
+    if (max_value <= min_value) {
+        // Flat scene: everything maps to the first palette entry
+        agc_max = min_value;
+        agc_mul = 0;
+        agc_shift = 24;
+        return;
+    }
+    
+    // 2^(agc_shift - 24) <= diff < 2^(agc_shift - 23), so agc_mul < 2^32
+    agc_shift = 24;
+    while ((2u << (agc_shift - 24)) <= diff) {
+        agc_shift++;
+    }
+    
+    agc_mul = (uint32_t)((((uint64_t)(FLIR_PALETTE_SIZE - 1) << agc_shift) + diff - 1) / diff);
+}
+
+/******************************************************
+ * Histogram AGC
+ * 
+ * In FLIR_AGC_PLATEAU and FLIR_AGC_LINEAR_CLIP modes the
+ * pixels are binned into FLIR_AGC_BINS bins spanning the
+ * previous frame's range, and the histogram is filled
+ * segment by segment during the colorize pass. At the end
+ * of the frame it becomes a per-bin colour table for the
+ * next frame, resampled onto the new bins, so the pixel
+ * cost stays a single lookup. It holds palette indices
+ * with FLIR_CONFIG_INDEXED.
+ * 
+ * Plateau equalization clips every bin at agc_plateau
+ * before accumulating, as the Lepton's on-chip HEQ does,
+ * so that large uniform areas cannot take over the
+ * palette. Linear clip stretches the range between the
+ * agc_clip_low and agc_clip_high permille points.
+ ******************************************************/
+static uint8_t agc_mode = FLIR_AGC_LINEAR;
+static uint16_t agc_plateau = FLIR_AGC_PLATEAU_DEFAULT;
+static uint16_t agc_clip_low = FLIR_AGC_CLIP_LOW_DEFAULT;
+static uint16_t agc_clip_high = FLIR_AGC_CLIP_HIGH_DEFAULT;
+
+static uint16_t histogram[FLIR_AGC_BINS];
+static uint8_t histogram_map[FLIR_AGC_BINS];
+static FLIR_Pixel histogram_colors[FLIR_AGC_BINS];
+static uint16_t histogram_base = 0;
+static uint8_t histogram_shift = 0;
+
+// Spread [min_value, max_value] over the bins and resample histogram_map onto them
+static void FLIR_AGC_Set_Bins(uint16_t min_value, uint16_t max_value)
+{
+    uint16_t old_base = histogram_base;
+    uint8_t old_shift = histogram_shift;
+    uint8_t shift = 0;
+    
+    while (((uint32_t)(max_value - min_value) >> shift) >= FLIR_AGC_BINS) {
+        shift++;
+    }
+    
+    for (int bin = 0; bin < FLIR_AGC_BINS; bin++) {
+        uint32_t value = min_value + ((uint32_t)bin << shift) + ((1u << shift) >> 1);
+        uint32_t old_bin = 0;
+        
+        if (value > old_base) {
+            old_bin = (value - old_base) >> old_shift;
+            if (old_bin >= FLIR_AGC_BINS) {
+                old_bin = FLIR_AGC_BINS - 1;
+            }
+        }
+        
+        histogram_colors[bin] = FLIR_PIXEL(histogram_map[old_bin]);
+    }
+    
+    histogram_base = min_value;
+    histogram_shift = shift;
+}
+
+static void FLIR_AGC_Map_Plateau(void)
+{
+    uint32_t total = 0;
+    uint32_t cumulative = 0;
+    
+    for (int bin = 0; bin < FLIR_AGC_BINS; bin++) {
+        total += (histogram[bin] < agc_plateau) ? histogram[bin] : agc_plateau;
+    }
+    
+    if (total == 0) {
+        return;
+    }
+    
+    // Map each bin to the middle of its share of the clipped distribution
+    for (int bin = 0; bin < FLIR_AGC_BINS; bin++) {
+        uint32_t count = (histogram[bin] < agc_plateau) ? histogram[bin] : agc_plateau;
+        
+        histogram_map[bin] = (uint8_t)(((2 * cumulative + count) * (FLIR_PALETTE_SIZE - 1)) / (2 * total));
+        cumulative += count;
+    }
+}
+
+static void FLIR_AGC_Map_Linear_Clip(void)
+{
+    uint32_t total = 0;
+    uint32_t cumulative = 0;
+    int low_bin = -1;
+    int high_bin = FLIR_AGC_BINS - 1;
+    
+    for (int bin = 0; bin < FLIR_AGC_BINS; bin++) {
+        total += histogram[bin];
+    }
+    
+    if (total == 0) {
+        return;
+    }
+    
+    for (int bin = 0; bin < FLIR_AGC_BINS; bin++) {
+        cumulative += histogram[bin];
+        
+        if ((low_bin < 0) && (cumulative * 1000 > total * agc_clip_low)) {
+            low_bin = bin;
+        }
+        
+        // A high limit at or under the low one is reached first, the low bin with it
+        if (cumulative * 1000 >= total * agc_clip_high) {
+            high_bin = bin;
+            if (low_bin < 0) {
+                low_bin = bin;
+            }
+            break;
+        }
+    }
+    
+    if (high_bin <= low_bin) {
+        high_bin = low_bin + 1;
+    }
+    
+    for (int bin = 0; bin < FLIR_AGC_BINS; bin++) {
+        if (bin <= low_bin) {
+            histogram_map[bin] = 0;
+        } else if (bin >= high_bin) {
+            histogram_map[bin] = FLIR_PALETTE_SIZE - 1;
+        } else {
+            histogram_map[bin] = (uint8_t)(((bin - low_bin) * (FLIR_PALETTE_SIZE - 1)) / (high_bin - low_bin));
+        }
+    }
+}
+
+static void FLIR_AGC_Histogram_Initialize(uint16_t min_value, uint16_t max_value)
+{
+    // Start from a plain linear ramp over the initial range
+    for (int bin = 0; bin < FLIR_AGC_BINS; bin++) {
+        histogram_map[bin] = (uint8_t)((bin * (FLIR_PALETTE_SIZE - 1)) / (FLIR_AGC_BINS - 1));
+        histogram[bin] = 0;
+    }
+    
+    histogram_base = min_value;
+    histogram_shift = 0;
+    FLIR_AGC_Set_Bins(min_value, max_value);
+}
+
+// Turn the histogram of the completed frame into the colour table of the next one
+static void FLIR_AGC_Histogram_Update(uint16_t min_value, uint16_t max_value)
+{
+    if (agc_mode == FLIR_AGC_PLATEAU) {
+        FLIR_AGC_Map_Plateau();
+    } else {
+        FLIR_AGC_Map_Linear_Clip();
+    }
+    
+    if (min_value < max_value) {
+        FLIR_AGC_Set_Bins(min_value, max_value);
+    } else {
+        FLIR_AGC_Set_Bins(histogram_base, histogram_base + (FLIR_AGC_BINS << histogram_shift) - 1);
+    }
+    
+    memset(histogram, 0, sizeof (histogram));
+}
+
+void FLIR_Set_AGC_Mode(uint8_t mode)
+{
+    agc_mode = mode;
+    
+    FLIR_AGC_Histogram_Initialize(range_min, range_max);
+}
+
+void FLIR_Set_AGC_Plateau(uint16_t plateau)
+{
+    agc_plateau = plateau;
+}
+
+void FLIR_Set_AGC_Clip(uint16_t low_permille, uint16_t high_permille)
+{
+    agc_clip_low = low_permille;
+    agc_clip_high = high_permille;
+}
+
+/******************************************************
+ * Auto-Range
+ * 
+ * Frame N is colorized with the range of frame N-1 while
+ * its own range is measured, so the pixels are read only
+ * once. With FLIR_CONFIG_AGC_SMOOTHING the applied range
+ * follows the measured one through an exponential moving
+ * average kept with 8 fractional bits.
+ ******************************************************/
+static uint16_t frame_min_value = 65535;
+static uint16_t frame_max_value = 0;
+
+#ifdef FLIR_CONFIG_HUD
+// Where the frame extremes were found, and the raw centre pixels, for the HUD
+static int16_t frame_min_x = -1;
+static int16_t frame_min_y = -1;
+static int16_t frame_max_x = -1;
+static int16_t frame_max_y = -1;
+static uint32_t frame_spot_sum = 0;
+static uint8_t frame_spot_count = 0;
+#endif
+
+#ifdef FLIR_CONFIG_AGC_SMOOTHING
+static int32_t smooth_min_q8;
+static int32_t smooth_max_q8;
+#endif
+
+static void FLIR_Auto_Range_Initialize(void)
+{
+    frame_min_value = 65535;
+    frame_max_value = 0;
+    
+#ifdef FLIR_CONFIG_AGC_SMOOTHING
+    smooth_min_q8 = (int32_t)range_min << 8;
+    smooth_max_q8 = (int32_t)range_max << 8;
+#endif
+    
+    FLIR_AGC_Set_Range(range_min, range_max);
+    FLIR_AGC_Histogram_Initialize(range_min, range_max);
+}
+
+// Apply the range measured on the completed frame to the next one
+static void FLIR_Auto_Range_Update(void)
+{
+    if (agc_mode != FLIR_AGC_LINEAR) {
+        FLIR_AGC_Histogram_Update(frame_min_value, frame_max_value);
+    }
+    
+    if (frame_min_value < frame_max_value) {
+        if (auto_range_min == true) {
+            range_min = frame_min_value;
+        }
+
+        if (auto_range_max == true) {
+            range_max = frame_max_value;
+        }
+    }
+    
+    frame_min_value = 65535;
+    frame_max_value = 0;
+    
+#ifdef FLIR_CONFIG_AGC_SMOOTHING
+    smooth_min_q8 += (((int32_t)range_min << 8) - smooth_min_q8) >> FLIR_CONFIG_AGC_SMOOTHING;
+    smooth_max_q8 += (((int32_t)range_max << 8) - smooth_max_q8) >> FLIR_CONFIG_AGC_SMOOTHING;
+    
+    FLIR_AGC_Set_Range((uint16_t)(smooth_min_q8 >> 8), (uint16_t)((smooth_max_q8 + 255) >> 8));
+#else
+    FLIR_AGC_Set_Range(range_min, range_max);
+#endif
+}
+
+// Forget what a dropped frame measured, the next one is colorized with the range in use
+static void FLIR_Auto_Range_Discard(void)
+{
+    frame_min_value = 65535;
+    frame_max_value = 0;
+    memset(histogram, 0, sizeof (histogram));
+    
+#ifdef FLIR_CONFIG_HUD
+    frame_spot_sum = 0;
+    frame_spot_count = 0;
+#endif
+}
+
+/******************************************************
+ * Frame Reassembly
+ * 
+ * The four segments of a frame come in order, segments
+ * numbered 0 (invalid) may come between frames. A frame
+ * is assembled in a bitmask, keyed on the sync losses
+ * counted when its segment 1 began: a segment is taken
+ * only if it is the next one, the one before it was
+ * complete and sync was not lost since. Any other segment
+ * tears the frame under assembly and is dropped at once,
+ * before it is colorized, along with what the frame had
+ * measured for the AGC and HUD. Only complete frames
+ * reach the per-frame updates.
+ ******************************************************/
+static uint8_t frame_segments = 0;      // Segments received, bit n - 1 for segment n
+static uint8_t frame_pending = 0;       // Segment begun and not received yet
+static uint32_t frame_epoch;            // sync_stats.Losses when the frame began
+static FLIR_Frame_Stats frame_stats;
+
+// Called once the segment number is known, before any of it is colorized; false when it is dropped
+static int FLIR_Frame_Begin_Segment(int segment_number)
+{
+    uint8_t continues = !frame_pending && (frame_epoch == sync_stats.Losses) && (frame_segments == (1 << (segment_number - 1)) - 1);
+    
+    if ((segment_number != 1) && continues) {
+        frame_pending = segment_number;
+        return true;
+    }
+    
+    if (frame_segments || frame_pending) {
+        frame_stats.Torn++;
+        FLIR_Auto_Range_Discard();
+    }
+    
+    frame_segments = 0;
+    frame_pending = 0;
+    frame_epoch = sync_stats.Losses;
+    
+    if (segment_number != 1) {
+        frame_stats.Dropped_Segments++;
+        return false;
+    }
+    
+    frame_pending = 1;
+    return true;
+}
+
+// Called once the begun segment is received; true when it completes the frame
+static int FLIR_Frame_End_Segment(void)
+{
+    if (!frame_pending) {
+        return false;
+    }
+    
+    frame_segments |= 1 << (frame_pending - 1);
+    frame_pending = 0;
+    
+    if (frame_segments != 0x0F) {
+        return false;
+    }
+    
+    frame_segments = 0;
+    frame_stats.Completed++;
+    
+    return true;
+}
+
+FLIR_Frame_Stats FLIR_Get_Frame_Stats(void)
+{
+    return frame_stats;
+}
+
+/******************************************************
+ * Repeated Frames
+ * 
+ * The Lepton 3.5 sends about 27 frames per second but
+ * only one in three is new, the others repeat it bit for
+ * bit. Telemetry, whose frame counter would tell, is not
+ * enabled, so repeats are found by the CRC fields of the
+ * packets: nothing is read beyond their headers. Packets
+ * whose CRCs all match those of the packets last shown in
+ * their place are neither colorized nor sent, whole
+ * segments at a time, or whole scanline groups. A frame
+ * repeated throughout skips the per-frame updates too,
+ * the AGC included: a new frame's range applies from the
+ * next new frame, as it would at 9 Hz. A frame mixing
+ * repeated and new parts, which takes a CRC collision,
+ * keeps its new rows but has its measurements dropped,
+ * and the next frame is drawn in full. A new palette or
+ * view draws it in full too.
+ ******************************************************/
+#ifdef FLIR_CONFIG_SKIP_REPEATS
+#ifdef FLIR_CONFIG_SCANLINE
+#define FLIR_SEGMENT_PACKET(segment, packet)    FLIR_CAPTURE_SLOT(packet)
+#else
+#define FLIR_SEGMENT_PACKET(segment, packet)    (&storage[(segment) - 1][(packet) * PACKET_SIZE])
+#endif
+
+#define FLIR_REPEAT_ROWS(first, count)      ((((1u << ((count) / 2)) - 1) << ((first) / 2)))
+
+static uint16_t repeat_crcs[4][PACKETS_PER_FRAME];
+static uint32_t repeat_shown[4];        // Rows whose CRCs are those of the rows on display, bit r for row r of the segment
+static uint8_t repeat_skipped = 0;      // Segments of the frame with packets skipped as repeats, bit n - 1 for segment n
+static uint8_t repeat_drawn = 0;        // Segments of the frame with packets colorized
+
+static void FLIR_Repeat_Forget(void)
+{
+    memset(repeat_shown, 0, sizeof (repeat_shown));
+}
+
+// True when packets first..first + count - 1 of the segment repeat those on display, and are skipped
+static int FLIR_Repeat_Check(int segment_number, int first, int count)
+{
+    uint8_t bit = 1 << (segment_number - 1);
+    
+    // A new frame
+    if ((segment_number == 1) && (first == 0)) {
+        repeat_skipped = 0;
+        repeat_drawn = 0;
+    }
+    
+    if ((repeat_shown[segment_number - 1] & FLIR_REPEAT_ROWS(first, count)) != FLIR_REPEAT_ROWS(first, count)) {
+        return false;
+    }
+    
+    for (int packet = first; packet < first + count; packet++) {
+        const uint8_t *header = FLIR_SEGMENT_PACKET(segment_number, packet);
+        
+        if (repeat_crcs[segment_number - 1][packet] != ((header[2] << 8) | header[3])) {
+            return false;
+        }
+    }
+    
+    repeat_skipped |= bit;
+    return true;
+}
+
+// Packets first..first + count - 1 of the segment were colorized, or stopped at a zero pixel
+static void FLIR_Repeat_Shown(int segment_number, int first, int count, int complete)
+{
+    uint8_t bit = 1 << (segment_number - 1);
+    
+    if (!complete) {
+        FLIR_Repeat_Forget();
+        return;
+    }
+    
+    for (int packet = first; packet < first + count; packet++) {
+        const uint8_t *header = FLIR_SEGMENT_PACKET(segment_number, packet);
+        
+        repeat_crcs[segment_number - 1][packet] = (header[2] << 8) | header[3];
+    }
+    
+    repeat_shown[segment_number - 1] |= FLIR_REPEAT_ROWS(first, count);
+    repeat_drawn |= bit;
+}
+
+#if !defined(FLIR_CONFIG_STREAMING) && !defined(FLIR_CONFIG_SCANLINE)
+// True when the whole frame in storage repeats the one on display
+static int FLIR_Repeat_Frame(void)
+{
+    for (int index = 1; index <= 4; index++) {
+        if (!FLIR_Repeat_Check(index, 0, PACKETS_PER_FRAME)) {
+            repeat_skipped = 0;
+            return false;
+        }
+    }
+    
+    return true;
+}
+#endif
+
+// The frame is complete; true when it needs no per-frame updates
+static int FLIR_Repeat_Frame_Done(void)
+{
+    uint8_t skipped = repeat_skipped;
+    uint8_t drawn = repeat_drawn;
+    
+    repeat_skipped = 0;
+    repeat_drawn = 0;
+    
+    if (!skipped) {
+        return false;
+    }
+    
+    if (drawn) {
+        FLIR_Auto_Range_Discard();
+        FLIR_Repeat_Forget();
+    } else {
+        frame_stats.Repeated++;
+    }
+    
+    return true;
+}
+#else
+#define FLIR_Repeat_Forget()
+#define FLIR_Repeat_Check(segment_number, first, count)             false
+#define FLIR_Repeat_Shown(segment_number, first, count, complete)   ((void)(complete))
+#define FLIR_Repeat_Frame()                 false
+#define FLIR_Repeat_Frame_Done()            false
+#endif
+
 /******************************************************
- * Macros
+ * Segment Processing
  ******************************************************/
-#define convert_flir_tft(f)          ((TFT_Image) { .Height = f.Height, .Width = f.Width, .Data = (uint16_t **)&(f.Data[0]) })
+// Kernel parameters of the current AGC mapping
+static void FLIR_Colorize_Params(FLIR_Kernel_Params *params)
+{
+    if (agc_mode == FLIR_AGC_LINEAR) {
+        params->Base = agc_min;
+        params->Limit = agc_max - agc_min;
+        params->Mul = agc_mul;
+        params->Shift = agc_shift;
+    } else {
+        params->Base = histogram_base;
+        params->Limit = ((FLIR_AGC_BINS << histogram_shift) - 1 < 65535) ? (FLIR_AGC_BINS << histogram_shift) - 1 : 65535;
+        params->Mul = 0;
+        params->Shift = histogram_shift;
+    }
+}
+
+#ifdef FLIR_CONFIG_HUD
+// Locates the extremes a packet has just moved, and picks up the pixels under the crosshair
+static void FLIR_Hud_Track(const uint8_t *packet, int count, int row, int column, const FLIR_Kernel_Range *before, const FLIR_Kernel_Range *after)
+{
+    const uint8_t *payload = packet + FLIR_KERNEL_HEADER_SIZE;
+
+    if ((after->Min < before->Min) || (after->Max > before->Max)) {
+        for (int i = 0; i < count; i++) {
+            uint16_t value = (payload[2 * i] << 8) | payload[2 * i + 1];
+
+            if (value == after->Min) {
+                frame_min_x = column + i;
+                frame_min_y = row;
+            }
+
+            if (value == after->Max) {
+                frame_max_x = column + i;
+                frame_max_y = row;
+            }
+        }
+    }
+
+    if ((row == frame_height / 2 - 1) || (row == frame_height / 2)) {
+        for (int i = frame_width / 2 - 1 - column; i <= frame_width / 2 - column; i++) {
+            if ((0 <= i) && (i < count)) {
+                frame_spot_sum += (payload[2 * i] << 8) | payload[2 * i + 1];
+                frame_spot_count++;
+            }
+        }
+    }
+}
+#endif
+
+// Colorize one row from its two packets, measuring the range in the same pass; false when it holds a zero pixel
+static int FLIR_Colorize_Row(const uint8_t *packets, int row, FLIR_Pixel *pixels, const FLIR_Kernel_Params *params, FLIR_Kernel_Range *range)
+{
+    uint16_t indices[FLIR_KERNEL_PIXELS];
+
+#ifndef FLIR_CONFIG_HUD
+    (void)row;                                  // Only the HUD tracks positions
+#endif
+
+    // Two packets per row: the first one holds the left half
+    for (int half = 0; half < 2; half++, packets += PACKET_SIZE, pixels += FLIR_KERNEL_PIXELS) {
+#ifdef FLIR_CONFIG_HUD
+        FLIR_Kernel_Range range_before = *range;
+#endif
+        int count = FLIR_Kernel_Packet(packets, indices, params, range);
+
+        if (agc_mode == FLIR_AGC_LINEAR) {
+            for (int i = 0; i < count; i++) {
+                pixels[i] = FLIR_PIXEL(indices[i]);
+            }
+        } else {
+            for (int i = 0; i < count; i++) {
+                histogram[indices[i]]++;
+                pixels[i] = histogram_colors[indices[i]];
+            }
+        }
+
+#ifdef FLIR_CONFIG_HUD
+        FLIR_Hud_Track(packets, count, row, half * FLIR_KERNEL_PIXELS, &range_before, range);
+#endif
+
+        if (count != FLIR_KERNEL_PIXELS) {
+            n_zero_value_drop_frame++;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#ifndef FLIR_CONFIG_SCANLINE
+// Colorize one segment into its 30 rows of thermal_frame; false when it stopped at a zero pixel
+static int FLIR_Colorize_Segment(int index)
+{
+    const uint8_t *segment = storage[index - 1];
+    int offset_row = 30 * (index - 1);
+    FLIR_Kernel_Params params;
+    FLIR_Kernel_Range range = { frame_min_value, frame_max_value };
+
+    int complete = true;
+
+    FLIR_Colorize_Params(&params);
+
+    for (int row = 0; (row < 30) && complete; row++) {
+        complete = FLIR_Colorize_Row(&segment[2 * row * PACKET_SIZE], offset_row + row, thermal_frame.Data[offset_row + row], &params, &range);
+    }
+
+    frame_min_value = range.Min;
+    frame_max_value = range.Max;
+
+    return complete;
+}
+#endif
 
 /******************************************************
- * Global Variables
+ * Display Output
  ******************************************************/
-FLIR_Image thermal_frame;
+#define FLIR_STATS_FRAMES                   16      // Frames between two statistics updates
 
-static int ofs_r;
-static int ofs_g;
-static int ofs_b;
-static uint8_t auto_range_min = 1;
-static uint8_t auto_range_max = 1;
-static uint16_t range_min = 30000;
-static uint16_t range_max = 32000;
-static int frame_width;
-static int frame_height;
-static uint8_t frame_data[PACKET_SIZE * PACKETS_PER_FRAME];
-static uint8_t storage[4][PACKET_SIZE * PACKETS_PER_FRAME];
-static uint16_t *frame_buffer;
+#ifdef FLIR_CONFIG_UPSCALE
+#define FLIR_DISPLAY(v)                     ((v) * 3 / 2)
+#else
+#define FLIR_DISPLAY(v)                     (v)
+#endif
 
-static void FLIR_ReadFramePacket(int j)
+#define FLIR_DISPLAY_WIDTH                  FLIR_DISPLAY(frame_width)
+#define FLIR_DISPLAY_HEIGHT                 FLIR_DISPLAY(frame_height)
+
+// Sends frame pixels placed at (x, y) of the frame, upscaling takes precedence over delta rendering
+static void FLIR_Render(TFT_Image image, int x, int y)
 {
-    BSP_SPI1_CS_Low();
+#if defined(FLIR_CONFIG_UPSCALE)
+    // Rows sent a segment or group at a time blend across into the next, the frame bottom repeats its last row
+    tft_render_image_scaled(image, x * 3 / 2, y * 3 / 2, FLIR_CONFIG_UPSCALE | ((y + image.Height < frame_height) ? TFT_SCALE_CONTINUED : 0));
+#elif defined(FLIR_CONFIG_DELTA_RENDER)
+    tft_render_image_delta(image, x, y);
+#else
+    tft_render_image_async(image, x, y, 0);
+#endif
+}
+
+#ifdef FLIR_CONFIG_HUD
+/******************************************************
+ * HUD Overlay
+ *
+ * Composited by the display driver into the frame as it
+ * is sent. The colour bar is drawn once at start; the
+ * texts and markers follow the frame just completed, so
+ * they are one frame behind the image, like the AGC.
+ * The colorize pass tracks what they need, nothing is
+ * read back from the segments.
+ ******************************************************/
+#define FLIR_HUD_BAR_WIDTH                  6
+#define FLIR_HUD_BAR_MARGIN                 12      // Above and below the colour bar, room for its labels
+#define FLIR_HUD_CROSSHAIR_ARM              8
+#define FLIR_HUD_MARKER_RADIUS              3
+
+static int hud_bar;
+static int hud_spot;
+static int hud_crosshair;
+static int hud_min_marker;
+static int hud_max_marker;
+static int hud_min_label;
+static int hud_max_label;
+
+// Moves a marker onto a frame pixel
+static void FLIR_Hud_Mark(int marker, int x, int y)
+{
+    if (x >= 0) {
+        tft_hud_move(marker, FLIR_DISPLAY(x), FLIR_DISPLAY(y));
+        tft_hud_show(marker, true);
+    }
+}
+
+// Tenths of a degree Celsius
+static void FLIR_Hud_Print_Temperature(int item, uint16_t raw)
+{
+    int decicelsius = ((int32_t)raw * 100 / FLIR_TLINEAR_COUNTS_PER_KELVIN - 27315) / 10;
+
+    if (decicelsius < 0) {
+        tft_hud_printf(item, "-%u.%uC", -decicelsius / 10, -decicelsius % 10);
+    } else {
+        tft_hud_printf(item, "%u.%uC", decicelsius / 10, decicelsius % 10);
+    }
+}
+
+// Hottest at the top, the palette is already in wire order
+static void FLIR_Hud_Draw_Bar(void)
+{
+    TFT_Image bar_image = tft_hud_bitmap(hud_bar);
+
+    for (int row = 0; row < bar_image.Height; row++) {
+        uint16_t color = palette[(FLIR_PALETTE_SIZE - 1) - row * (FLIR_PALETTE_SIZE - 1) / (bar_image.Height - 1)];
+
+        for (int i = 0; i < bar_image.Width; i++) {
+            bar_image.Data[row * bar_image.Stride + i] = color;
+        }
+    }
+}
+
+static void FLIR_Hud_Initialize(void)
+{
+    int bar_x = FLIR_DISPLAY_WIDTH - FLIR_HUD_BAR_WIDTH - 2;
+    int bar_height = FLIR_DISPLAY_HEIGHT - 2 * FLIR_HUD_BAR_MARGIN;
+
+    hud_bar = tft_hud_add_bitmap(bar_x, FLIR_HUD_BAR_MARGIN, FLIR_HUD_BAR_WIDTH, bar_height);
+    FLIR_Hud_Draw_Bar();
+
+    hud_max_label = tft_hud_add_text(FLIR_DISPLAY_WIDTH - 32, 2, 1, TFT_COLOR_WHITE, TFT_COLOR_BLACK);
+    hud_min_label = tft_hud_add_text(FLIR_DISPLAY_WIDTH - 32, FLIR_DISPLAY_HEIGHT - 10, 1, TFT_COLOR_WHITE, TFT_COLOR_BLACK);
+    hud_spot = tft_hud_add_text(2, 2, 1, TFT_COLOR_WHITE, TFT_COLOR_BLACK);
+    hud_crosshair = tft_hud_add_crosshair(FLIR_DISPLAY_WIDTH / 2, FLIR_DISPLAY_HEIGHT / 2, FLIR_HUD_CROSSHAIR_ARM, TFT_COLOR_WHITE);
+    hud_min_marker = tft_hud_add_marker(0, 0, FLIR_HUD_MARKER_RADIUS, TFT_COLOR_BLUE);
+    hud_max_marker = tft_hud_add_marker(0, 0, FLIR_HUD_MARKER_RADIUS, TFT_COLOR_RED);
+
+    tft_hud_show(hud_min_marker, false);
+    tft_hud_show(hud_max_marker, false);
+}
+
+// Spot temperature under the crosshair, averaged over the 4 centre pixels, and the frame extremes
+static void FLIR_Hud_Update(void)
+{
+    if (frame_spot_count) {
+        FLIR_Hud_Print_Temperature(hud_spot, (uint16_t)((frame_spot_sum + frame_spot_count / 2) / frame_spot_count));
+    }
+
+    frame_spot_sum = 0;
+    frame_spot_count = 0;
+
+    if (frame_min_value >= frame_max_value) {
+        return;
+    }
+
+    FLIR_Hud_Print_Temperature(hud_min_label, frame_min_value);
+    FLIR_Hud_Print_Temperature(hud_max_label, frame_max_value);
+    FLIR_Hud_Mark(hud_min_marker, frame_min_x, frame_min_y);
+    FLIR_Hud_Mark(hud_max_marker, frame_max_x, frame_max_y);
+}
+#endif
+
+/******************************************************
+ * Palettes and Views
+ *
+ * Both are requested at any time and applied between two
+ * frames. The frames of FLIR_CONFIG_INDEXED go through
+ * the palette as they are sent, so a new palette shows
+ * from the next render on; RGB565 frames take it at the
+ * next colorize pass. With FLIR_HISTORY frames kept, the
+ * freeze and compare views take one of them out of the
+ * ring until the live view is back, and the live frame
+ * goes round the other slots.
+ ******************************************************/
+static volatile uint8_t view_request = FLIR_VIEW_LIVE;
+static volatile uint8_t view_request_age = 0;
+
+void FLIR_Set_Palette(uint8_t palette_id)
+{
+    if (palette_id < sizeof (palettes) / sizeof (palettes[0])) {
+        palette_request = palette_id;
+    }
+}
+
+// Age 0 is the last frame completed; no effect without FLIR_CONFIG_INDEXED, or in scanline mode
+void FLIR_Set_View(uint8_t view, uint8_t age)
+{
+    view_request_age = age;
+    view_request = view;
+}
+
+#ifdef FLIR_HISTORY
+static uint8_t view = FLIR_VIEW_LIVE;
+static uint8_t view_age = 0;
+
+// Slot of the frame completed age frames before the live one, walking the ring past the held slot
+static int FLIR_History_Slot(int age)
+{
+    int slot = thermal_live;
+
+    while (age) {
+        slot = (slot + FLIR_HISTORY - 1) % FLIR_HISTORY;
+        if (slot != thermal_held) {
+            age--;
+        }
+    }
+
+    return slot;
+}
+
+// Sends rows of the live frame, the way the view shows them
+static void FLIR_Show_Rows(int row, int rows)
+{
+    int half = frame_width / 2;
+
+    switch (view) {
+        case FLIR_VIEW_FREEZE:
+            break;
+
+        case FLIR_VIEW_COMPARE:
+            FLIR_Render(tft_image_crop(convert_flir_tft_rows(thermal_frame, row, rows), 0, 0, half, rows), 0, row);
+            FLIR_Render(tft_image_crop(convert_flir_tft_rows(thermal_frames[thermal_held], row, rows), half, 0, frame_width - half, rows), half, row);
+            break;
+
+        default:
+            FLIR_Render(convert_flir_tft_rows(thermal_frame, row, rows), 0, row);
+            break;
+    }
+}
+#else
+#define FLIR_Show_Rows(row, rows)           FLIR_Render(convert_flir_tft_rows(thermal_frame, row, rows), 0, row)
+#endif
+
+// Runs once the frame is complete and sent, before the AGC takes the range of the next one
+static void FLIR_View_Update(void)
+{
+    uint8_t redraw = false;
+
+    if (palettes[palette_request] != palette) {
+        // Histogram colours are looked up again by the AGC update that follows
+        palette = palettes[palette_request];
+        redraw = true;
+
+#ifdef FLIR_CONFIG_HUD
+        FLIR_Hud_Draw_Bar();
+#endif
+    }
+
+#ifdef FLIR_HISTORY
+    if (thermal_count < FLIR_HISTORY) {
+        thermal_count++;
+    }
+
+    if ((view_request != view) || (view_request_age != view_age)) {
+        int age = view_request_age;
+
+        // The ring keeps a slot for the live frame
+        if (age > FLIR_HISTORY - ((thermal_held < 0) ? 1 : 2)) {
+            age = FLIR_HISTORY - ((thermal_held < 0) ? 1 : 2);
+        }
+
+        if (age > thermal_count - 1) {
+            age = thermal_count - 1;
+        }
+
+        view = view_request;
+        view_age = view_request_age;
+
+        if ((view == FLIR_VIEW_LIVE) || (age < 0)) {
+            view = FLIR_VIEW_LIVE;
+            thermal_held = -1;
+        } else {
+            thermal_held = FLIR_History_Slot(age);
+        }
+
+        redraw = true;
+    }
+
+    if (redraw) {
+        FLIR_Repeat_Forget();
+    }
+
+    if (redraw && (view == FLIR_VIEW_FREEZE)) {
+        FLIR_Render(convert_flir_tft(thermal_frames[thermal_held]), 0, 0);
+    }
+
+    // The next frame goes into the oldest slot; an asynchronous render of this one is not disturbed
+    do {
+        thermal_live = (thermal_live + 1) % FLIR_HISTORY;
+    } while (thermal_live == thermal_held);
+#else
+    if (redraw) {
+        FLIR_Repeat_Forget();
+    }
+#endif
+}
+
+#ifdef FLIR_CONFIG_SHOW_STATS
+// Frame rate and share of the SPI2 pixel bytes saved by delta rendering, over the last FLIR_STATS_FRAMES frames
+static void FLIR_Show_Stats(void)
+{
+    static uint32_t n_frames = 0;
+    static uint32_t last_cycles;
+    static TFT_Delta_Stats last_stats;
+    TFT_Delta_Stats stats;
+    uint32_t cycles, fps_x10, sent, saved;
+
+    if (n_frames++ % FLIR_STATS_FRAMES) {
+        return;
+    }
+
+    cycles = BSP_Cycle_Count();
+    stats = tft_delta_stats();
+
+    if (n_frames > 1) {
+        fps_x10 = (uint32_t)((uint64_t)FLIR_STATS_FRAMES * 10 * SYSCLK / (cycles - last_cycles));
+        sent = stats.Bytes_Sent - last_stats.Bytes_Sent;
+        saved = stats.Bytes_Saved - last_stats.Bytes_Saved;
+
+        tft_set_text_bg_color(TFT_COLOR_WHITE, TFT_COLOR_BLACK);
+        tft_set_cursor(0, FLIR_DISPLAY_HEIGHT + 4);
+        tft_printf("%u.%u fps  SPI2 saved %u%%  ", fps_x10 / 10, fps_x10 % 10, (sent + saved) ? (uint32_t)((uint64_t)saved * 100 / (sent + saved)) : 0);
+    }
+
+    last_cycles = cycles;
+    last_stats = stats;
+}
+#endif
+
+#ifdef FLIR_CONFIG_SCANLINE
+/******************************************************
+ * Scanline Processing
+ ******************************************************/
+// Nothing more of the segment is colorized or sent, its packets land in the ring unread
+static void FLIR_Scan_Skip(void)
+{
+    scan_row = 30;
+    scan_row_sent = 30;
+    scan_freed = PACKETS_PER_FRAME;
+    scan_head = scan_tail;
+    scan_pending = 0;
+}
+
+// Colorizes the rows whose packets are in and sends a complete group, without waiting on SPI2
+static void FLIR_Scan_Rows(void)
+{
+    int segment_number = capture_segment;
+    int offset_row = 30 * (segment_number - 1);
+    int in_flight = tft_render_busy() ? FLIR_SCAN_GROUP : 0;
+
+    // Unknown until packet 20
+    if ((segment_number < 1) || (4 < segment_number)) {
+        return;
+    }
     
-    for (int i = 0; i < PACKET_SIZE; i++) {
-        BSP_Register_FLIR_SPIBUF = 'A';
-        while (!BSP_Register_FLIR_SPISTAT.SPIRBF) ;
-        frame_data[j * PACKET_SIZE + i] = (uint8_t)BSP_Register_FLIR_SPIBUF;
+    if (scan_taken < 0) {
+        scan_taken = FLIR_Frame_Begin_Segment(segment_number);
     }
     
-    BSP_SPI1_CS_High();
+    if (!scan_taken) {
+        FLIR_Scan_Skip();
+        return;
+    }
+
+    while ((scan_row < 30) && (2 * scan_row + 2 <= capture_packet) && (scan_pending + in_flight < FLIR_SCAN_LINES)) {
+        FLIR_Kernel_Range range = { frame_min_value, frame_max_value };
+        int complete;
+
+        if ((2 * scan_row + 2 > capture_corrupt_at) || (2 * scan_row + 2 > capture_dropped_at)) {
+            // The segment will be dropped, and the frame with it
+            FLIR_Scan_Skip();
+            return;
+        }
+
+#ifdef FLIR_CONFIG_SKIP_REPEATS
+        // Repeats are told a whole group at a time, and skipped once the rows before them are out
+        if (!(scan_row % FLIR_SCAN_GROUP)) {
+            if (2 * (scan_row + FLIR_SCAN_GROUP) > capture_packet) {
+                break;
+            }
+
+            if (FLIR_Repeat_Check(segment_number, 2 * scan_row, 2 * FLIR_SCAN_GROUP)) {
+                if (scan_pending) {
+                    break;
+                }
+
+                scan_row += FLIR_SCAN_GROUP;
+                scan_row_sent += FLIR_SCAN_GROUP;
+                scan_freed = 2 * scan_row;
+                continue;
+            }
+        }
+#endif
+
+        if (scan_row == 0) {
+            FLIR_Colorize_Params(&scan_params);
+        }
+
+        complete = FLIR_Colorize_Row(FLIR_CAPTURE_SLOT(2 * scan_row), offset_row + scan_row, scan_lines[scan_head], &scan_params, &range);
+
+        frame_min_value = range.Min;
+        frame_max_value = range.Max;
+
+        FLIR_Repeat_Shown(segment_number, 2 * scan_row, 2, complete);
+
+        if (!complete) {
+            // The rest of the segment keeps the previous frame
+            FLIR_Scan_Skip();
+            return;
+        }
+
+        scan_row++;
+        scan_freed = 2 * scan_row;
+        scan_head = (scan_head + 1) % FLIR_SCAN_LINES;
+        scan_pending++;
+    }
+
+    // A group is contiguous in the line ring
+    if ((scan_pending >= FLIR_SCAN_GROUP) && !tft_render_busy()) {
+        FLIR_Render(FLIR_TFT_IMAGE(scan_lines[scan_tail], frame_width, FLIR_SCAN_GROUP, 160), 0, offset_row + scan_row_sent);
+
+        scan_row_sent += FLIR_SCAN_GROUP;
+        scan_tail = (scan_tail + FLIR_SCAN_GROUP) % FLIR_SCAN_LINES;
+        scan_pending -= FLIR_SCAN_GROUP;
+    }
+}
+#endif
+
+/******************************************************
+ * Camera Setup
+ * 
+ * Puts the camera in the state the capture relies on:
+ * RAW14 with no telemetry rows, which would shift the
+ * segment packets, and TLinear at 0.01 K for the spot
+ * temperature. The requests are only queued; they run
+ * through FLIR_CCI_Poll() while the first frames come
+ * in, as does anything queued later through flir_cci.h.
+ ******************************************************/
+#ifdef FLIR_CONFIG_CCI
+static void FLIR_Camera_Setup(void)
+{
+    FLIR_CCI_Initialize();
+    
+    FLIR_CCI_Set_Value(FLIR_CCI_OEM_VIDEO_OUTPUT_FORMAT, 7, 0);
+    FLIR_CCI_Set_Value(FLIR_CCI_SYS_TELEMETRY_ENABLE, 0, 0);
+    FLIR_CCI_Set_Value(FLIR_CCI_RAD_TLINEAR_ENABLE, 1, 0);
+    FLIR_CCI_Set_Value(FLIR_CCI_RAD_TLINEAR_RESOLUTION, 1, 0);
 }
 
+#define FLIR_Camera_Poll()                  FLIR_CCI_Poll()
+#else
+#define FLIR_Camera_Setup()
+#define FLIR_Camera_Poll()
+#endif
+
 /******************************************************
  * Frames Retrieval and Processing
  ******************************************************/
 void FLIR_Process(void)
 {    
-    const int *colormap = colormap_ironblack;//colormap_grayscale;
-    
-	uint16_t min_value = range_min;
-	uint16_t max_value = range_max;
-	float diff = max_value - min_value;
-	float scale = 255/diff;
-	uint16_t n_wrong_segment = 0;
-	uint16_t n_zero_value_drop_frame = 0;
-
     frame_width = 160;
     frame_height = 120;
     
+#if defined(FLIR_HISTORY)
+    for (int slot = 0; slot < FLIR_HISTORY; slot++) {
+        thermal_frames[slot].Height = frame_height;
+        thermal_frames[slot].Width = frame_width;
+    }
+#elif !defined(FLIR_CONFIG_SCANLINE)
     thermal_frame.Height = frame_height;
     thermal_frame.Width = frame_width;
+#endif
 
 	// Min-Max value for scaling
 	auto_range_min = 1;
 	auto_range_max = 1;
 
+    FLIR_Auto_Range_Initialize();
+#ifdef FLIR_CONFIG_HUD
+    FLIR_Hud_Initialize();
+#endif
+    FLIR_Camera_Setup();
+    FLIR_Capture_Initialize();
+    FLIR_Capture_Start();
+    
     while (true)
     {
-        // Read frame packets over SPI1
-        int resets = 0;
-        int segment_number = -1;
-
-        for (int j = 0; j < PACKETS_PER_FRAME; j++) {
-            //if it's a drop packet, reset j to 0, set to -1 so he'll be at 0 again loop
-            FLIR_ReadFramePacket(j);
-            int packet_number = frame_data[j * PACKET_SIZE + 1];
-            if (packet_number != j) {
-                j = -1;
-                resets += 1;
-                BSP_Delay_us(1000);
-                
-                if (resets == 750)
-                {
-                    BSP_SPI1_Off();
-                    
-                    n_wrong_segment = 0;
-                    n_zero_value_drop_frame = 0;
-                    BSP_Delay_us(750000);
-                    
-                    BSP_SPI1_On();
-                }
-                continue;
-            }
-            if (packet_number == 20) {
-                segment_number = (frame_data[j * PACKET_SIZE] >> 4) & 0x0f;
-                if ((segment_number < 1) || (4 < segment_number)) {
-                    // Wrong segment number
-                    break;
-                }
-            }
+        // Wait for the DMA capture of the next segment
+        int segment_number;
+        
+#ifdef FLIR_CONFIG_SCANLINE
+        // Rows are colorized and sent while the rest of their segment streams in
+        while ((segment_number = FLIR_Capture_Poll()) == FLIR_CAPTURE_PENDING) {
+            FLIR_Scan_Rows();
+            FLIR_Camera_Poll();
+        }
+#else
+        while ((segment_number = FLIR_Capture_Poll()) == FLIR_CAPTURE_PENDING) {
+            FLIR_Camera_Poll();
+        }
+#endif
+        
+        if (segment_number == FLIR_CAPTURE_CORRUPT) {
+            // Never committed, the reassembler tears the frame on its next segment
+            frame_stats.Corrupt_Segments++;
+            
+            FLIR_Capture_Start();
+            continue;
+        }
+        
+        if (segment_number == FLIR_CAPTURE_DROPPED) {
+            // As for a corrupt one, the stream is in sync all the same
+            frame_stats.Dropped_Segments++;
+            
+            FLIR_Capture_Start();
+            continue;
         }
         
-        int segment_start_index = 1;
-        int segment_stop_index;
-
         if ((segment_number < 1) || (4 < segment_number)) {
             n_wrong_segment++;
+            frame_stats.Invalid_Segments++;
 
+            FLIR_Capture_Start();
             continue;
         }
         
@@ -175,101 +1689,79 @@ void FLIR_Process(void)
             n_wrong_segment = 0;
         }
 
-        // Copy frame data to storage
-        memcpy(storage[segment_number - 1], frame_data, sizeof (uint8_t) * PACKET_SIZE * PACKETS_PER_FRAME);
+#ifdef FLIR_CONFIG_SCANLINE
+        // The last rows, the packet ring is refilled by the next segment
+        while (scan_row_sent < 30) {
+            tft_render_wait();
+            FLIR_Scan_Rows();
+        }
+
+        FLIR_Capture_Start();
+
+        if (!scan_taken || !FLIR_Frame_End_Segment() || FLIR_Repeat_Frame_Done()) {
+            continue;
+        }
+#else
+        // The segment is already committed to storage, the next one streams in while it is processed
+        FLIR_Capture_Start();
         
-        if (segment_number != 4) {
+        if (!FLIR_Frame_Begin_Segment(segment_number)) {
             continue;
         }
-        segment_stop_index = 4;
-
-        if ((auto_range_min == true) || (auto_range_max == true))
-        {
-            if (auto_range_min == true) {
-                max_value = 65535;
-            }
-            
-            if (auto_range_max == true) {
-                max_value = 0;
-            }
-            
-            for (int index = segment_start_index; index <= segment_stop_index; index++) {
-                for (int i = 0; i < FRAME_SIZE_UINT16; i++) {
-                    
-                    // Skip the first 2 UINT16 of every packet: they are header 4 header bytes
-                    if (i % PACKET_SIZE_UINT16 < 2) {
-                        continue;
-                    }
-
-                    // Flip the MSB and LSB
-                    uint16_t value = (storage[index - 1][i * 2] << 8) + storage[index - 1][i * 2 + 1];
-                    
-                    if (value == 0) {
-                        continue;
-                    }
-                    
-                    if ((auto_range_max == true) && (value > max_value)) {
-                        max_value = value;
-                    }
-                    
-                    if ((auto_range_min == true) && (value < min_value)) {
-                        min_value = value;
-                    }
-                }
-            }
+        
+#ifdef FLIR_CONFIG_STREAMING
+        // Show each segment as soon as it arrives
+        int offset_row = 30 * (segment_number - 1);
+        
+        if (!FLIR_Repeat_Check(segment_number, 0, PACKETS_PER_FRAME)) {
+            // An asynchronous render is still busy with the rows of the previous segment at most
+            int complete = FLIR_Colorize_Segment(segment_number);
             
-            diff = max_value - min_value;
-            scale = 255.0f / (float)diff;
+            FLIR_Repeat_Shown(segment_number, 0, PACKETS_PER_FRAME, complete);
+            FLIR_Show_Rows(offset_row, 30);
         }
-
-        int row, column;
-        uint16_t value;
-        uint16_t value_frame_buffer;
-        uint16_t color;
         
-        for (int index = segment_start_index; index <= segment_stop_index; index++)
-        {
-            int offset_row = 30 * (index - 1);
-            
-            for (int i = 0; i < FRAME_SIZE_UINT16; i++) {
-                
-                // Skip the first 2 UINT16 of every packet: they are header 4 header bytes
-                if (i % PACKET_SIZE_UINT16 < 2) {
-                    continue;
-                }
+        if (!FLIR_Frame_End_Segment() || FLIR_Repeat_Frame_Done()) {
+            continue;
+        }
+#else
+        // The four storage slots hold the segments of one frame only once it is complete
+        if (!FLIR_Frame_End_Segment()) {
+            continue;
+        }
 
-                // Flip the MSB and LSB
-                value_frame_buffer = (storage[index - 1][i * 2] << 8) + storage[index - 1][i * 2 + 1];
-                
-                if (value_frame_buffer == 0)
-                {
-                    n_zero_value_drop_frame++;
-                    break;
-                }
+        if (!FLIR_Repeat_Frame()) {
+            // The previous frame must be out before it is overwritten
+            tft_render_wait();
 
-                value = (uint16_t)(((float)value_frame_buffer - (float)min_value) * scale);
-                
-                ofs_r = 3 * value + 0;
-                if (FLIR_COLORMAP_SIZE <= ofs_r) ofs_r = FLIR_COLORMAP_SIZE - 1;
-                ofs_g = 3 * value + 1;
-                if (FLIR_COLORMAP_SIZE <= ofs_g) ofs_g = FLIR_COLORMAP_SIZE - 1;
-                ofs_b = 3 * value + 2;
-                if (FLIR_COLORMAP_SIZE <= ofs_b) ofs_b = FLIR_COLORMAP_SIZE - 1;
+            for (int index = 1; index <= 4; index++) {
+                int complete = FLIR_Colorize_Segment(index);
 
-                color = tft_color_u16((uint8_t)colormap[ofs_r], (uint8_t)colormap[ofs_g], (uint8_t)colormap[ofs_b]);
+                FLIR_Repeat_Shown(index, 0, PACKETS_PER_FRAME, complete);
+            }
 
-                column = (i % PACKET_SIZE_UINT16) - 2 + (frame_width / 2) * ((i % (PACKET_SIZE_UINT16 * 2)) / PACKET_SIZE_UINT16);
-                row = i / PACKET_SIZE_UINT16 / 2 + offset_row;
+            FLIR_Show_Rows(0, frame_height);
+        }
 
-                thermal_frame.Data[row][column] = color;
-            }
+        if (FLIR_Repeat_Frame_Done()) {
+            continue;
         }
+#endif
+#endif
+
+#ifdef FLIR_CONFIG_HUD
+        FLIR_Hud_Update();
+#endif
+        FLIR_View_Update();
+        FLIR_Auto_Range_Update();
+
+#ifdef FLIR_CONFIG_SHOW_STATS
+        FLIR_Show_Stats();
+#endif
 
         if (n_zero_value_drop_frame != 0) {
             // Found zero-value. Drop the frame continuously (n_zero_value_drop_frame) times - Recovered
             n_zero_value_drop_frame = 0;
         }
-
-        tft_render_image(convert_flir_tft(thermal_frame), 0, 0);
     }
-}
+}
\ No newline at end of file
@@ -10,6 +10,23 @@
 #ifndef FLIR_LEPTON35_H_
 #define FLIR_LEPTON35_H_
 
+/*******************************************************
+ * FLIR module configuration
+ *******************************************************/
+#define FLIR_CONFIG_STREAMING       // Colorize and render each segment as soon as it arrives
+#define FLIR_CONFIG_CRC             // Check the CRC of every VoSPI packet, segments failing it are dropped
+#define FLIR_CONFIG_SKIP_REPEATS    // Neither colorize nor send what repeats the last frame, two frames in three on a Lepton 3.5
+//#define FLIR_CONFIG_SCANLINE      // Colorize and render each row as its packets arrive, through small rings instead of frame buffers
+//#define FLIR_CONFIG_AGC_SMOOTHING 2 // Smooth the auto-range with an EMA of weight 1 / 2^n
+//#define FLIR_CONFIG_UPSCALE TFT_SCALE_BILINEAR // Fill the panel width with the frame scaled by 1.5, see tft_render_image_scaled()
+//#define FLIR_CONFIG_DELTA_RENDER    // Send only the display tiles that changed since the last frame
+//#define FLIR_CONFIG_SHOW_STATS      // Print the frame rate and the SPI2 bytes saved under the image
+//#define FLIR_CONFIG_HUD             // Overlay the spot temperature, crosshair, min/max markers and colour bar, see tft_hud_*()
+//#define FLIR_CONFIG_INDEXED 4       // Keep frames as 8-bit palette indices, the last n of them for the freeze and compare views
+//#define FLIR_CONFIG_CCI             // Set the camera up over I2C and serve flir_cci.h requests while frames are captured
+
+/* End FLIR module configuration */
+
 #include <stdint.h>
 
 /******************************************************
@@ -22,9 +39,84 @@ typedef struct
     uint16_t Data[120][160];
 } FLIR_Image;
 
+// Palette indices, looked up as the frame is sent
+typedef struct
+{
+    uint8_t Height;
+    uint8_t Width;
+    uint8_t Data[120][160];
+} FLIR_Indexed_Image;
+
 /******************************************************
  * Frames Retrieval and Processing
  ******************************************************/
 void FLIR_Process(void);
 
+/******************************************************
+ * Automatic Gain Control
+ ******************************************************/
+#define FLIR_AGC_LINEAR                     0   // Stretch the frame min/max over the palette
+#define FLIR_AGC_LINEAR_CLIP                1   // Stretch between two percentiles
+#define FLIR_AGC_PLATEAU                    2   // Plateau histogram equalization
+
+void FLIR_Set_AGC_Mode(uint8_t mode);
+void FLIR_Set_AGC_Plateau(uint16_t plateau);
+void FLIR_Set_AGC_Clip(uint16_t low_permille, uint16_t high_permille);
+
+/******************************************************
+ * Palettes and Views
+ ******************************************************/
+#define FLIR_PALETTE_IRONBLACK              0
+#define FLIR_PALETTE_GRAYSCALE              1
+
+#define FLIR_VIEW_LIVE                      0   // Frames as they arrive
+#define FLIR_VIEW_FREEZE                    1   // Hold a recent frame
+#define FLIR_VIEW_COMPARE                   2   // Live left half, right half of a held frame
+
+void FLIR_Set_Palette(uint8_t palette_id);
+void FLIR_Set_View(uint8_t view, uint8_t age);
+
+/******************************************************
+ * DMA Packet Capture
+ ******************************************************/
+#define FLIR_CAPTURE_PENDING                (-1)
+#define FLIR_CAPTURE_CORRUPT                (-2)    // A packet of the segment failed its CRC
+#define FLIR_CAPTURE_DROPPED                (-3)    // The scanline ring filled up, the rest of the segment was only read
+
+void FLIR_Capture_Initialize(void);
+void FLIR_Capture_Start(void);
+int FLIR_Capture_Poll(void);
+
+/******************************************************
+ * VoSPI Synchronization
+ ******************************************************/
+typedef struct
+{
+    uint32_t Losses;            // Packet sequence broken while in sync
+    uint32_t Restarts;          // Restarts at packet 0 while hunting for the next segment
+    uint32_t Idles;             // CS idle periods, making the Lepton restart its stream
+    uint32_t Discards;          // Discard packets skipped
+    uint32_t Out_Of_Sync_us;    // Time from a loss to the next segment in sequence, start-up included
+    uint32_t Longest_us;        // Longest such stretch
+    uint16_t Idle_ms;           // Next idle period, longer while losses keep coming
+    uint8_t Lost;               // Out of sync now
+} FLIR_Sync_Stats;
+
+FLIR_Sync_Stats FLIR_Get_Sync_Stats(void);
+
+/******************************************************
+ * Frame Reassembly
+ ******************************************************/
+typedef struct
+{
+    uint32_t Completed;         // Frames with all four segments, in order and in sync
+    uint32_t Torn;              // Frames dropped once a segment went missing
+    uint32_t Dropped_Segments;  // Segments continuing no frame, never colorized, or cut short by a full scanline ring
+    uint32_t Invalid_Segments;  // Numbered 0 or above 4 at packet 20
+    uint32_t Corrupt_Segments;  // Dropped for a packet failing its CRC
+    uint32_t Repeated;          // Complete frames repeating the last one, skipped
+} FLIR_Frame_Stats;
+
+FLIR_Frame_Stats FLIR_Get_Frame_Stats(void);
+
 #endif /* FLIR_LEPTON35_H_ */
\ No newline at end of file
@@ -57,17 +57,17 @@ OBJECTDIR=build/${CND_CONF}/${IMAGE_TYPE}
 DISTDIR=dist/${CND_CONF}/${IMAGE_TYPE}
 
 # Source Files Quoted if spaced
-SOURCEFILES_QUOTED_IF_SPACED=main.c tft_st7789.c BSP.c flir_lepton35.c
+SOURCEFILES_QUOTED_IF_SPACED=main.c tft_st7789.c BSP.c flir_lepton35.c flir_kernels.c flir_cci.c
 
 # Object Files Quoted if spaced
-OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/main.o ${OBJECTDIR}/tft_st7789.o ${OBJECTDIR}/BSP.o ${OBJECTDIR}/flir_lepton35.o
-POSSIBLE_DEPFILES=${OBJECTDIR}/main.o.d ${OBJECTDIR}/tft_st7789.o.d ${OBJECTDIR}/BSP.o.d ${OBJECTDIR}/flir_lepton35.o.d
+OBJECTFILES_QUOTED_IF_SPACED=${OBJECTDIR}/main.o ${OBJECTDIR}/tft_st7789.o ${OBJECTDIR}/BSP.o ${OBJECTDIR}/flir_lepton35.o ${OBJECTDIR}/flir_kernels.o ${OBJECTDIR}/flir_cci.o
+POSSIBLE_DEPFILES=${OBJECTDIR}/main.o.d ${OBJECTDIR}/tft_st7789.o.d ${OBJECTDIR}/BSP.o.d ${OBJECTDIR}/flir_lepton35.o.d ${OBJECTDIR}/flir_kernels.o.d ${OBJECTDIR}/flir_cci.o.d
 
 # Object Files
-OBJECTFILES=${OBJECTDIR}/main.o ${OBJECTDIR}/tft_st7789.o ${OBJECTDIR}/BSP.o ${OBJECTDIR}/flir_lepton35.o
+OBJECTFILES=${OBJECTDIR}/main.o ${OBJECTDIR}/tft_st7789.o ${OBJECTDIR}/BSP.o ${OBJECTDIR}/flir_lepton35.o ${OBJECTDIR}/flir_kernels.o ${OBJECTDIR}/flir_cci.o
 
 # Source Files
-SOURCEFILES=main.c tft_st7789.c BSP.c flir_lepton35.c
+SOURCEFILES=main.c tft_st7789.c BSP.c flir_lepton35.c flir_kernels.c flir_cci.c
 
 
 
@@ -131,6 +131,18 @@ ${OBJECTDIR}/flir_lepton35.o: flir_lepton35.c  .generated_files/flags/default/d8
 	@${RM} ${OBJECTDIR}/flir_lepton35.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flir_lepton35.o.d" -o ${OBJECTDIR}/flir_lepton35.o flir_lepton35.c    -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/flir_kernels.o: flir_kernels.c  .generated_files/flags/default/cdec5ccd40d30d98ba625eedeea01018d9188958 .generated_files/flags/default/d9d2ddc4e99a0dd90f8bbd92ce293767b3211522
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flir_kernels.o.d 
+	@${RM} ${OBJECTDIR}/flir_kernels.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flir_kernels.o.d" -o ${OBJECTDIR}/flir_kernels.o flir_kernels.c  -mdspr2  -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/flir_cci.o: flir_cci.c  .generated_files/flags/default/a831c1b4311c7dc82ccce3d62b569b766a7c4c02 .generated_files/flags/default/d9d2ddc4e99a0dd90f8bbd92ce293767b3211522
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flir_cci.o.d 
+	@${RM} ${OBJECTDIR}/flir_cci.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE) -g -D__DEBUG   -fframe-base-loclist  -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flir_cci.o.d" -o ${OBJECTDIR}/flir_cci.o flir_cci.c    -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 else
 ${OBJECTDIR}/main.o: main.c  .generated_files/flags/default/fb9302de75464248600047e6c8e9df8fc25776c7 .generated_files/flags/default/d9d2ddc4e99a0dd90f8bbd92ce293767b3211522
 	@${MKDIR} "${OBJECTDIR}" 
@@ -156,6 +168,18 @@ ${OBJECTDIR}/flir_lepton35.o: flir_lepton35.c  .generated_files/flags/default/a5
 	@${RM} ${OBJECTDIR}/flir_lepton35.o 
 	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flir_lepton35.o.d" -o ${OBJECTDIR}/flir_lepton35.o flir_lepton35.c    -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
 	
+${OBJECTDIR}/flir_kernels.o: flir_kernels.c  .generated_files/flags/default/7039baf9a73957c05c583d478b18c04567c3035d .generated_files/flags/default/d9d2ddc4e99a0dd90f8bbd92ce293767b3211522
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flir_kernels.o.d 
+	@${RM} ${OBJECTDIR}/flir_kernels.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flir_kernels.o.d" -o ${OBJECTDIR}/flir_kernels.o flir_kernels.c  -mdspr2  -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
+${OBJECTDIR}/flir_cci.o: flir_cci.c  .generated_files/flags/default/9285a9bae6b0d05b940e515177a4f3188b5508ab .generated_files/flags/default/d9d2ddc4e99a0dd90f8bbd92ce293767b3211522
+	@${MKDIR} "${OBJECTDIR}" 
+	@${RM} ${OBJECTDIR}/flir_cci.o.d 
+	@${RM} ${OBJECTDIR}/flir_cci.o 
+	${MP_CC}  $(MP_EXTRA_CC_PRE)  -g -x c -c -mprocessor=$(MP_PROCESSOR_OPTION)  -fno-common -MP -MMD -MF "${OBJECTDIR}/flir_cci.o.d" -o ${OBJECTDIR}/flir_cci.o flir_cci.c    -DXPRJ_default=$(CND_CONF)  -legacy-libc  $(COMPARISON_BUILD)  -mdfp="${DFP_DIR}"  
+	
 endif
 
 # ------------------------------------------------------------------------------------
@@ -0,0 +1,186 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Simulated Lepton VoSPI Stream
+ * ****************************************************
+ * File:    host_lepton.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ ******************************************************/
+
+#include "host_lepton.h"
+#include "host_panel.h"
+#include "host_test.h"
+#include "flir_kernels.h"
+#include "tft_st7789.h"
+#include <setjmp.h>
+#include <string.h>
+
+#define HOST_LEPTON_SEGMENTS            5       // 1 to 4, then an invalid one
+
+uint32_t Host_Lepton_Reads = 0;
+uint32_t Host_Lepton_Timeouts = 0;
+
+static Host_Lepton_Config lepton;
+static uint32_t group;                          // Packets per segment, discards included
+static uint64_t position = 0;                   // Byte in the stream
+static uint32_t last_read_us;
+static jmp_buf run_end;
+
+/******************************************************
+ * Stream
+ ******************************************************/
+// A diagonal gradient drifting by frame, with a hot and a cold spot
+uint16_t Host_Lepton_Pixel(uint32_t image, uint8_t row, uint8_t col)
+{
+    uint16_t value = 29000 + ((row * 7 + col * 3 + image * 50) % 900);
+
+    if (row == 40 && col == 100) {
+        value += 2000;
+    }
+    if (row == 90 && col == 20) {
+        value -= 500;
+    }
+
+    return value;
+}
+
+static void Host_Lepton_Packet(uint64_t index, uint8_t *packet)
+{
+    uint64_t segment_index = index / group;
+    uint32_t number = index % group;
+    uint32_t image = (segment_index / HOST_LEPTON_SEGMENTS) / lepton.Repeats;
+    uint8_t segment = (segment_index + 1) % HOST_LEPTON_SEGMENTS;
+    uint8_t header[4];
+    uint16_t crc;
+
+    memset(packet, 0, HOST_LEPTON_PACKET_SIZE);
+
+    if (number >= HOST_LEPTON_PACKETS) {
+        // Discard packets, xFxx with any content
+        packet[0] = 0x0F | (number << 4);
+        packet[1] = 0xA5 ^ number;
+        return;
+    }
+
+    packet[0] = (number == 20) ? (segment << 4) : 0;
+    packet[1] = number;
+
+    for (uint8_t i = 0; i < 80; i++) {
+        uint8_t row = 30 * (segment ? segment - 1 : 0) + number / 2;
+        uint16_t value = Host_Lepton_Pixel(image, row, (number & 1) * 80 + i);
+
+        packet[4 + 2 * i] = value >> 8;
+        packet[5 + 2 * i] = value;
+    }
+
+    // Over the packet with the ID's upper nibble and the CRC itself zeroed
+    header[0] = packet[0] & 0x0F;
+    header[1] = packet[1];
+    header[2] = 0;
+    header[3] = 0;
+    crc = FLIR_Kernel_CRC_Bitwise(header, 4, 0);
+    crc = FLIR_Kernel_CRC_Bitwise(packet + 4, HOST_LEPTON_PACKET_SIZE - 4, crc);
+    packet[2] = crc >> 8;
+    packet[3] = crc;
+}
+
+static uint8_t Host_Lepton_Byte(uint64_t at)
+{
+    static uint8_t packet[HOST_LEPTON_PACKET_SIZE];
+    static uint64_t cached = ~0ull;
+    uint64_t index = at / HOST_LEPTON_PACKET_SIZE;
+
+    if (index != cached) {
+        Host_Lepton_Packet(index, packet);
+        cached = index;
+    }
+
+    return packet[at % HOST_LEPTON_PACKET_SIZE];
+}
+
+static void Host_Lepton_Source(uint8_t *dst, uint16_t len)
+{
+    uint64_t packet;
+
+    if (Host_Lepton_Reads && BSP_Host_Time_us - last_read_us >= HOST_LEPTON_IDLE_US) {
+        // Timed out, the stream starts over at the next segment
+        packet = (position + HOST_LEPTON_PACKET_SIZE - 1) / HOST_LEPTON_PACKET_SIZE;
+        position = (packet / group + 1) * group * HOST_LEPTON_PACKET_SIZE;
+        Host_Lepton_Timeouts++;
+    }
+
+    packet = position / HOST_LEPTON_PACKET_SIZE;
+    if (lepton.Frames && !(position % HOST_LEPTON_PACKET_SIZE) && !(packet % group)
+            && packet / group >= (uint64_t)lepton.Frames * HOST_LEPTON_SEGMENTS) {
+        tft_render_wait();
+        longjmp(run_end, 1);
+    }
+
+    Host_Lepton_Reads++;
+    for (uint16_t i = 0; i < len; i++) {
+        dst[i] = Host_Lepton_Byte(position + i);
+    }
+    position += len;
+
+    if (lepton.Fault) {
+        lepton.Fault(Host_Lepton_Reads, dst, len);
+    }
+
+    last_read_us = BSP_Host_Time_us;
+}
+
+// Bytes the next read misses, as if the clock had run on
+void Host_Lepton_Skip(uint32_t bytes)
+{
+    position += bytes;
+}
+
+void Host_Lepton_Start(const Host_Lepton_Config *config)
+{
+    lepton = *config;
+    if (!lepton.Repeats) {
+        lepton.Repeats = 1;
+    }
+    group = HOST_LEPTON_PACKETS + lepton.Discards;
+    position = 0;
+    Host_Lepton_Reads = 0;
+    Host_Lepton_Timeouts = 0;
+
+    BSP_Host_Set_SPI1_Source(Host_Lepton_Source);
+}
+
+/******************************************************
+ * Run
+ ******************************************************/
+void Host_Lepton_Run(const Host_Lepton_Config *config)
+{
+    if (setjmp(run_end)) {
+        return;
+    }
+
+    BSP_Initialize();
+    Host_Lepton_Start(config);
+    FLIR_Process();
+}
+
+Host_Lepton_Stats Host_Lepton_Run_On_Panel(const Host_Lepton_Config *config)
+{
+    Host_Lepton_Stats stats;
+
+    BSP_Host_Set_TFT_Sink(Host_Panel_Sink);
+    Host_Lepton_Run(config);
+
+    stats.Sync = FLIR_Get_Sync_Stats();
+    stats.Frames = FLIR_Get_Frame_Stats();
+
+    printf("  %u frames: %u torn, %u repeated, %u corrupt and %u dropped segments, panel %08x\n",
+        stats.Frames.Completed, stats.Frames.Torn, stats.Frames.Repeated,
+        stats.Frames.Corrupt_Segments, stats.Frames.Dropped_Segments, Host_Panel_Hash());
+    printf("  %u ms: %u losses, %u restarts, %u idles, %u timeouts, out of sync %u ms (longest %u ms), idle %u ms\n",
+        BSP_Host_Time_us / 1000, stats.Sync.Losses, stats.Sync.Restarts, stats.Sync.Idles, Host_Lepton_Timeouts,
+        stats.Sync.Out_Of_Sync_us / 1000, stats.Sync.Longest_us / 1000, stats.Sync.Idle_ms);
+
+    HOST_CHECK_EQUAL(stats.Sync.Lost, 0);
+    HOST_CHECK_EQUAL(Host_Panel_Errors, 0);
+
+    return stats;
+}
@@ -0,0 +1,83 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Simulated Lepton VoSPI Stream
+ * ****************************************************
+ * File:    host_lepton.h
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    The video side of the camera, read through
+ *          the simulated SPI1 DMA of BSP_host.c.
+ ******************************************************/
+
+#ifndef HOST_LEPTON_H_
+#define HOST_LEPTON_H_
+
+#include "BSP.h"
+#include "flir_lepton35.h"
+
+#define HOST_LEPTON_PACKET_SIZE         164
+#define HOST_LEPTON_PACKETS             60      // Per segment
+#define HOST_LEPTON_IDLE_US             185000  // CS idle after which the stream restarts
+
+/******************************************************
+ * Stream
+ *
+ * A byte stream of packets, as the camera clocks it out
+ * whatever the reads look like: per frame segments 1 to
+ * 4 and one numbered 0, each followed by discard
+ * packets, every packet with its CRC. Each image is sent
+ * Repeats times in a row. Host_Lepton_Start() connects
+ * it to SPI1 from its first packet on. Reads with CS idle for over
+ * HOST_LEPTON_IDLE_US pick up the stream again at the
+ * next segment, as the Lepton does after a timeout.
+ ******************************************************/
+typedef void (*Host_Lepton_Fault)(uint32_t read, uint8_t *dst, uint16_t len);
+
+typedef struct
+{
+    uint32_t Frames;            // The run ends where the stream reaches this frame, 0 for never
+    uint16_t Discards;          // Discard packets after each segment
+    uint8_t Repeats;            // 0 counts as 1
+    Host_Lepton_Fault Fault;    // Sees each read, numbered from 1, and may damage it
+} Host_Lepton_Config;
+
+uint16_t Host_Lepton_Pixel(uint32_t image, uint8_t row, uint8_t col);
+
+extern uint32_t Host_Lepton_Reads;
+extern uint32_t Host_Lepton_Timeouts;
+
+void Host_Lepton_Start(const Host_Lepton_Config *config);
+void Host_Lepton_Skip(uint32_t bytes);
+
+/******************************************************
+ * Run
+ *
+ * Starts the BSP and FLIR_Process() on the stream and
+ * returns when the stream reaches the last frame and the
+ * display transfer in progress is out. FLIR_Process()
+ * never returns, the run ends by a long jump: it can be
+ * done once per process.
+ ******************************************************/
+void Host_Lepton_Run(const Host_Lepton_Config *config);
+
+/******************************************************
+ * Run on the Panel
+ *
+ * A run with the display bus feeding the simulated
+ * panel. Returns the capture stats at its end, having
+ * printed them and checked that capture is in sync and
+ * the panel saw no bad cycle. A run ending on image 3,
+ * or on any 18 images later as the gradient wraps, must
+ * leave HOST_LEPTON_PANEL_HASH whatever the faults on
+ * the way, as long as the last frame came through.
+ ******************************************************/
+#define HOST_LEPTON_PANEL_HASH          0x560EFACD
+
+typedef struct
+{
+    FLIR_Sync_Stats Sync;
+    FLIR_Frame_Stats Frames;
+} Host_Lepton_Stats;
+
+Host_Lepton_Stats Host_Lepton_Run_On_Panel(const Host_Lepton_Config *config);
+
+#endif /* HOST_LEPTON_H_ */
@@ -0,0 +1,143 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Simulated ST7789 Panel
+ * ****************************************************
+ * File:    host_panel.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ ******************************************************/
+
+#include "host_panel.h"
+#include <string.h>
+
+#define HOST_PANEL_CASET                0x2A
+#define HOST_PANEL_RASET                0x2B
+#define HOST_PANEL_RAMWR                0x2C
+#define HOST_PANEL_COLMOD               0x3A
+#define HOST_PANEL_COLMOD_444           0x53
+
+uint16_t Host_Panel[HOST_PANEL_HEIGHT][HOST_PANEL_WIDTH];
+uint32_t Host_Panel_Bytes = 0;
+uint32_t Host_Panel_Pixels = 0;
+uint32_t Host_Panel_Errors = 0;
+
+static uint8_t command;
+static uint8_t args[4];
+static uint8_t n_args;
+static uint8_t colmod = 0x55;
+static uint8_t high_byte;
+static uint8_t have_high;
+static uint32_t nibbles;
+static uint8_t n_nibbles;
+static uint16_t x_start, x_end, y_start, y_end;
+static uint16_t x, y;
+
+static void Host_Panel_Put(uint16_t color)
+{
+    if (x < HOST_PANEL_WIDTH && y < HOST_PANEL_HEIGHT) {
+        Host_Panel[y][x] = color;
+    } else {
+        Host_Panel_Errors++;
+    }
+    Host_Panel_Pixels++;
+
+    if (++x > x_end) {
+        x = x_start;
+        y++;
+    }
+}
+
+void Host_Panel_Sink(const BSP_Host_TFT_Cycle *cycle)
+{
+    uint16_t value = cycle->Value;
+
+    if (cycle->CS) {
+        Host_Panel_Errors++;
+        return;
+    }
+    Host_Panel_Bytes += BSP_TFT_BUS_WIDTH / 8;
+
+    if (!cycle->DC) {
+        command = value;
+        n_args = 0;
+        have_high = 0;
+        n_nibbles = 0;
+        if (command == HOST_PANEL_RAMWR) {
+            x = x_start;
+            y = y_start;
+        }
+        return;
+    }
+
+    switch (command) {
+        case HOST_PANEL_COLMOD:
+            colmod = value;
+            break;
+
+        case HOST_PANEL_CASET:
+        case HOST_PANEL_RASET:
+            if (n_args < 4) {
+                args[n_args++] = value;
+            }
+            if (n_args == 4) {
+                uint16_t start = (args[0] << 8) | args[1];
+                uint16_t end = (args[2] << 8) | args[3];
+
+                if (command == HOST_PANEL_CASET) {
+                    x_start = start;
+                    x_end = end;
+                } else {
+                    y_start = start;
+                    y_end = end;
+                }
+            }
+            break;
+
+        case HOST_PANEL_RAMWR:
+            if (BSP_TFT_BUS_WIDTH == 16) {
+                Host_Panel_Put(value);
+            } else if (colmod == HOST_PANEL_COLMOD_444) {
+                // Two pixels in three bytes
+                nibbles = (nibbles << 8) | (uint8_t)value;
+                n_nibbles += 2;
+                if (n_nibbles >= 3) {
+                    uint16_t rgb444;
+
+                    n_nibbles -= 3;
+                    rgb444 = (nibbles >> (4 * n_nibbles)) & 0x0FFF;
+                    Host_Panel_Put(((rgb444 & 0x0F00) << 4) | ((rgb444 & 0x00F0) << 3) | ((rgb444 & 0x000F) << 1));
+                }
+            } else if (!have_high) {
+                high_byte = value;
+                have_high = 1;
+            } else {
+                have_high = 0;
+                Host_Panel_Put((high_byte << 8) | (uint8_t)value);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void Host_Panel_Clear(void)
+{
+    memset(Host_Panel, 0, sizeof(Host_Panel));
+    Host_Panel_Bytes = 0;
+    Host_Panel_Pixels = 0;
+    Host_Panel_Errors = 0;
+}
+
+// FNV-1a over the panel memory
+uint32_t Host_Panel_Hash(void)
+{
+    uint32_t hash = 2166136261u;
+
+    for (uint16_t row = 0; row < HOST_PANEL_HEIGHT; row++) {
+        for (uint16_t col = 0; col < HOST_PANEL_WIDTH; col++) {
+            hash = (hash ^ Host_Panel[row][col]) * 16777619u;
+        }
+    }
+
+    return hash;
+}
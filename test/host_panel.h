@@ -0,0 +1,38 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Simulated ST7789 Panel
+ * ****************************************************
+ * File:    host_panel.h
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Decodes the display bus cycles of BSP_host.c
+ *          into the panel memory, so tests compare what
+ *          would be on the screen rather than the bytes.
+ ******************************************************/
+
+#ifndef HOST_PANEL_H_
+#define HOST_PANEL_H_
+
+#include "BSP.h"
+
+#define HOST_PANEL_WIDTH                240
+#define HOST_PANEL_HEIGHT               320
+
+/******************************************************
+ * Panel Memory
+ *
+ * CASET, RASET and RAMWR place the pixels, COLMOD picks
+ * RGB565 or RGB444; RGB444 pixels are widened to RGB565
+ * with the low bit of each channel clear. A cycle with
+ * CS high counts as an error, as does a pixel outside
+ * the panel.
+ ******************************************************/
+extern uint16_t Host_Panel[HOST_PANEL_HEIGHT][HOST_PANEL_WIDTH];
+extern uint32_t Host_Panel_Bytes;       // On the bus, commands included
+extern uint32_t Host_Panel_Pixels;
+extern uint32_t Host_Panel_Errors;
+
+void Host_Panel_Sink(const BSP_Host_TFT_Cycle *cycle);
+void Host_Panel_Clear(void);
+uint32_t Host_Panel_Hash(void);
+
+#endif /* HOST_PANEL_H_ */
@@ -0,0 +1,52 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Checks and Scenarios
+ * ****************************************************
+ * File:    host_test.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ ******************************************************/
+
+#include "host_test.h"
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define HOST_TEST_TIMEOUT_S             300     // A scenario stuck in a wait fails instead of hanging the build
+
+uint32_t Host_Test_Failures = 0;
+
+int Host_Test_Exit(void)
+{
+    if (Host_Test_Failures) {
+        printf("%u check(s) failed\n", Host_Test_Failures);
+        return 1;
+    }
+
+    return 0;
+}
+
+int Host_Test_Scenario(const char *name, void (*scenario)(void))
+{
+    pid_t child;
+    int status;
+
+    printf("%s\n", name);
+    fflush(stdout);
+
+    child = fork();
+    if (child == 0) {
+        Host_Test_Failures = 0;
+        alarm(HOST_TEST_TIMEOUT_S);
+        scenario();
+        fflush(stdout);
+        _exit(Host_Test_Failures ? 1 : 0);
+    }
+
+    if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) || WEXITSTATUS(status)) {
+        printf("%s: failed\n", name);
+        Host_Test_Failures++;
+        return 1;
+    }
+
+    return 0;
+}
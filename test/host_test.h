@@ -0,0 +1,54 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Checks and Scenarios
+ * ****************************************************
+ * File:    host_test.h
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ ******************************************************/
+
+#ifndef HOST_TEST_H_
+#define HOST_TEST_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+/******************************************************
+ * Checks
+ *
+ * A failed check is printed and counted, the test goes
+ * on; Host_Test_Exit() gives the status for main().
+ ******************************************************/
+extern uint32_t Host_Test_Failures;
+
+#define HOST_CHECK(condition)                                                       \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);    \
+            Host_Test_Failures++;                                                   \
+        }                                                                           \
+    } while (0)
+
+#define HOST_CHECK_EQUAL(actual, expected)                                          \
+    do {                                                                            \
+        unsigned long long actual_ = (actual), expected_ = (expected);              \
+        if (actual_ != expected_) {                                                 \
+            printf("%s:%d: check failed: %s is %llu (0x%llx), expected %llu (0x%llx)\n", \
+                __FILE__, __LINE__, #actual, actual_, actual_, expected_, expected_);   \
+            Host_Test_Failures++;                                                   \
+        }                                                                           \
+    } while (0)
+
+int Host_Test_Exit(void);
+
+/******************************************************
+ * Scenarios
+ *
+ * The drivers keep their state in statics and the run
+ * of FLIR_Process() ends by a long jump, so each
+ * scenario runs in a child process of its own and
+ * starts from a fresh image. The result is nonzero when
+ * the scenario failed a check or did not exit in time.
+ ******************************************************/
+int Host_Test_Scenario(const char *name, void (*scenario)(void));
+
+#endif /* HOST_TEST_H_ */
@@ -0,0 +1,384 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Fixed-Point AGC
+ * ****************************************************
+ * File:    test_agc.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Builds flir_lepton35.c in, for its statics:
+ *          the range goes through FLIR_AGC_Set_Range()
+ *          and FLIR_Colorize_Params() and the pixels
+ *          through both packet kernels, as in a frame.
+ *          The histogram modes map known histograms,
+ *          then run on the simulated Lepton.
+ ******************************************************/
+
+#include "flir_lepton35.c"
+#include "host_lepton.h"
+#include "host_panel.h"
+#include "host_test.h"
+
+/******************************************************
+ * References
+ *
+ * The exact index floor((v - min) * 255 / (max - min)),
+ * and the float expression the driver used before, which
+ * truncates a product rounded to float and so lands one
+ * off the exact index now and then, either way.
+ ******************************************************/
+static uint16_t Reference_Exact(uint32_t d, uint32_t diff)
+{
+    return (uint16_t)(d * 255 / diff);
+}
+
+static uint16_t Reference_Float(uint16_t value, uint16_t min_value, uint16_t max_value)
+{
+    float scale = 255.0f / (float)(max_value - min_value);
+
+    return (uint16_t)(((float)value - (float)min_value) * scale);
+}
+
+/******************************************************
+ * Kernel Runs
+ ******************************************************/
+static uint8_t packet[FLIR_KERNEL_HEADER_SIZE + 2 * FLIR_KERNEL_PIXELS] __attribute__((aligned(4)));
+static uint16_t indices_c[FLIR_KERNEL_PIXELS];
+static uint16_t indices_dsp[FLIR_KERNEL_PIXELS];
+
+// Maps count values through both kernels with the current range, 1 when they agree
+static int Map_Packet(const uint16_t *values, int count)
+{
+    FLIR_Kernel_Params params;
+    FLIR_Kernel_Range range_c = { 65535, 0 };
+    FLIR_Kernel_Range range_dsp = { 65535, 0 };
+
+    FLIR_Colorize_Params(&params);
+
+    for (int i = 0; i < FLIR_KERNEL_PIXELS; i++) {
+        // Repeats the last value to fill the packet
+        uint16_t value = values[(i < count) ? i : count - 1];
+
+        packet[FLIR_KERNEL_HEADER_SIZE + 2 * i] = value >> 8;
+        packet[FLIR_KERNEL_HEADER_SIZE + 2 * i + 1] = value;
+    }
+
+    if (FLIR_Kernel_Packet_C(packet, indices_c, &params, &range_c) != FLIR_KERNEL_PIXELS
+            || FLIR_Kernel_Packet_DSP(packet, indices_dsp, &params, &range_dsp) != FLIR_KERNEL_PIXELS) {
+        return 0;
+    }
+
+    for (int i = 0; i < count; i++) {
+        if (indices_c[i] != indices_dsp[i]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/******************************************************
+ * Every Range, Every Offset
+ *
+ * Each max - min from 1 to 65535, at a min that moves
+ * with it, and each value from min to max. A zero pixel
+ * ends a packet, so for 0..65535 the value 0 is left
+ * out; the camera never sends it.
+ ******************************************************/
+static void Test_AGC_Exhaustive(void)
+{
+    uint16_t values[FLIR_KERNEL_PIXELS];
+    uint64_t checked = 0;
+    uint32_t exact_failures = 0;
+    uint32_t float_over_one = 0;
+    uint32_t float_below = 0;
+    uint32_t float_above = 0;
+    uint32_t kernel_failures = 0;
+
+    for (uint32_t diff = 1; diff <= 65535; diff++) {
+        uint16_t min_value = (diff == 65535) ? 0 : 1 + (diff * 7919u) % (65535 - diff);
+        uint16_t max_value = min_value + diff;
+        uint32_t d = (min_value == 0) ? 1 : 0;
+
+        FLIR_AGC_Set_Range(min_value, max_value);
+
+        while (d <= diff) {
+            int count = 0;
+
+            while (count < FLIR_KERNEL_PIXELS && d + count <= diff) {
+                values[count] = min_value + d + count;
+                count++;
+            }
+
+            if (!Map_Packet(values, count)) {
+                kernel_failures++;
+            }
+
+            for (int i = 0; i < count; i++, d++) {
+                uint16_t exact = Reference_Exact(d, diff);
+                uint16_t rounded = Reference_Float(values[i], min_value, max_value);
+
+                if (indices_c[i] != exact) {
+                    exact_failures++;
+                }
+                if (indices_c[i] > rounded + 1 || rounded > indices_c[i] + 1) {
+                    float_over_one++;
+                } else if (rounded < indices_c[i]) {
+                    float_below++;
+                } else if (rounded > indices_c[i]) {
+                    float_above++;
+                }
+            }
+            checked += count;
+        }
+    }
+
+    HOST_CHECK_EQUAL(kernel_failures, 0);
+    HOST_CHECK_EQUAL(exact_failures, 0);
+    HOST_CHECK_EQUAL(float_over_one, 0);
+
+    // All of 0..diff over every diff is 2^31 + 2^32 - 1 - 2^16 + 1 pairs, less the one zero pixel
+    HOST_CHECK_EQUAL(checked, 65535ull * 65538 / 2 - 1);
+
+    printf("  %llu values exact, the float expression one below on %u and one above on %u of them\n",
+        (unsigned long long)checked, float_below, float_above);
+}
+
+/******************************************************
+ * Full Input Range
+ *
+ * Every 16-bit value through a few ranges, clamped to
+ * them as the frame extremes would be.
+ ******************************************************/
+static void Test_AGC_Full_Input(void)
+{
+    static const uint16_t ranges[][2] = {
+        { 29000, 29001 }, { 29000, 30000 }, { 30000, 32000 }, { 7000, 7001 },
+        { 1, 65535 }, { 29000, 40000 }, { 32767, 32768 }, { 100, 100 }, { 40000, 30000 },
+    };
+    uint16_t values[FLIR_KERNEL_PIXELS];
+
+    for (uint32_t r = 0; r < sizeof(ranges) / sizeof(ranges[0]); r++) {
+        uint16_t min_value = ranges[r][0];
+        uint16_t max_value = ranges[r][1];
+        uint32_t failures = 0;
+
+        FLIR_AGC_Set_Range(min_value, max_value);
+
+        for (uint32_t value = 1; value <= 65535; value += FLIR_KERNEL_PIXELS) {
+            int count = (65536 - value < FLIR_KERNEL_PIXELS) ? 65536 - value : FLIR_KERNEL_PIXELS;
+
+            for (int i = 0; i < count; i++) {
+                values[i] = value + i;
+            }
+
+            if (!Map_Packet(values, count)) {
+                failures++;
+                continue;
+            }
+
+            for (int i = 0; i < count; i++) {
+                uint16_t expected = 0;
+
+                // A flat or inverted range maps everything to the first entry
+                if (max_value > min_value && values[i] >= max_value) {
+                    expected = 255;
+                } else if (max_value > min_value && values[i] > min_value) {
+                    expected = Reference_Exact(values[i] - min_value, max_value - min_value);
+                }
+
+                if (indices_c[i] != expected) {
+                    failures++;
+                }
+            }
+        }
+
+        HOST_CHECK_EQUAL(failures, 0);
+    }
+}
+
+/******************************************************
+ * Histogram Maps
+ *
+ * Known histograms through FLIR_AGC_Map_Plateau() and
+ * FLIR_AGC_Map_Linear_Clip(): a uniform scene, a scene
+ * with one hot pixel far above it and a large uniform
+ * area, each checked bin by bin in histogram_map.
+ ******************************************************/
+#define HOT_BIN                         (FLIR_AGC_BINS - 1)
+
+// Counts in bins 0 to n_bins - 1, nothing elsewhere
+static void Histogram_Scene(int n_bins, uint16_t count)
+{
+    memset(histogram, 0, sizeof(histogram));
+    for (int bin = 0; bin < n_bins; bin++) {
+        histogram[bin] = count;
+    }
+}
+
+static void Test_AGC_Plateau(void)
+{
+    // Uniform: the equalized map is the even ramp, each bin at the middle of its share
+    Histogram_Scene(FLIR_AGC_BINS, 100);
+    FLIR_AGC_Map_Plateau();
+    for (int bin = 0; bin < FLIR_AGC_BINS; bin++) {
+        HOST_CHECK_EQUAL(histogram_map[bin], (2 * bin + 1) * 255 / (2 * FLIR_AGC_BINS));
+    }
+
+    // One hot pixel: the scene keeps the palette, the empty bins above it and the hot one go to the top
+    Histogram_Scene(100, 100);
+    histogram[HOT_BIN] = 1;
+    FLIR_AGC_Map_Plateau();
+    HOST_CHECK(histogram_map[0] <= 1);
+    HOST_CHECK(histogram_map[99] >= 253);
+    HOST_CHECK_EQUAL(histogram_map[500], 254);
+    HOST_CHECK_EQUAL(histogram_map[HOT_BIN], 254);
+
+    // A large uniform area in bin 512 takes no more than its plateau's share
+    Histogram_Scene(FLIR_AGC_BINS, 10);
+    histogram[512] = 10000;
+    FLIR_AGC_Map_Plateau();
+    HOST_CHECK(histogram_map[513] - histogram_map[511] <= 1 + 255 * FLIR_AGC_PLATEAU_DEFAULT / (1023 * 10 + FLIR_AGC_PLATEAU_DEFAULT));
+
+    // Without the plateau it would take about half the palette
+    agc_plateau = 65535;
+    FLIR_AGC_Map_Plateau();
+    HOST_CHECK(histogram_map[513] - histogram_map[511] >= 120);
+    agc_plateau = FLIR_AGC_PLATEAU_DEFAULT;
+
+    // Empty: the map is kept
+    memset(histogram, 0, sizeof(histogram));
+    memset(histogram_map, 77, sizeof(histogram_map));
+    FLIR_AGC_Map_Plateau();
+    HOST_CHECK_EQUAL(histogram_map[0], 77);
+    HOST_CHECK_EQUAL(histogram_map[HOT_BIN], 77);
+}
+
+// Bins up to low black, from high white, a ramp between
+static uint32_t Clip_Failures(int low_bin, int high_bin)
+{
+    uint32_t failures = 0;
+
+    for (int bin = 0; bin < FLIR_AGC_BINS; bin++) {
+        uint8_t expected = 255;
+
+        if (bin <= low_bin) {
+            expected = 0;
+        } else if (bin < high_bin) {
+            expected = (bin - low_bin) * 255 / (high_bin - low_bin);
+        }
+
+        failures += (histogram_map[bin] != expected);
+    }
+
+    return failures;
+}
+
+static void Test_AGC_Linear_Clip(void)
+{
+    // Uniform, 1% and 99%: 1024 of 102400 pixels reached past bin 10, 101376 at bin 1013
+    Histogram_Scene(FLIR_AGC_BINS, 100);
+    FLIR_Set_AGC_Clip(10, 990);
+    FLIR_AGC_Map_Linear_Clip();
+    HOST_CHECK_EQUAL(Clip_Failures(10, 1013), 0);
+
+    // One hot pixel: clipped, the scene spread over the whole palette
+    Histogram_Scene(100, 100);
+    histogram[HOT_BIN] = 1;
+    FLIR_AGC_Map_Linear_Clip();
+    HOST_CHECK_EQUAL(Clip_Failures(1, 99), 0);
+    HOST_CHECK_EQUAL(histogram_map[50], 127);
+    HOST_CHECK_EQUAL(histogram_map[HOT_BIN], 255);
+
+    // 0 and 1000 permille: from the first to the last pixel, the hot one included
+    FLIR_Set_AGC_Clip(0, 1000);
+    FLIR_AGC_Map_Linear_Clip();
+    HOST_CHECK_EQUAL(Clip_Failures(0, HOT_BIN), 0);
+    HOST_CHECK_EQUAL(histogram_map[99], 24);
+
+    // Both at the median, reached as bin 511 ends: a step of one bin there
+    Histogram_Scene(FLIR_AGC_BINS, 100);
+    FLIR_Set_AGC_Clip(500, 500);
+    FLIR_AGC_Map_Linear_Clip();
+    HOST_CHECK_EQUAL(Clip_Failures(511, 512), 0);
+
+    // Both at 0: everything past the first bin white
+    FLIR_Set_AGC_Clip(0, 0);
+    FLIR_AGC_Map_Linear_Clip();
+    HOST_CHECK_EQUAL(Clip_Failures(0, 1), 0);
+
+    // Empty: the map is kept
+    memset(histogram, 0, sizeof(histogram));
+    memset(histogram_map, 77, sizeof(histogram_map));
+    FLIR_AGC_Map_Linear_Clip();
+    HOST_CHECK_EQUAL(histogram_map[0], 77);
+    HOST_CHECK_EQUAL(histogram_map[HOT_BIN], 77);
+}
+
+/******************************************************
+ * Histogram Modes on the Panel
+ *
+ * The simulated scene is a gradient over 900 counts
+ * with a hot spot 2000 above it and a cold one 500
+ * below. The linear AGC stretches the spots' range over
+ * the palette, leaving the gradient a third of it; both
+ * histogram modes spread the gradient over the palette.
+ ******************************************************/
+#define AGC_FRAMES                      6
+
+static uint32_t Panel_Colors(void)
+{
+    static uint8_t seen[65536];
+    uint32_t colors = 0;
+
+    memset(seen, 0, sizeof(seen));
+    for (int row = 0; row < HOST_PANEL_HEIGHT; row++) {
+        for (int col = 0; col < HOST_PANEL_WIDTH; col++) {
+            colors += !seen[Host_Panel[row][col]];
+            seen[Host_Panel[row][col]] = 1;
+        }
+    }
+
+    return colors;
+}
+
+static void Run_Mode(uint8_t mode)
+{
+    Host_Lepton_Config config = { .Frames = AGC_FRAMES, .Discards = 3 };
+    Host_Lepton_Stats stats;
+
+    FLIR_Set_AGC_Mode(mode);
+    stats = Host_Lepton_Run_On_Panel(&config);
+
+    HOST_CHECK_EQUAL(stats.Frames.Completed, AGC_FRAMES);
+    printf("  %u colours on the panel\n", Panel_Colors());
+}
+
+static void Test_AGC_Linear_Panel(void)
+{
+    Run_Mode(FLIR_AGC_LINEAR);
+    HOST_CHECK(Panel_Colors() < 64);
+}
+
+static void Test_AGC_Plateau_Panel(void)
+{
+    Run_Mode(FLIR_AGC_PLATEAU);
+    HOST_CHECK(Panel_Colors() > 128);
+}
+
+static void Test_AGC_Linear_Clip_Panel(void)
+{
+    Run_Mode(FLIR_AGC_LINEAR_CLIP);
+    HOST_CHECK(Panel_Colors() > 128);
+}
+
+int main(void)
+{
+    Host_Test_Scenario("agc: every range, every offset", Test_AGC_Exhaustive);
+    Host_Test_Scenario("agc: full input range", Test_AGC_Full_Input);
+    Host_Test_Scenario("agc: plateau map", Test_AGC_Plateau);
+    Host_Test_Scenario("agc: linear clip map", Test_AGC_Linear_Clip);
+    Host_Test_Scenario("agc: linear on the panel", Test_AGC_Linear_Panel);
+    Host_Test_Scenario("agc: plateau on the panel", Test_AGC_Plateau_Panel);
+    Host_Test_Scenario("agc: linear clip on the panel", Test_AGC_Linear_Clip_Panel);
+
+    return Host_Test_Exit();
+}
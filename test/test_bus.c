@@ -0,0 +1,210 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Display Bus
+ * ****************************************************
+ * File:    test_bus.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Built for each bus in test/Makefile: SPI2 at
+ *          each stream width and the PMP at 8 and 16
+ *          bits must leave the same panel for every
+ *          drawing, as recorded on the bus.
+ ******************************************************/
+
+#include "BSP.h"
+#include "host_panel.h"
+#include "host_test.h"
+#include <string.h>
+
+void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
+void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+
+/******************************************************
+ * Drawings
+ *
+ * Each starts from a cleared panel after tft_init(). The
+ * expected hashes are of the panel memory, the second
+ * with TFT_CONFIG_RGB444, whose pixels lose the low bit
+ * of each channel.
+ ******************************************************/
+static uint16_t image_data[120][160];
+static uint8_t image_indices[120][160];
+static uint16_t image_palette[256];
+
+#define IMAGE                           TFT_IMAGE(&image_data[0][0], 160, 120, 160)
+#define INDEXED                         TFT_IMAGE_INDEXED(&image_indices[0][0], image_palette, 160, 120, 160)
+
+static void Draw_Fill_Rect(void) { tft_fill_rect(10, 20, 100, 50, 0x1234); }
+static void Draw_Fill_Clipped(void) { tft_fill_rect(-10, 200, 300, 100, 0x4321); }
+static void Draw_Fill_Screen(void) { tft_fill_screen(0xF00F); }
+static void Draw_Lines(void)
+{
+    tft_draw_line(0, 0, 200, 60, 0xFFFF);
+    tft_draw_line(5, 10, 35, 210, 0xF800);
+    tft_draw_line(-50, -20, 300, 250, 0x07E0);
+    tft_draw_rect(10, 10, 100, 60, 0x001F);
+}
+static void Draw_Circles(void)
+{
+    drawCircle(120, 120, 50, 0x07E0);
+    drawCircle(10, 120, 50, 0x07FF);
+    tft_fill_half_circle(120, 120, 40, 0x001F);
+    tft_fill_circle_slice(120, 100);
+}
+static void Draw_Text(void)
+{
+    tft_set_cursor(0, 0);
+    tft_set_text_bg_color(0xFFFF, 0);
+    tft_printf("Hello 42");
+    tft_set_text_color(0xF800);
+    tft_printf(" transparent");
+    tft_set_cursor(200, 30);
+    tft_set_text_bg_color(0xF800, 0x001F);
+    tft_printf("status %d line %u wraps here\nnext %c%%", -1234, 567u, 'Z');
+    tft_set_cursor(0, 100);
+    tft_set_text_size(3);
+    tft_set_text_bg_color(0xFFFF, 0);
+    tft_printf("ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789");
+    tft_set_text_size(1);
+    drawChar(-3, 50, 'Q', 0xFFFF, 0x2222, 1, 1);
+    drawChar(236, 50, 'Q', 0xFFFF, 0x2222, 1, 1);
+    drawChar(100, -4, 'Q', 0xFFFF, 0x2222, 2, 2);
+}
+static void Draw_Image(void) { tft_render_image(IMAGE, 3, 5); }
+static void Draw_Image_Async(void)
+{
+    tft_render_image_async(tft_image_crop(IMAGE, 1, 2, 37, 13), 7, 9, 0);
+    tft_render_image_async(tft_image_crop(IMAGE, 1, 15, 37, 13), 7, 22, 0);
+    tft_render_image_async(IMAGE, 60, 100, 0);
+}
+static void Draw_Indexed(void)
+{
+    tft_render_image(tft_image_crop(INDEXED, 1, 2, 37, 13), 7, 9);
+    tft_render_image_async(INDEXED, 60, 100, 0);
+}
+static void Draw_Scaled(void) { tft_render_image_scaled(IMAGE, 0, 0, TFT_SCALE_NEAREST); }
+static void Draw_Scaled_Indexed(void) { tft_render_image_scaled(INDEXED, 0, 30, TFT_SCALE_BILINEAR); }
+static void Draw_Delta(void)
+{
+    tft_delta_invalidate();
+    tft_render_image_delta(IMAGE, 0, 0);
+    image_data[50][50] ^= 0xFFFF;
+    tft_render_image_delta(IMAGE, 0, 0);
+}
+static void Draw_Raw(void)
+{
+    uint8_t raw[3 * 21 * 5];
+
+    for (uint32_t i = 0; i < sizeof(raw); i++) {
+        raw[i] = i * 7;
+    }
+    tft_render_image_raw(raw, 5, 5, 21, 5);
+}
+
+typedef struct
+{
+    const char *Name;
+    void (*Draw)(void);
+    uint32_t Hash;
+    uint32_t Hash_RGB444;
+} Drawing;
+
+static const Drawing drawings[] = {
+    { "fill_rect",              Draw_Fill_Rect,         0x7185AAE5, 0x3A7F13E5 },
+    { "fill_rect clipped",      Draw_Fill_Clipped,      0xB0948F45, 0x74B14DC5 },
+    { "fill_screen",            Draw_Fill_Screen,       0xC967E6C5, 0x73F53DC5 },
+    { "lines",                  Draw_Lines,             0x7448E729, 0xB8DFDC05 },
+    { "circles",                Draw_Circles,           0xDBC04935, 0x3BD16385 },
+    { "text",                   Draw_Text,              0x701C3711, 0x2542A5DF },
+    { "image",                  Draw_Image,             0xD5976FE8, 0x8A648893 },
+    { "image async",            Draw_Image_Async,       0x7E57DACB, 0x6EDDF445 },
+    { "indexed",                Draw_Indexed,           0xE852295E, 0xCB141DED },
+    { "scaled",                 Draw_Scaled,            0x02859312, 0xC34748FF },
+    { "scaled indexed",         Draw_Scaled_Indexed,    0xEA6956D4, 0xC26496EF },
+    { "delta",                  Draw_Delta,             0x4F9E3E85, 0xE8DFC89D },
+    { "raw",                    Draw_Raw,               0xB53F3319, 0x2DD99AAB },
+};
+
+static uint32_t drawing;
+
+static void Test_Bus_Start(void)
+{
+    for (int i = 0; i < 256; i++) {
+        image_palette[i] = (uint16_t)(i * 257 + 13);
+    }
+    for (int y = 0; y < 120; y++) {
+        for (int x = 0; x < 160; x++) {
+            image_indices[y][x] = (x * 3 + y * 7) & 255;
+            image_data[y][x] = (uint16_t)(x * 411 + y * 97);
+        }
+    }
+
+    BSP_Host_Set_TFT_Sink(Host_Panel_Sink);
+    BSP_Initialize();
+    Host_Panel_Clear();
+}
+
+static void Test_Bus_Drawing(void)
+{
+    const Drawing *d = &drawings[drawing];
+#ifdef TFT_CONFIG_RGB444
+    uint32_t expected = d->Hash_RGB444;
+#else
+    uint32_t expected = d->Hash;
+#endif
+
+    Test_Bus_Start();
+    d->Draw();
+    tft_render_wait();
+
+    HOST_CHECK_EQUAL(Host_Panel_Errors, 0);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), expected);
+
+    printf("  %08x, %u bytes\n", Host_Panel_Hash(), Host_Panel_Bytes);
+}
+
+/******************************************************
+ * Recording
+ *
+ * The record holds the same cycles as went to the sink,
+ * and a panel fed from it alone ends up the same.
+ ******************************************************/
+#define RECORD_SIZE                     200000
+
+static BSP_Host_TFT_Cycle record[RECORD_SIZE];
+
+static void Test_Bus_Record(void)
+{
+    uint32_t recorded, hash;
+
+    Test_Bus_Start();
+    BSP_Host_TFT_Record(record, RECORD_SIZE);
+    recorded = BSP_Host_TFT_Recorded;
+
+    Draw_Text();
+    Draw_Image_Async();
+    tft_render_wait();
+
+    recorded = BSP_Host_TFT_Recorded - recorded;
+    hash = Host_Panel_Hash();
+
+    HOST_CHECK(recorded <= RECORD_SIZE);
+    HOST_CHECK_EQUAL(recorded * (BSP_TFT_BUS_WIDTH / 8), Host_Panel_Bytes);
+
+    Host_Panel_Clear();
+    for (uint32_t i = 0; i < recorded; i++) {
+        Host_Panel_Sink(&record[i]);
+    }
+
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), hash);
+    HOST_CHECK_EQUAL(Host_Panel_Errors, 0);
+}
+
+int main(void)
+{
+    for (drawing = 0; drawing < sizeof(drawings) / sizeof(drawings[0]); drawing++) {
+        Host_Test_Scenario(drawings[drawing].Name, Test_Bus_Drawing);
+    }
+    Host_Test_Scenario("recording", Test_Bus_Record);
+
+    return Host_Test_Exit();
+}
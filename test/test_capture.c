@@ -0,0 +1,99 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - VoSPI DMA Capture
+ * ****************************************************
+ * File:    test_capture.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Segments come out of FLIR_Capture_Poll() in
+ *          stream order, one DMA transfer per packet,
+ *          and FLIR_Process() shows every frame of a
+ *          clean stream without losing sync.
+ ******************************************************/
+
+#include "BSP.h"
+#include "flir_lepton35.h"
+#include "host_lepton.h"
+#include "host_panel.h"
+#include "host_test.h"
+
+#define FRAMES                          6
+#define DISCARDS                        3
+
+/******************************************************
+ * Capture Alone
+ ******************************************************/
+static void Test_Capture_Sequence(void)
+{
+    Host_Lepton_Config config = { .Frames = 0, .Discards = DISCARDS };
+    uint32_t cycles = 0;
+
+    Host_Lepton_Start(&config);
+    FLIR_Capture_Initialize();
+    FLIR_Capture_Start();
+
+    for (uint32_t index = 0; index < 5 * FRAMES; index++) {
+        uint32_t reads = Host_Lepton_Reads;
+        uint32_t started = BSP_Cycle_Count();
+        int segment;
+
+        while ((segment = FLIR_Capture_Poll()) == FLIR_CAPTURE_PENDING) {
+        }
+        cycles += BSP_Cycle_Count() - started;
+
+        // 1 to 4 then the invalid one, given up at packet 20; its other packets and the discards are read through
+        HOST_CHECK_EQUAL(segment, (index + 1) % 5);
+        if (segment == 0) {
+            HOST_CHECK_EQUAL(Host_Lepton_Reads - reads, DISCARDS + 21);
+        } else if (segment == 1 && index) {
+            HOST_CHECK_EQUAL(Host_Lepton_Reads - reads, (60 - 21) + DISCARDS + 60);
+        } else {
+            HOST_CHECK_EQUAL(Host_Lepton_Reads - reads, (index ? DISCARDS : 0) + 60);
+        }
+
+        FLIR_Capture_Start();
+    }
+
+    HOST_CHECK_EQUAL(BSP_Host_SPI1_Transfers, Host_Lepton_Reads);
+    HOST_CHECK_EQUAL(BSP_Host_SPI1_Bytes, 164 * BSP_Host_SPI1_Transfers);
+    HOST_CHECK_EQUAL(Host_Lepton_Timeouts, 0);
+    HOST_CHECK_EQUAL(FLIR_Get_Sync_Stats().Losses, 0);
+    HOST_CHECK_EQUAL(FLIR_Get_Sync_Stats().Discards, DISCARDS * (5 * FRAMES - 1));
+
+    printf("  %u segments, %u packets in %u us, %u host cycles per segment\n",
+        5 * FRAMES, BSP_Host_SPI1_Transfers, BSP_Host_Time_us, cycles / (5 * FRAMES));
+}
+
+/******************************************************
+ * Frames on the Panel
+ ******************************************************/
+static void Test_Capture_Frames(void)
+{
+    Host_Lepton_Config config = { .Frames = FRAMES, .Discards = DISCARDS };
+    Host_Lepton_Stats stats = Host_Lepton_Run_On_Panel(&config);
+
+    // Every packet of the stream read once, the camera never timed out
+    HOST_CHECK_EQUAL(Host_Lepton_Reads, 5 * FRAMES * (60 + DISCARDS));
+    HOST_CHECK_EQUAL(BSP_Host_SPI1_Transfers, Host_Lepton_Reads);
+    HOST_CHECK_EQUAL(Host_Lepton_Timeouts, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 0);
+
+    // Every frame complete, the invalid segment of each skipped
+    HOST_CHECK_EQUAL(stats.Frames.Completed, FRAMES);
+    HOST_CHECK_EQUAL(stats.Frames.Torn, 0);
+    HOST_CHECK_EQUAL(stats.Frames.Corrupt_Segments, 0);
+    HOST_CHECK_EQUAL(stats.Frames.Invalid_Segments, FRAMES);
+
+    // Each frame on the panel, every pixel inside it
+    HOST_CHECK_EQUAL(Host_Panel_Pixels, FRAMES * 160 * 120);
+
+    printf("  %u pixels and %u bytes to the panel\n", Host_Panel_Pixels, Host_Panel_Bytes);
+}
+
+int main(void)
+{
+    Host_Test_Scenario("capture: segments in sequence", Test_Capture_Sequence);
+    Host_Test_Scenario("capture: frames on the panel", Test_Capture_Frames);
+
+    return Host_Test_Exit();
+}
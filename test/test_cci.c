@@ -0,0 +1,292 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Lepton CCI
+ * ****************************************************
+ * File:    test_cci.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Requests queued while frames are captured
+ *          run against the simulated camera of
+ *          BSP_host.c and must not cost a frame.
+ ******************************************************/
+
+#include "BSP.h"
+#include "flir_cci.h"
+#include "flir_lepton35.h"
+#include "host_lepton.h"
+#include "host_panel.h"
+#include "host_test.h"
+
+#define FRAMES                          40
+#define DISCARDS                        3
+
+// Requests the camera setup of FLIR_Process() queues
+#define SETUP_COMMANDS                  4
+
+#define UNDEFINED_COMMAND               (FLIR_CCI_SYS + 0x08)
+
+static Host_Lepton_Stats stats;
+
+static void Run(uint32_t frame_count, Host_Lepton_Fault fault)
+{
+    Host_Lepton_Config config = { .Frames = frame_count, .Discards = DISCARDS, .Fault = fault };
+
+    stats = Host_Lepton_Run_On_Panel(&config);
+
+    printf("  %u commands, %u I2C transfers\n", BSP_Host_Lepton_Commands, BSP_Host_I2C_Transfers);
+
+    HOST_CHECK_EQUAL(stats.Frames.Completed, frame_count);
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 0);
+    HOST_CHECK_EQUAL(FLIR_CCI_Pending(), 0);
+}
+
+/******************************************************
+ * Replies
+ *
+ * The queue runs in order, so the replies come in the
+ * order of the requests.
+ ******************************************************/
+typedef struct
+{
+    int8_t Result;
+    uint8_t Words;
+    uint16_t Data[2];
+    uint32_t At_us;
+} Reply;
+
+static Reply replies[8];
+static uint8_t reply_count = 0;
+
+static void On_Reply(int8_t result, const uint16_t *data, uint8_t words)
+{
+    Reply *reply = &replies[reply_count++];
+
+    reply->Result = result;
+    reply->Words = words;
+    reply->Data[0] = words > 0 ? data[0] : 0;
+    reply->Data[1] = words > 1 ? data[1] : 0;
+    reply->At_us = BSP_Host_Time_us;
+}
+
+static uint8_t Not_Acknowledged(uint8_t address, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint8_t rx_len)
+{
+    (void)address;
+    (void)tx;
+    (void)tx_len;
+    (void)rx;
+    (void)rx_len;
+    return 0;
+}
+
+static uint8_t Holding_SCL(uint8_t address, const uint8_t *tx, uint8_t tx_len, uint8_t *rx, uint8_t rx_len)
+{
+    (void)address;
+    (void)tx;
+    (void)tx_len;
+    (void)rx;
+    (void)rx_len;
+    return BSP_HOST_I2C_HELD;
+}
+
+/******************************************************
+ * Requests
+ *
+ * Queued from the stream at a given read, some 80 ms in
+ * and well after the setup is through.
+ ******************************************************/
+#define REQUEST_READ                    1000
+
+static uint8_t queued[5];
+
+static void Round_Trip(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)dst;
+    (void)len;
+    if (read == REQUEST_READ) {
+        HOST_CHECK_EQUAL(FLIR_CCI_Pending(), 0);
+        queued[0] = FLIR_CCI_Run(FLIR_CCI_SYS_PING, On_Reply);
+        queued[1] = FLIR_CCI_Get(FLIR_CCI_SYS_TELEMETRY_ENABLE, 2, On_Reply);
+        queued[2] = FLIR_CCI_Set_Value(FLIR_CCI_SYS_TELEMETRY_ENABLE, 1, On_Reply);
+        queued[3] = FLIR_CCI_Get(FLIR_CCI_SYS_TELEMETRY_ENABLE, 2, On_Reply);
+        queued[4] = FLIR_CCI_Run(FLIR_CCI_SYS_PING, On_Reply);
+    }
+}
+
+static void Errors(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    uint16_t one_word = 1;
+
+    (void)dst;
+    (void)len;
+    if (read == REQUEST_READ) {
+        queued[0] = FLIR_CCI_Run(FLIR_CCI_SYS_RUN_FFC, On_Reply);
+        queued[1] = FLIR_CCI_Get(FLIR_CCI_SYS_UPTIME, 2, On_Reply);
+        queued[2] = FLIR_CCI_Get(UNDEFINED_COMMAND, 2, On_Reply);
+        queued[3] = FLIR_CCI_Set(FLIR_CCI_RAD_ENABLE, &one_word, 1, On_Reply);
+    }
+}
+
+static void Reboot(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)dst;
+    (void)len;
+    if (read == REQUEST_READ) {
+        queued[0] = FLIR_CCI_Get(FLIR_CCI_OEM_VIDEO_OUTPUT_FORMAT, 2, On_Reply);
+        queued[1] = FLIR_CCI_Run(FLIR_CCI_OEM_REBOOT, On_Reply);
+        queued[2] = FLIR_CCI_Get(FLIR_CCI_SYS_FPA_TEMPERATURE, 1, On_Reply);
+    }
+}
+
+static void No_Device(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)dst;
+    (void)len;
+    if (read == REQUEST_READ) {
+        BSP_Host_Set_I2C_Device(Not_Acknowledged);
+        queued[0] = FLIR_CCI_Run(FLIR_CCI_SYS_PING, On_Reply);
+    } else if (read == 2 * REQUEST_READ) {
+        BSP_Host_Set_I2C_Device(BSP_Host_Lepton_CCI);
+        queued[1] = FLIR_CCI_Get(FLIR_CCI_AGC_ENABLE, 2, On_Reply);
+    }
+}
+
+// The camera holds the bus through the first request; the one queued behind it runs once it is given up
+static uint32_t held_at_us;
+
+static void Bus_Held(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)dst;
+    (void)len;
+    if (read == REQUEST_READ) {
+        BSP_Host_Set_I2C_Device(Holding_SCL);
+        held_at_us = BSP_Host_Time_us;
+        queued[0] = FLIR_CCI_Run(FLIR_CCI_SYS_PING, On_Reply);
+    } else if (read == 2 * REQUEST_READ) {
+        BSP_Host_Set_I2C_Device(BSP_Host_Lepton_CCI);
+        queued[1] = FLIR_CCI_Get(FLIR_CCI_AGC_ENABLE, 2, On_Reply);
+    }
+}
+
+/******************************************************
+ * Scenarios
+ ******************************************************/
+static void Test_Setup(void)
+{
+    Run(FRAMES, 0);
+
+    HOST_CHECK_EQUAL(BSP_Host_Lepton_Commands, SETUP_COMMANDS);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+static void Test_Round_Trip(void)
+{
+    Run(FRAMES, Round_Trip);
+
+    // Four in the queue, the fifth is refused
+    HOST_CHECK(queued[0] && queued[1] && queued[2] && queued[3]);
+    HOST_CHECK_EQUAL(queued[4], 0);
+    HOST_CHECK_EQUAL(reply_count, 4);
+
+    HOST_CHECK_EQUAL(replies[0].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(replies[0].Words, 0);
+
+    // Off as the setup left it, then on as set
+    HOST_CHECK_EQUAL(replies[1].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(replies[1].Words, 2);
+    HOST_CHECK_EQUAL(replies[1].Data[0], 0);
+    HOST_CHECK_EQUAL(replies[2].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(replies[2].Words, 0);
+    HOST_CHECK_EQUAL(replies[3].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(replies[3].Data[0], 1);
+    HOST_CHECK_EQUAL(replies[3].Data[1], 0);
+
+    HOST_CHECK_EQUAL(BSP_Host_Lepton_Commands, SETUP_COMMANDS + 4);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+static void Test_Errors(void)
+{
+    uint32_t uptime_ms;
+
+    Run(FRAMES, Errors);
+
+    HOST_CHECK(queued[0] && queued[1] && queued[2] && queued[3]);
+    HOST_CHECK_EQUAL(reply_count, 4);
+
+    HOST_CHECK_EQUAL(replies[0].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(BSP_Host_Lepton_FFCs, 1);
+
+    // Taken once the FFC is through
+    uptime_ms = replies[1].Data[0] | ((uint32_t)replies[1].Data[1] << 16);
+    HOST_CHECK_EQUAL(replies[1].Result, FLIR_CCI_OK);
+    HOST_CHECK(uptime_ms >= replies[0].At_us / 1000);
+    HOST_CHECK(uptime_ms <= replies[1].At_us / 1000);
+
+    HOST_CHECK_EQUAL(replies[2].Result, FLIR_CCI_UNDEFINED_FUNCTION);
+    HOST_CHECK_EQUAL(replies[2].Words, 0);
+    HOST_CHECK_EQUAL(replies[3].Result, FLIR_CCI_DATA_SIZE);
+
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+static void Test_Reboot(void)
+{
+    // The boot takes a second, twice the frames to see it through
+    Run(2 * FRAMES, Reboot);
+
+    HOST_CHECK(queued[0] && queued[1] && queued[2]);
+    HOST_CHECK_EQUAL(reply_count, 3);
+
+    HOST_CHECK_EQUAL(replies[0].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(replies[0].Data[0], 7);
+
+    // Done once written, the next request waits out the boot
+    HOST_CHECK_EQUAL(replies[1].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(replies[2].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(replies[2].Words, 1);
+    HOST_CHECK_EQUAL(replies[2].Data[0], 30000);
+    HOST_CHECK(replies[2].At_us - replies[1].At_us >= 1000000);
+    HOST_CHECK(replies[2].At_us - replies[1].At_us < FLIR_CCI_TIMEOUT_US);
+}
+
+static void Test_No_Device(void)
+{
+    Run(FRAMES, No_Device);
+
+    HOST_CHECK(queued[0] && queued[1]);
+    HOST_CHECK_EQUAL(reply_count, 2);
+
+    HOST_CHECK_EQUAL(replies[0].Result, FLIR_CCI_NO_DEVICE);
+    HOST_CHECK_EQUAL(replies[1].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(replies[1].Data[0], 0);
+
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+static void Test_Bus_Held(void)
+{
+    // The timeout takes two seconds, three times the frames to see it through
+    Run(3 * FRAMES, Bus_Held);
+
+    HOST_CHECK(queued[0] && queued[1]);
+    HOST_CHECK_EQUAL(reply_count, 2);
+    HOST_CHECK_EQUAL(BSP_Host_I2C_Resets, 1);
+
+    HOST_CHECK_EQUAL(replies[0].Result, FLIR_CCI_TIMEOUT);
+    HOST_CHECK(replies[0].At_us - held_at_us >= FLIR_CCI_TIMEOUT_US);
+    HOST_CHECK(replies[0].At_us - held_at_us < FLIR_CCI_TIMEOUT_US + 1000);
+    HOST_CHECK_EQUAL(replies[1].Result, FLIR_CCI_OK);
+    HOST_CHECK_EQUAL(replies[1].Data[0], 0);
+}
+
+int main(void)
+{
+    Host_Test_Scenario("cci: camera setup", Test_Setup);
+    Host_Test_Scenario("cci: set and get round trip", Test_Round_Trip);
+    Host_Test_Scenario("cci: FFC and errors", Test_Errors);
+    Host_Test_Scenario("cci: reboot", Test_Reboot);
+    Host_Test_Scenario("cci: no device", Test_No_Device);
+    Host_Test_Scenario("cci: bus held", Test_Bus_Held);
+
+    return Host_Test_Exit();
+}
@@ -0,0 +1,126 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - VoSPI Packet CRC
+ * ****************************************************
+ * File:    test_crc.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    A packet failing its CRC must cost its
+ *          segment and frame, not the sync, and never
+ *          reach the panel.
+ ******************************************************/
+
+#include "BSP.h"
+#include "flir_lepton35.h"
+#include "flir_kernels.h"
+#include "host_lepton.h"
+#include "host_panel.h"
+#include "host_test.h"
+
+#define FRAMES                          40
+#define DISCARDS                        3
+
+static Host_Lepton_Stats stats;
+
+static void Run(Host_Lepton_Fault fault)
+{
+    Host_Lepton_Config config = { .Frames = FRAMES, .Discards = DISCARDS, .Fault = fault };
+
+    stats = Host_Lepton_Run_On_Panel(&config);
+
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 0);
+}
+
+/******************************************************
+ * Faults
+ *
+ * With 63 packets a segment, read 3000 falls in segment
+ * 3 of frame 9 and read 7001 in segment 2 of frame 22.
+ ******************************************************/
+static void Flip_Payload(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)len;
+    if (read == 3000 || read == 7001) {
+        dst[100] ^= 0x10;
+    }
+}
+
+static void Flip_CRC(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)len;
+    if (read == 3000) {
+        dst[3] ^= 0x01;
+    }
+}
+
+// The end of packet 59 of segment 1 of frame 10
+static void Flip_Last_Packet(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)len;
+    if (read == 10 * 5 * (60 + DISCARDS) + 60) {
+        dst[163] ^= 0x80;
+    }
+}
+
+static void Test_Clean(void)
+{
+    Run(0);
+
+    HOST_CHECK_EQUAL(stats.Frames.Corrupt_Segments, 0);
+    HOST_CHECK_EQUAL(stats.Frames.Completed, FRAMES);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+static void Test_Payload(void)
+{
+    Run(Flip_Payload);
+
+    HOST_CHECK_EQUAL(stats.Frames.Corrupt_Segments, 2);
+    HOST_CHECK_EQUAL(stats.Frames.Torn, 2);
+    HOST_CHECK_EQUAL(stats.Frames.Completed, FRAMES - 2);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+static void Test_CRC_Field(void)
+{
+    Run(Flip_CRC);
+
+    HOST_CHECK_EQUAL(stats.Frames.Corrupt_Segments, 1);
+    HOST_CHECK_EQUAL(stats.Frames.Completed, FRAMES - 1);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+static void Test_Last_Packet(void)
+{
+    Run(Flip_Last_Packet);
+
+    // The frame never starts, its other segments continue none
+    HOST_CHECK_EQUAL(stats.Frames.Corrupt_Segments, 1);
+    HOST_CHECK_EQUAL(stats.Frames.Dropped_Segments, 3);
+    HOST_CHECK_EQUAL(stats.Frames.Completed, FRAMES - 1);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+/******************************************************
+ * Cost per Segment
+ ******************************************************/
+static void Test_Benchmark(void)
+{
+    uint32_t cycles_bitwise, cycles_sliced;
+
+    FLIR_Kernel_Benchmark_CRC(&cycles_bitwise, &cycles_sliced);
+
+    // Host cycles, only the target figures are meaningful
+    printf("  60 packets: bitwise %u, sliced %u cycles\n", cycles_bitwise, cycles_sliced);
+}
+
+int main(void)
+{
+    Host_Test_Scenario("crc: clean stream", Test_Clean);
+    Host_Test_Scenario("crc: payload bit flips", Test_Payload);
+    Host_Test_Scenario("crc: CRC field bit flip", Test_CRC_Field);
+    Host_Test_Scenario("crc: last packet of a segment", Test_Last_Packet);
+    Host_Test_Scenario("crc: benchmark", Test_Benchmark);
+
+    return Host_Test_Exit();
+}
@@ -0,0 +1,411 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Frames on the Panel
+ * ****************************************************
+ * File:    test_frames.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Built for each frame configuration in
+ *          test/Makefile: streaming, buffered and
+ *          scanline rendering, delta and indexed frames,
+ *          every display bus, with or without CRC,
+ *          repeat skipping and CCI must leave the same
+ *          picture, and so must the three pipelines
+ *          upscaled. The HUD, range smoothing and the
+ *          views change it the way they should.
+ ******************************************************/
+
+#include "BSP.h"
+#include "flir_lepton35.h"
+#include "host_lepton.h"
+#include "host_panel.h"
+#include "host_test.h"
+#include "tft_st7789.h"
+#include <stdlib.h>
+#include <string.h>
+
+extern uint16_t _xstart, _ystart;
+
+#define FRAMES                          10      // The last one new: a repeat keeps the colours of its first showing
+#define REPEATS                         3       // As a Lepton 3.5 sends them
+#define DISCARDS                        3
+#define NEW_FRAMES                      ((FRAMES + REPEATS - 1) / REPEATS)
+
+// Panel bytes of the noskip configuration, sending every repeat in full
+#define NOSKIP_BYTES                    384266
+
+#ifdef FLIR_CONFIG_UPSCALE
+// Whether sent whole, by segment or by group: the same picture, 2.25 times the pixels
+#define PANEL_HASH                      0xC2BAF4B4
+#define PANEL_BYTES(bytes)              ((bytes) * 9 / 4)
+#else
+#define PANEL_HASH                      HOST_LEPTON_PANEL_HASH
+#define PANEL_BYTES(bytes)              (bytes)
+#endif
+
+/******************************************************
+ * Expected Picture
+ *
+ * Each frame is colorized with the range measured on
+ * the frame before it, smoothed with
+ * FLIR_CONFIG_AGC_SMOOTHING, and repeats skipped leave
+ * the range as it was. Pixels the range maps to one
+ * palette index must share a colour on the panel; the
+ * other way round does not hold, palette entries may be
+ * the same in RGB565.
+ ******************************************************/
+#define PALETTE_SIZE                    256
+#define START_MIN                       30000   // The range of the driver before the first frame
+#define START_MAX                       32000
+
+static void Scene_Range(uint32_t image, uint16_t *min, uint16_t *max)
+{
+    *min = 65535;
+    *max = 0;
+
+    for (int row = 0; row < 120; row++) {
+        for (int col = 0; col < 160; col++) {
+            uint16_t value = Host_Lepton_Pixel(image, row, col);
+
+            *min = (value < *min) ? value : *min;
+            *max = (value > *max) ? value : *max;
+        }
+    }
+}
+
+// The range the last of a run's frames is colorized with
+static void Applied_Range(uint32_t frames, uint8_t repeats, uint16_t *min, uint16_t *max)
+{
+    uint16_t scene_min, scene_max;
+#ifdef FLIR_CONFIG_AGC_SMOOTHING
+    int32_t min_q8 = (int32_t)START_MIN << 8;
+    int32_t max_q8 = (int32_t)START_MAX << 8;
+#endif
+
+    *min = START_MIN;
+    *max = START_MAX;
+
+    for (uint32_t frame = 0; frame + 1 < frames; frame++) {
+#ifdef FLIR_CONFIG_SKIP_REPEATS
+        if (frame % repeats) {
+            continue;
+        }
+#endif
+        Scene_Range(frame / repeats, &scene_min, &scene_max);
+
+#ifdef FLIR_CONFIG_AGC_SMOOTHING
+        min_q8 += (((int32_t)scene_min << 8) - min_q8) >> FLIR_CONFIG_AGC_SMOOTHING;
+        max_q8 += (((int32_t)scene_max << 8) - max_q8) >> FLIR_CONFIG_AGC_SMOOTHING;
+        *min = (uint16_t)(min_q8 >> 8);
+        *max = (uint16_t)((max_q8 + 255) >> 8);
+#else
+        *min = scene_min;
+        *max = scene_max;
+#endif
+    }
+}
+
+// Pixels of the panel area not showing the image through the range
+static uint32_t Picture_Failures(uint32_t image, uint16_t min, uint16_t max, int row0, int rows, int col0, int cols)
+{
+    int32_t color_of[PALETTE_SIZE];
+    uint32_t failures = 0;
+
+    memset(color_of, 0xFF, sizeof(color_of));
+
+    for (int row = row0; row < row0 + rows; row++) {
+        for (int col = col0; col < col0 + cols; col++) {
+            uint16_t value = Host_Lepton_Pixel(image, row, col);
+            uint16_t color = Host_Panel[_ystart + row][_xstart + col];
+            int index = PALETTE_SIZE - 1;
+
+            if (value <= min) {
+                index = 0;
+            } else if (value < max) {
+                index = (value - min) * (PALETTE_SIZE - 1) / (max - min);
+            }
+
+            if (color_of[index] < 0) {
+                color_of[index] = color;
+            }
+
+            failures += (color_of[index] != color);
+        }
+    }
+
+    return failures;
+}
+
+static void Test_Frames(void)
+{
+    Host_Lepton_Config config = { .Frames = FRAMES, .Discards = DISCARDS, .Repeats = REPEATS };
+    Host_Lepton_Stats stats = Host_Lepton_Run_On_Panel(&config);
+    uint16_t min, max;
+
+    HOST_CHECK_EQUAL(Host_Lepton_Reads, 5 * FRAMES * (60 + DISCARDS));
+    HOST_CHECK_EQUAL(Host_Lepton_Timeouts, 0);
+    HOST_CHECK_EQUAL(stats.Frames.Completed, FRAMES);
+    HOST_CHECK_EQUAL(stats.Frames.Torn, 0);
+    HOST_CHECK_EQUAL(stats.Frames.Dropped_Segments, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 0);
+
+    Applied_Range(FRAMES, REPEATS, &min, &max);
+    printf("  image %u in %u..%u\n", (FRAMES - 1) / REPEATS, min, max);
+
+#if defined(FLIR_CONFIG_UPSCALE)
+    // Frame pixels no longer map one to one on the panel, the hash stands for them
+#elif defined(FLIR_CONFIG_HUD)
+    // Rows clear of the overlay
+    HOST_CHECK_EQUAL(Picture_Failures((FRAMES - 1) / REPEATS, min, max, 70, 16, 0, 150), 0);
+#else
+    HOST_CHECK_EQUAL(Picture_Failures((FRAMES - 1) / REPEATS, min, max, 0, 120, 0, 160), 0);
+#endif
+
+#if defined(FLIR_CONFIG_HUD) || defined(FLIR_CONFIG_AGC_SMOOTHING)
+    HOST_CHECK(Host_Panel_Hash() != PANEL_HASH);
+#else
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), PANEL_HASH);
+#endif
+
+#ifdef FLIR_CONFIG_SKIP_REPEATS
+    // Repeats neither colorized nor sent: well under half the bytes whatever the bus or pipeline
+    HOST_CHECK_EQUAL(stats.Frames.Repeated, FRAMES - NEW_FRAMES);
+    HOST_CHECK(Host_Panel_Bytes < PANEL_BYTES(NOSKIP_BYTES) / 2);
+#else
+    HOST_CHECK_EQUAL(stats.Frames.Repeated, 0);
+    HOST_CHECK_EQUAL(Host_Panel_Bytes, NOSKIP_BYTES);
+#endif
+
+    printf("  %u bytes to the panel\n", Host_Panel_Bytes);
+}
+
+#ifdef FLIR_CONFIG_HUD
+/******************************************************
+ * HUD
+ *
+ * On the last frame of the run: the crosshair on the
+ * centre, the hottest pixel framed in red and the first
+ * of the coldest in blue, both where the frame before
+ * had them, the spot temperature printed top left and
+ * the colour bar from the hottest colour down to the
+ * coldest.
+ ******************************************************/
+#define HOT_ROW                         40      // Where Host_Lepton_Pixel() puts it
+#define HOT_COL                         100
+#define MARKER_RADIUS                   3
+#define CROSSHAIR_ARM                   8
+#define BAR_X                           (160 - 6 - 2)
+#define BAR_TOP                         12
+#define BAR_BOTTOM                      (120 - 12 - 1)
+
+static uint16_t Panel_At(int x, int y)
+{
+    return Host_Panel[_ystart + y][_xstart + x];
+}
+
+static uint32_t Panel_Count(int x, int y, int width, int height, uint16_t color)
+{
+    uint32_t count = 0;
+
+    for (int row = y; row < y + height; row++) {
+        for (int col = x; col < x + width; col++) {
+            count += (Panel_At(col, row) == color);
+        }
+    }
+
+    return count;
+}
+
+// The marker square around a frame pixel, as far as it is on the frame: all of it in the colour, nothing else
+static void Check_Marker(int x, int y, uint16_t color)
+{
+    uint32_t border = 0, marked = 0;
+
+    for (int row = y - MARKER_RADIUS; row <= y + MARKER_RADIUS; row++) {
+        for (int col = x - MARKER_RADIUS; col <= x + MARKER_RADIUS; col++) {
+            if ((row < 0) || (row >= 120) || (col < 0) || (col >= 160) ||
+                ((abs(row - y) < MARKER_RADIUS) && (abs(col - x) < MARKER_RADIUS))) {
+                continue;
+            }
+
+            border++;
+            marked += (Panel_At(col, row) == color);
+        }
+    }
+
+    HOST_CHECK(border > 0);
+    HOST_CHECK_EQUAL(marked, border);
+    HOST_CHECK_EQUAL(Panel_Count(0, 0, 160, 120, color), border);
+}
+
+static void Test_Hud(void)
+{
+    Host_Lepton_Config config = { .Frames = FRAMES, .Discards = DISCARDS, .Repeats = REPEATS };
+    uint32_t image = (FRAMES - 1) / REPEATS - 1;
+    uint16_t hottest, coldest, min, max;
+    int cold_x = -1, cold_y = -1;
+
+    Host_Lepton_Run_On_Panel(&config);
+
+    // Crosshair arms, the centre left clear
+    HOST_CHECK_EQUAL(Panel_At(80 - CROSSHAIR_ARM, 60), TFT_COLOR_WHITE);
+    HOST_CHECK_EQUAL(Panel_At(80 + CROSSHAIR_ARM, 60), TFT_COLOR_WHITE);
+    HOST_CHECK_EQUAL(Panel_At(80, 60 - CROSSHAIR_ARM), TFT_COLOR_WHITE);
+    HOST_CHECK_EQUAL(Panel_At(80, 60 + CROSSHAIR_ARM), TFT_COLOR_WHITE);
+    HOST_CHECK(Panel_At(80, 60) != TFT_COLOR_WHITE);
+
+    // The extremes of the frame before, the coldest as first met row by row
+    Scene_Range(image, &min, &max);
+    for (int row = 0; (row < 120) && (cold_x < 0); row++) {
+        for (int col = 0; (col < 160) && (cold_x < 0); col++) {
+            if (Host_Lepton_Pixel(image, row, col) == min) {
+                cold_x = col;
+                cold_y = row;
+            }
+        }
+    }
+
+    HOST_CHECK_EQUAL(Host_Lepton_Pixel(image, HOT_ROW, HOT_COL), max);
+    Check_Marker(HOT_COL, HOT_ROW, TFT_COLOR_RED);
+    Check_Marker(cold_x, cold_y, TFT_COLOR_BLUE);
+
+    // Spot temperature, white on black
+    HOST_CHECK(Panel_Count(2, 2, 30, 8, TFT_COLOR_WHITE) > 20);
+    HOST_CHECK(Panel_Count(2, 2, 30, 8, TFT_COLOR_BLACK) > 100);
+
+    // The bar runs through the palette: the hot spot at the top, the coldest colour at the bottom
+    hottest = Panel_At(HOT_COL, HOT_ROW);
+    coldest = Panel_At(BAR_X, BAR_BOTTOM);
+    HOST_CHECK_EQUAL(Panel_At(BAR_X, BAR_TOP), hottest);
+    HOST_CHECK_EQUAL(Panel_Count(BAR_X, BAR_TOP, 6, 1, hottest), 6);
+    HOST_CHECK_EQUAL(Panel_Count(BAR_X, BAR_BOTTOM, 6, 1, coldest), 6);
+    HOST_CHECK(Panel_Count(0, 0, BAR_X, 120, coldest) > 0);
+}
+#endif
+
+#if defined(FLIR_CONFIG_INDEXED) && !defined(FLIR_CONFIG_SCANLINE)
+/******************************************************
+ * Views
+ *
+ * A view requested while frame VIEW_FRAME comes in
+ * applies once it is complete. Each new frame moves the
+ * scene, so the held frame shows as the image it was.
+ ******************************************************/
+#define VIEW_FRAMES                     8
+#define VIEW_FRAME                      3
+#define VIEW_READS                      (5 * (60 + DISCARDS))   // Per frame
+
+static uint8_t view_next, view_age;
+
+static void View_Request(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)dst;
+    (void)len;
+
+    if (read == VIEW_FRAME * VIEW_READS + 1) {
+        FLIR_Set_View(view_next, view_age);
+    }
+}
+
+static void Run_View(uint8_t view, uint8_t age)
+{
+    Host_Lepton_Config config = { .Frames = VIEW_FRAMES, .Discards = DISCARDS, .Repeats = 1, .Fault = View_Request };
+    Host_Lepton_Stats stats;
+
+    view_next = view;
+    view_age = age;
+    stats = Host_Lepton_Run_On_Panel(&config);
+
+    HOST_CHECK_EQUAL(stats.Frames.Completed, VIEW_FRAMES);
+}
+
+// The range of an image of a run with one frame per image
+static void Image_Range(uint32_t image, uint16_t *min, uint16_t *max)
+{
+    Applied_Range(image + 1, 1, min, max);
+}
+
+static void Test_View_Freeze(void)
+{
+    uint16_t min, max;
+
+    Run_View(FLIR_VIEW_FREEZE, 0);
+
+    Image_Range(VIEW_FRAME, &min, &max);
+    HOST_CHECK_EQUAL(Picture_Failures(VIEW_FRAME, min, max, 0, 120, 0, 160), 0);
+    Image_Range(VIEW_FRAMES - 1, &min, &max);
+    HOST_CHECK(Picture_Failures(VIEW_FRAMES - 1, min, max, 0, 120, 0, 160) > 0);
+}
+
+static void Test_View_Compare(void)
+{
+    uint16_t min, max;
+
+    // The frame before the one completed, the live one on the left
+    Run_View(FLIR_VIEW_COMPARE, 1);
+
+    Image_Range(VIEW_FRAMES - 1, &min, &max);
+    HOST_CHECK_EQUAL(Picture_Failures(VIEW_FRAMES - 1, min, max, 0, 120, 0, 80), 0);
+    Image_Range(VIEW_FRAME - 1, &min, &max);
+    HOST_CHECK_EQUAL(Picture_Failures(VIEW_FRAME - 1, min, max, 0, 120, 80, 80), 0);
+}
+
+static void Test_View_Live(void)
+{
+    uint16_t min, max;
+
+    // Nothing held: the live frames go on as they were
+    Run_View(FLIR_VIEW_LIVE, 0);
+
+    Image_Range(VIEW_FRAMES - 1, &min, &max);
+    HOST_CHECK_EQUAL(Picture_Failures(VIEW_FRAMES - 1, min, max, 0, 120, 0, 160), 0);
+}
+#endif
+
+#if defined(FLIR_CONFIG_SCANLINE) && !defined(FLIR_CONFIG_UPSCALE)
+/******************************************************
+ * Slow Panel
+ *
+ * A panel taking far longer per row than the Lepton
+ * sends one fills the scanline ring: the segments cut
+ * short are dropped, the stream stays in sync. The
+ * upscaler sends a group before it returns, with the
+ * packets of a line ring freed by then: the segment
+ * ends before the ring can fill.
+ ******************************************************/
+#define SLOW_PANEL_BYTE_NS              2000
+
+static void Test_Slow_Panel(void)
+{
+    Host_Lepton_Config config = { .Frames = FRAMES, .Discards = DISCARDS, .Repeats = REPEATS };
+    Host_Lepton_Stats stats;
+
+    BSP_Host_TFT_Byte_ns = SLOW_PANEL_BYTE_NS;
+    stats = Host_Lepton_Run_On_Panel(&config);
+    BSP_Host_TFT_Byte_ns = 0;
+
+    HOST_CHECK_EQUAL(Host_Lepton_Timeouts, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 0);
+    HOST_CHECK(stats.Frames.Dropped_Segments > 0);
+
+    printf("  %u segments dropped\n", stats.Frames.Dropped_Segments);
+}
+#endif
+
+int main(void)
+{
+    Host_Test_Scenario("frames", Test_Frames);
+#ifdef FLIR_CONFIG_HUD
+    Host_Test_Scenario("hud", Test_Hud);
+#endif
+#if defined(FLIR_CONFIG_INDEXED) && !defined(FLIR_CONFIG_SCANLINE)
+    Host_Test_Scenario("views: freeze", Test_View_Freeze);
+    Host_Test_Scenario("views: compare", Test_View_Compare);
+    Host_Test_Scenario("views: live", Test_View_Live);
+#endif
+#if defined(FLIR_CONFIG_SCANLINE) && !defined(FLIR_CONFIG_UPSCALE)
+    Host_Test_Scenario("scanline: slow panel", Test_Slow_Panel);
+#endif
+
+    return Host_Test_Exit();
+}
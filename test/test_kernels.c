@@ -0,0 +1,85 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - Pixel Kernels
+ * ****************************************************
+ * File:    test_kernels.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Runs the kernel self-test and benchmarks. On
+ *          the host the DSP kernel is its C model; the
+ *          same calls verify the MIPS DSP build when
+ *          made from the target.
+ ******************************************************/
+
+#include "BSP.h"
+#include "flir_kernels.h"
+#include "host_test.h"
+
+static void Test_Kernel_Self_Test(void)
+{
+    HOST_CHECK_EQUAL(FLIR_Kernel_Self_Test(), 0);
+}
+
+// CRC-16-CCITT, zero initial value, of "123456789"
+static void Test_Kernel_CRC_Check_Value(void)
+{
+    static const uint8_t check[] = "123456789";
+
+    FLIR_Kernel_CRC_Initialize();
+
+    HOST_CHECK_EQUAL(FLIR_Kernel_CRC_Bitwise(check, 9, 0), 0x31C3);
+    HOST_CHECK_EQUAL(FLIR_Kernel_CRC_Sliced(check, 9, 0), 0x31C3);
+
+    // In two parts, as the packet check chains the header and the payload
+    HOST_CHECK_EQUAL(FLIR_Kernel_CRC_Sliced(check + 4, 5, FLIR_Kernel_CRC_Sliced(check, 4, 0)), 0x31C3);
+}
+
+// A zero pixel ends the packet, in both kernels
+static void Test_Kernel_Zero_Pixel(void)
+{
+    uint8_t packet[FLIR_KERNEL_HEADER_SIZE + 2 * FLIR_KERNEL_PIXELS] __attribute__((aligned(4))) = { 0 };
+    uint16_t indices_c[FLIR_KERNEL_PIXELS];
+    uint16_t indices_dsp[FLIR_KERNEL_PIXELS];
+    FLIR_Kernel_Params params = { .Base = 29000, .Limit = 1023, .Mul = 0, .Shift = 2 };
+    FLIR_Kernel_Range range_c = { 65535, 0 };
+    FLIR_Kernel_Range range_dsp = { 65535, 0 };
+
+    for (int i = 0; i < 37; i++) {
+        uint16_t value = 29000 + 97 * i;
+
+        packet[FLIR_KERNEL_HEADER_SIZE + 2 * i] = value >> 8;
+        packet[FLIR_KERNEL_HEADER_SIZE + 2 * i + 1] = value;
+    }
+
+    HOST_CHECK_EQUAL(FLIR_Kernel_Packet_C(packet, indices_c, &params, &range_c), 37);
+    HOST_CHECK_EQUAL(FLIR_Kernel_Packet_DSP(packet, indices_dsp, &params, &range_dsp), 37);
+    HOST_CHECK_EQUAL(range_c.Min, 29000);
+    HOST_CHECK_EQUAL(range_c.Max, 29000 + 97 * 36);
+    HOST_CHECK_EQUAL(range_dsp.Min, range_c.Min);
+    HOST_CHECK_EQUAL(range_dsp.Max, range_c.Max);
+
+    for (int i = 0; i < 37; i++) {
+        HOST_CHECK_EQUAL(indices_dsp[i], indices_c[i]);
+    }
+}
+
+static void Test_Kernel_Benchmarks(void)
+{
+    uint32_t cycles_c, cycles_dsp, cycles_bitwise, cycles_sliced;
+
+    FLIR_Kernel_Benchmark(&cycles_c, &cycles_dsp);
+    FLIR_Kernel_Benchmark_CRC(&cycles_bitwise, &cycles_sliced);
+
+    // Host cycles, only the target figures are meaningful
+    printf("  kernel, 60 packets: C %u, DSP %u cycles\n", cycles_c, cycles_dsp);
+    printf("  CRC, 60 packets: bitwise %u, sliced %u cycles\n", cycles_bitwise, cycles_sliced);
+}
+
+int main(void)
+{
+    Host_Test_Scenario("kernels: self-test", Test_Kernel_Self_Test);
+    Host_Test_Scenario("kernels: CRC check value", Test_Kernel_CRC_Check_Value);
+    Host_Test_Scenario("kernels: zero pixel", Test_Kernel_Zero_Pixel);
+    Host_Test_Scenario("kernels: benchmarks", Test_Kernel_Benchmarks);
+
+    return Host_Test_Exit();
+}
@@ -0,0 +1,162 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - VoSPI Resynchronization
+ * ****************************************************
+ * File:    test_resync.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Replays the simulated Lepton stream with
+ *          packets lost, a packet number corrupted and
+ *          bytes slipped. Capture has to find the stream
+ *          again and end on the same picture as the clean
+ *          run, idling only when restarts cannot help.
+ ******************************************************/
+
+#include "BSP.h"
+#include "flir_lepton35.h"
+#include "host_lepton.h"
+#include "host_panel.h"
+#include "host_test.h"
+
+#define FRAMES                          40
+#define DISCARDS                        3
+
+static Host_Lepton_Stats stats;
+
+static void Run(uint32_t n_frames, uint16_t discards, Host_Lepton_Fault fault)
+{
+    Host_Lepton_Config config = { .Frames = n_frames, .Discards = discards, .Fault = fault };
+
+    stats = Host_Lepton_Run_On_Panel(&config);
+}
+
+/******************************************************
+ * Clean Streams
+ ******************************************************/
+static void Test_Clean(void)
+{
+    Run(FRAMES, DISCARDS, 0);
+
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 0);
+    HOST_CHECK_EQUAL(stats.Frames.Completed, FRAMES);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+// Discard packets are skipped, however many
+static void Test_Many_Discards(void)
+{
+    Run(FRAMES, 400, 0);
+
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 0);
+    HOST_CHECK_EQUAL(stats.Sync.Discards, 400 * 5 * FRAMES);
+    HOST_CHECK_EQUAL(stats.Frames.Completed, FRAMES);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+/******************************************************
+ * Faults
+ ******************************************************/
+static void Lose_Packet(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)dst;
+    if (read == 2000) {
+        Host_Lepton_Skip(len);
+    }
+}
+
+static void Corrupt_Number(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)len;
+    if (read == 4000) {
+        dst[1] ^= 0x04;
+    }
+}
+
+static void Slip(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)dst;
+    (void)len;
+    if (read == 6000) {
+        Host_Lepton_Skip(3);
+    }
+}
+
+static void Slip_Repeatedly(uint32_t read, uint8_t *dst, uint16_t len)
+{
+    (void)dst;
+    (void)len;
+    // Each after the stream is found again, about 40 ms of hunting and an idle period on
+    if (read == 3000 || read == 4000 || read == 5000) {
+        Host_Lepton_Skip(5);
+    }
+}
+
+// A packet gone: restarting at packet 0 finds the next segment, no idling
+static void Test_Lost_Packet(void)
+{
+    Run(FRAMES, DISCARDS, Lose_Packet);
+
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 1);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 0);
+    HOST_CHECK(stats.Frames.Torn > 0);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+static void Test_Corrupt_Number(void)
+{
+    Run(FRAMES, DISCARDS, Corrupt_Number);
+
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 1);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 0);
+    HOST_CHECK(stats.Frames.Torn > 0);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+// Out of packet alignment: only the Lepton restarting its stream after an idle period helps
+static void Test_Slip(void)
+{
+    Run(FRAMES, DISCARDS, Slip);
+
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 1);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 1);
+    HOST_CHECK_EQUAL(Host_Lepton_Timeouts, 1);
+    HOST_CHECK(stats.Sync.Longest_us >= 200000);
+    HOST_CHECK_EQUAL(stats.Sync.Idle_ms, 200);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+}
+
+// Each idle period needed again soon doubles the next, good segments halve it back
+static void Test_Slips_Back_Off(void)
+{
+    Run(FRAMES, DISCARDS, Slip_Repeatedly);
+
+    HOST_CHECK_EQUAL(stats.Sync.Losses, 3);
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 3);
+    HOST_CHECK_EQUAL(Host_Panel_Hash(), HOST_LEPTON_PANEL_HASH);
+
+    // 200, 400 then 800 ms, halved once by the segments since
+    HOST_CHECK(stats.Sync.Longest_us >= 800000 && stats.Sync.Longest_us < 1000000);
+    HOST_CHECK_EQUAL(stats.Sync.Idle_ms, 400);
+}
+
+static void Test_Slips_Recovery(void)
+{
+    Run(FRAMES + 60, DISCARDS, Slip_Repeatedly);
+
+    HOST_CHECK_EQUAL(stats.Sync.Idles, 3);
+    HOST_CHECK_EQUAL(stats.Sync.Idle_ms, 200);
+}
+
+int main(void)
+{
+    Host_Test_Scenario("resync: clean stream", Test_Clean);
+    Host_Test_Scenario("resync: 400 discard packets a segment", Test_Many_Discards);
+    Host_Test_Scenario("resync: lost packet", Test_Lost_Packet);
+    Host_Test_Scenario("resync: corrupt packet number", Test_Corrupt_Number);
+    Host_Test_Scenario("resync: byte slip", Test_Slip);
+    Host_Test_Scenario("resync: repeated slips back off", Test_Slips_Back_Off);
+    Host_Test_Scenario("resync: idle period recovers", Test_Slips_Recovery);
+
+    return Host_Test_Exit();
+}
@@ -0,0 +1,653 @@
+/******************************************************
+ * NOCTIX-1 Host Tests - TFT Primitives
+ * ****************************************************
+ * File:    test_tft.c
+ * Date:    17.10.2026
+ * Author:  Victor Huerlimann, Ribes Microsystems
+ * Note:    Each primitive must leave the panel as the
+ *          per-pixel drawing did, in the bytes counted
+ *          on SPI2 when it was rasterized into spans.
+ *          The bilinear upscaler must stay near a float
+ *          reference and leave no seam between strips.
+ *          Delta rendering must count the tiles and
+ *          bytes that reach the panel, and send the
+ *          tiles a HUD item leaves or enters.
+ ******************************************************/
+
+#include "BSP.h"
+#include "host_panel.h"
+#include "host_test.h"
+#include <stdlib.h>
+#include <string.h>
+
+void __tft_draw_pixel(int16_t x, int16_t y, uint16_t color);
+void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color);
+
+extern uint16_t _xstart, _ystart;
+
+#define TFT_WIDTH                       240
+#define TFT_HEIGHT                      240
+
+/******************************************************
+ * Reference Drawing
+ *
+ * The primitives as they were before the spans, one
+ * clipped pixel at a time, into a panel of their own
+ * with the window at the same offset.
+ ******************************************************/
+static uint16_t reference[HOST_PANEL_HEIGHT][HOST_PANEL_WIDTH];
+
+static void Reference_Pixel(int16_t x, int16_t y, uint16_t color)
+{
+    if (x >= 0 && x < TFT_WIDTH && y >= 0 && y < TFT_HEIGHT) {
+        reference[y + _ystart][x + _xstart] = color;
+    }
+}
+
+static void Reference_Fill_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    for (int16_t i = x; i < x + w; i++) {
+        for (int16_t j = y; j < y + h; j++) {
+            Reference_Pixel(i, j, color);
+        }
+    }
+}
+
+// Bresenham, stepping along the longer axis
+static void Reference_Line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    int16_t steep = abs(y1 - y0) > abs(x1 - x0);
+    int16_t t, dx, dy, err, ystep;
+
+    if (steep) {
+        t = x0; x0 = y0; y0 = t;
+        t = x1; x1 = y1; y1 = t;
+    }
+    if (x0 > x1) {
+        t = x0; x0 = x1; x1 = t;
+        t = y0; y0 = y1; y1 = t;
+    }
+
+    dx = x1 - x0;
+    dy = abs(y1 - y0);
+    err = dx / 2;
+    ystep = (y0 < y1) ? 1 : -1;
+
+    for (; x0 <= x1; x0++) {
+        if (steep) {
+            Reference_Pixel(y0, x0, color);
+        } else {
+            Reference_Pixel(x0, y0, color);
+        }
+        err -= dy;
+        if (err < 0) {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+}
+
+static void Reference_Rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    Reference_Line(x, y, x + w, y, color);
+    Reference_Line(x + w, y, x + w, y + h, color);
+    Reference_Line(x + w, y + h, x, y + h, color);
+    Reference_Line(x, y + h, x, y, color);
+}
+
+static void Reference_Circle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    int16_t f = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+
+    Reference_Pixel(x0, y0 + r, color);
+    Reference_Pixel(x0, y0 - r, color);
+    Reference_Pixel(x0 + r, y0, color);
+    Reference_Pixel(x0 - r, y0, color);
+
+    while (x < y) {
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+
+        Reference_Pixel(x0 + x, y0 + y, color);
+        Reference_Pixel(x0 - x, y0 + y, color);
+        Reference_Pixel(x0 + x, y0 - y, color);
+        Reference_Pixel(x0 - x, y0 - y, color);
+        Reference_Pixel(x0 + y, y0 + x, color);
+        Reference_Pixel(x0 - y, y0 + x, color);
+        Reference_Pixel(x0 + y, y0 - x, color);
+        Reference_Pixel(x0 - y, y0 - x, color);
+    }
+}
+
+// Upper half, columns from each octant point up to the centre row
+static void Reference_Half_Circle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
+{
+    int16_t f = 1 - r;
+    int16_t ddF_x = 1;
+    int16_t ddF_y = -2 * r;
+    int16_t x = 0;
+    int16_t y = r;
+    int16_t px = x;
+    int16_t py = y;
+
+    Reference_Fill_Rect(x0, y0 - r, 1, r + 1, color);
+
+    while (x < y) {
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+
+        if (x < y + 1) {
+            Reference_Fill_Rect(x0 + x, y0 - y, 1, y + 1, color);
+            Reference_Fill_Rect(x0 - x, y0 - y, 1, y + 1, color);
+        }
+        if (y != py) {
+            Reference_Fill_Rect(x0 + py, y0 - px, 1, px + 1, color);
+            Reference_Fill_Rect(x0 - py, y0 - px, 1, px + 1, color);
+            py = y;
+        }
+        px = x;
+    }
+}
+
+/******************************************************
+ * Primitives
+ *
+ * Before is what the per-pixel drawing sent on SPI2, a
+ * window and CS toggle per pixel or column, and for text
+ * what it sent a pixel at a time before the glyph cells;
+ * after is what is sent now and must not grow, each
+ * primitive on its own after tft_init(), so with no
+ * window cached. Text has no reference drawing: its
+ * panel is checked by hash.
+ ******************************************************/
+typedef struct
+{
+    const char *Name;
+    void (*Draw)(void);
+    void (*Reference)(void);
+    uint32_t Before;
+    uint32_t After;
+    uint32_t Hash;              // Of the panel, when there is no reference
+} Primitive;
+
+static void Draw_Fill_Rect(void) { tft_fill_rect(10, 20, 100, 50, 0x1234); }
+static void Ref_Fill_Rect(void) { Reference_Fill_Rect(10, 20, 100, 50, 0x1234); }
+static void Draw_Fill_Clipped(void) { tft_fill_rect(-10, 200, 300, 100, 0x4321); }
+static void Ref_Fill_Clipped(void) { Reference_Fill_Rect(-10, 200, 300, 100, 0x4321); }
+static void Draw_Fill_Screen(void) { tft_fill_screen(0xF00F); }
+static void Ref_Fill_Screen(void) { Reference_Fill_Rect(0, 0, TFT_WIDTH, TFT_HEIGHT, 0xF00F); }
+static void Draw_Line(void) { tft_draw_line(0, 0, 200, 60, 0xFFFF); }
+static void Ref_Line(void) { Reference_Line(0, 0, 200, 60, 0xFFFF); }
+static void Draw_Line_Steep(void) { tft_draw_line(5, 10, 35, 210, 0xFFFF); }
+static void Ref_Line_Steep(void) { Reference_Line(5, 10, 35, 210, 0xFFFF); }
+static void Draw_Line_45(void) { tft_draw_line(0, 0, 100, 100, 0xFFFF); }
+static void Ref_Line_45(void) { Reference_Line(0, 0, 100, 100, 0xFFFF); }
+static void Draw_Line_Clipped(void) { tft_draw_line(-50, -20, 300, 250, 0xFFFF); }
+static void Ref_Line_Clipped(void) { Reference_Line(-50, -20, 300, 250, 0xFFFF); }
+static void Draw_Rect(void) { tft_draw_rect(10, 10, 100, 60, 0xFFFF); }
+static void Ref_Rect(void) { Reference_Rect(10, 10, 100, 60, 0xFFFF); }
+static void Draw_Circle(void) { drawCircle(120, 120, 50, 0x07E0); }
+static void Ref_Circle(void) { Reference_Circle(120, 120, 50, 0x07E0); }
+static void Draw_Circle_Clipped(void) { drawCircle(10, 120, 50, 0x07E0); }
+static void Ref_Circle_Clipped(void) { Reference_Circle(10, 120, 50, 0x07E0); }
+static void Draw_Half_Circle(void) { tft_fill_half_circle(120, 120, 40, 0x001F); }
+static void Ref_Half_Circle(void) { Reference_Half_Circle(120, 120, 40, 0x001F); }
+static void Draw_Pixel(void) { __tft_draw_pixel(3, 4, 0xAAAA); }
+static void Ref_Pixel(void) { Reference_Pixel(3, 4, 0xAAAA); }
+
+static void Draw_Text(void)
+{
+    tft_set_cursor(0, 0);
+    tft_set_text_bg_color(0xFFFF, 0);
+    tft_printf("Hello 42");
+}
+
+static void Draw_Text_Transparent(void)
+{
+    tft_set_cursor(0, 0);
+    tft_set_text_color(0xFFFF);
+    tft_printf("Hello 42");
+}
+
+static void Draw_Text_Size_2(void)
+{
+    tft_set_cursor(0, 0);
+    tft_set_text_bg_color(0xFFFF, 0);
+    tft_set_text_size(2);
+    tft_printf("Hi");
+}
+
+static void Draw_Text_Wrapped(void)
+{
+    tft_set_cursor(0, 180);
+    tft_set_text_bg_color(0xFFFF, 0);
+    tft_printf("%u.%u fps  SPI2 saved %u%%  range %u..%u  ", 8, 7, 93, 29000, 31000);
+}
+
+static void Draw_Text_Size_3(void)
+{
+    tft_set_cursor(0, 0);
+    tft_set_text_bg_color(0x07E0, 0);
+    tft_set_text_size(3);
+    tft_printf("ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789");
+}
+
+static const Primitive primitives[] = {
+    { "fill_rect 100x50",           Draw_Fill_Rect,         Ref_Fill_Rect,          11100,  10011,  0 },
+    { "fill_rect clipped",          Draw_Fill_Clipped,      Ref_Fill_Clipped,       0,      19211,  0 },
+    { "fill_screen 240x240",        Draw_Fill_Screen,       Ref_Fill_Screen,        117840, 115211, 0 },
+    { "line 200x60",                Draw_Line,              Ref_Line,               2613,   1073,   0 },
+    { "line 30x200 (steep)",        Draw_Line_Steep,        Ref_Line_Steep,         2613,   743,    0 },
+    { "line 45 degrees",            Draw_Line_45,           Ref_Line_45,            0,      1313,   0 },
+    { "line clipped",               Draw_Line_Clipped,      Ref_Line_Clipped,       0,      2515,   0 },
+    { "draw_rect 100x60",           Draw_Rect,              Ref_Rect,               2012,   692,    0 },
+    { "circle r50",                 Draw_Circle,            Ref_Circle,             3796,   1638,   0 },
+    { "circle r50 clipped",         Draw_Circle_Clipped,    Ref_Circle_Clipped,     0,      884,    0 },
+    { "half circle r40",            Draw_Half_Circle,       Ref_Half_Circle,        6117,   5640,   0 },
+    { "pixel",                      Draw_Pixel,             Ref_Pixel,              0,      13,     0 },
+    { "text, opaque \"Hello 42\"",  Draw_Text,              0,                      2976,   779,    0x2830E41C },
+    { "text, transparent",          Draw_Text_Transparent,  0,                      879,    643,    0x2830E41C },
+    { "text, size 2 \"Hi\"",        Draw_Text_Size_2,       0,                      1320,   779,    0x7D73D89D },
+    { "text, wrapped status line",  Draw_Text_Wrapped,      0,                      16740,  4348,   0x28D0191B },
+    { "text, 36 chars at size 3",   Draw_Text_Size_3,       0,                      41040,  31149,  0xF8CFD085 },
+};
+
+static uint32_t primitive;
+
+static void Test_Primitive(void)
+{
+    const Primitive *p = &primitives[primitive];
+    uint32_t spi_bytes;
+
+    BSP_Host_Set_TFT_Sink(Host_Panel_Sink);
+    BSP_Initialize();
+    Host_Panel_Clear();
+    memset(reference, 0, sizeof(reference));
+
+    spi_bytes = tft_spi_byte_count();
+    p->Draw();
+    tft_render_wait();
+    spi_bytes = tft_spi_byte_count() - spi_bytes;
+
+    HOST_CHECK_EQUAL(spi_bytes, Host_Panel_Bytes);
+    HOST_CHECK_EQUAL(Host_Panel_Errors, 0);
+    if (p->After) {
+        HOST_CHECK(spi_bytes <= p->After);
+    }
+
+    if (p->Reference) {
+        p->Reference();
+        HOST_CHECK(!memcmp(Host_Panel, reference, sizeof(reference)));
+    } else {
+        HOST_CHECK_EQUAL(Host_Panel_Hash(), p->Hash);
+    }
+
+    if (p->Before) {
+        printf("  %u bytes, %u before\n", spi_bytes, p->Before);
+    } else {
+        printf("  %u bytes\n", spi_bytes);
+    }
+}
+
+/******************************************************
+ * Upscaling
+ *
+ * A 160x120 image of noise scaled to 240x180 must stay
+ * within 1.6 LSB of a float reference of the 1/3 and 2/3
+ * taps in each field. Sent in strips of 30 or 10 rows,
+ * as segments or scanline groups, it must leave the
+ * panel as sent whole; an odd size sends nothing.
+ ******************************************************/
+#define SCALE_TOLERANCE                 1.6     // LSB of a field
+
+static uint16_t scale_image[120][160];          // Wire order
+static uint16_t scale_whole[180][240];          // The panel after the image sent whole
+
+static void Scale_Start(void)
+{
+    uint32_t seed = 12345;
+
+    BSP_Host_Set_TFT_Sink(Host_Panel_Sink);
+    BSP_Initialize();
+    Host_Panel_Clear();
+
+    for (int row = 0; row < 120; row++) {
+        for (int col = 0; col < 160; col++) {
+            seed = seed * 1103515245u + 12345u;
+            scale_image[row][col] = (uint16_t)(seed >> 16);
+        }
+    }
+}
+
+// Source coordinates of an output one, blended as a * (1 - weight) + b * weight
+static void Scale_Taps(int out, int size, int *a, int *b, double *weight)
+{
+    int k = out / 3 * 2;
+
+    switch (out % 3) {
+    case 0:
+        *a = k;
+        *b = k;
+        *weight = 0;
+        break;
+    case 1:
+        *a = k;
+        *b = k + 1;
+        *weight = 2.0 / 3;
+        break;
+    default:
+        *a = k + 1;
+        *b = (k + 2 < size) ? k + 2 : k + 1;
+        *weight = 1.0 / 3;
+        break;
+    }
+}
+
+static double Scale_Field(int row, int col, int shift, int mask)
+{
+    uint16_t wire = scale_image[row][col];
+
+    return (((uint16_t)((wire >> 8) | (wire << 8))) >> shift) & mask;
+}
+
+// Largest difference to the reference over the fields of every pixel
+static double Scale_Error(void)
+{
+    static const int shifts[3] = { 11, 5, 0 }, masks[3] = { 31, 63, 31 };
+    double worst = 0;
+
+    for (int row = 0; row < 180; row++) {
+        for (int col = 0; col < 240; col++) {
+            int r0, r1, c0, c1;
+            double wr, wc;
+
+            Scale_Taps(row, 120, &r0, &r1, &wr);
+            Scale_Taps(col, 160, &c0, &c1, &wc);
+
+            for (int field = 0; field < 3; field++) {
+                int shift = shifts[field], mask = masks[field];
+                double top = Scale_Field(r0, c0, shift, mask) * (1 - wc) + Scale_Field(r0, c1, shift, mask) * wc;
+                double bottom = Scale_Field(r1, c0, shift, mask) * (1 - wc) + Scale_Field(r1, c1, shift, mask) * wc;
+                double error = ((Host_Panel[_ystart + row][_xstart + col] >> shift) & mask) - (top * (1 - wr) + bottom * wr);
+
+                error = (error < 0) ? -error : error;
+                worst = (error > worst) ? error : worst;
+            }
+        }
+    }
+
+    return worst;
+}
+
+static int Scale_Matches_Whole(void)
+{
+    for (int row = 0; row < 180; row++) {
+        if (memcmp(&Host_Panel[_ystart + row][_xstart], scale_whole[row], sizeof(scale_whole[row]))) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void Scale_Strips(int rows)
+{
+    Host_Panel_Clear();
+
+    for (int row = 0; row < 120; row += rows) {
+        tft_render_image_scaled(TFT_IMAGE(&scale_image[row][0], 160, rows, 160), 0, row * 3 / 2,
+            TFT_SCALE_BILINEAR | ((row + rows < 120) ? TFT_SCALE_CONTINUED : 0));
+    }
+    tft_render_wait();
+}
+
+static void Test_Scale_Bilinear(void)
+{
+    double error;
+
+    Scale_Start();
+    tft_render_image_scaled(TFT_IMAGE(&scale_image[0][0], 160, 120, 160), 0, 0, TFT_SCALE_BILINEAR);
+    tft_render_wait();
+
+    error = Scale_Error();
+    HOST_CHECK(error <= SCALE_TOLERANCE);
+    HOST_CHECK_EQUAL(Host_Panel_Errors, 0);
+
+    printf("  within %.2f LSB\n", error);
+}
+
+static void Test_Scale_Strips(void)
+{
+    uint32_t panel_bytes;
+
+    Scale_Start();
+    tft_render_image_scaled(TFT_IMAGE(&scale_image[0][0], 160, 120, 160), 0, 0, TFT_SCALE_BILINEAR);
+    tft_render_wait();
+
+    for (int row = 0; row < 180; row++) {
+        memcpy(scale_whole[row], &Host_Panel[_ystart + row][_xstart], sizeof(scale_whole[row]));
+    }
+
+    // Segments, then scanline groups
+    Scale_Strips(30);
+    HOST_CHECK(Scale_Matches_Whole());
+    Scale_Strips(10);
+    HOST_CHECK(Scale_Matches_Whole());
+
+    // Odd sizes would read past the last column or row
+    panel_bytes = Host_Panel_Bytes;
+    tft_render_image_scaled(TFT_IMAGE(&scale_image[0][0], 159, 120, 160), 0, 0, TFT_SCALE_BILINEAR);
+    tft_render_image_scaled(TFT_IMAGE(&scale_image[0][0], 160, 119, 160), 0, 0, TFT_SCALE_NEAREST);
+    tft_render_wait();
+    HOST_CHECK_EQUAL(Host_Panel_Bytes, panel_bytes);
+
+    HOST_CHECK_EQUAL(Host_Panel_Errors, 0);
+}
+
+/******************************************************
+ * Delta Rendering
+ *
+ * A 160x120 image on the tile grid, 10 by 12 tiles of
+ * 16x10 pixels: sent whole first, then not at all while
+ * unchanged, one tile for one changed pixel, and whole
+ * again once every pixel changed. The stats must count
+ * what reached the panel. A HUD item over an unchanged
+ * image sends the tiles it touches as it shows, moves
+ * or hides.
+ ******************************************************/
+#define DELTA_X                         32
+#define DELTA_Y                         60
+#define DELTA_TILES                     (10 * 12)
+#define DELTA_FULL_BYTES                (11 + 160 * 120 * 2)
+#define DELTA_TILE_BYTES                (11 + 16 * 10 * 2)
+#define DELTA_RASET_BYTES               5       // Left out when the rows are those of the window before
+#define DELTA_MARKER_RADIUS             2
+
+static uint16_t delta_image[120][160];
+
+static void Delta_Render(TFT_Delta_Stats *before, uint32_t *panel_bytes)
+{
+    *before = tft_delta_stats();
+    *panel_bytes = Host_Panel_Bytes;
+    tft_render_image_delta(TFT_IMAGE(&delta_image[0][0], 160, 120, 160), DELTA_X, DELTA_Y);
+    tft_render_wait();
+    *panel_bytes = Host_Panel_Bytes - *panel_bytes;
+}
+
+// The image is in wire order, the panel holds the pixels
+static int Delta_On_Panel(void)
+{
+    for (int row = 0; row < 120; row++) {
+        for (int col = 0; col < 160; col++) {
+            uint16_t wire = delta_image[row][col];
+
+            if (Host_Panel[DELTA_Y + _ystart + row][DELTA_X + _xstart + col] != (uint16_t)((wire >> 8) | (wire << 8))) {
+                return 0;
+            }
+        }
+    }
+
+    return 1;
+}
+
+static void Delta_Start(void)
+{
+    BSP_Host_Set_TFT_Sink(Host_Panel_Sink);
+    BSP_Initialize();
+    Host_Panel_Clear();
+
+    for (int row = 0; row < 120; row++) {
+        for (int col = 0; col < 160; col++) {
+            delta_image[row][col] = row * 160 + col;
+        }
+    }
+
+    tft_delta_invalidate();
+}
+
+static void Test_Delta_Stats(void)
+{
+    TFT_Delta_Stats before, after;
+    uint32_t panel_bytes;
+
+    Delta_Start();
+
+    // First frame: nothing sent before, so whole
+    Delta_Render(&before, &panel_bytes);
+    after = tft_delta_stats();
+    HOST_CHECK_EQUAL(after.Frames - before.Frames, 1);
+    HOST_CHECK_EQUAL(after.Full_Frames - before.Full_Frames, 1);
+    HOST_CHECK_EQUAL(after.Tiles_Sent - before.Tiles_Sent, DELTA_TILES);
+    HOST_CHECK_EQUAL(after.Bytes_Sent - before.Bytes_Sent, DELTA_FULL_BYTES);
+    HOST_CHECK_EQUAL(after.Bytes_Saved - before.Bytes_Saved, 0);
+    HOST_CHECK_EQUAL(panel_bytes, DELTA_FULL_BYTES);
+    HOST_CHECK(Delta_On_Panel());
+
+    // Unchanged: nothing sent, all of it saved
+    Delta_Render(&before, &panel_bytes);
+    after = tft_delta_stats();
+    HOST_CHECK_EQUAL(after.Frames - before.Frames, 1);
+    HOST_CHECK_EQUAL(after.Full_Frames - before.Full_Frames, 0);
+    HOST_CHECK_EQUAL(after.Tiles_Sent - before.Tiles_Sent, 0);
+    HOST_CHECK_EQUAL(after.Bytes_Sent - before.Bytes_Sent, 0);
+    HOST_CHECK_EQUAL(after.Bytes_Saved - before.Bytes_Saved, DELTA_FULL_BYTES);
+    HOST_CHECK_EQUAL(panel_bytes, 0);
+
+    // One pixel in tile (5, 7): that tile alone
+    delta_image[75][85] ^= 0xFFFF;
+    Delta_Render(&before, &panel_bytes);
+    after = tft_delta_stats();
+    HOST_CHECK_EQUAL(after.Full_Frames - before.Full_Frames, 0);
+    HOST_CHECK_EQUAL(after.Tiles_Sent - before.Tiles_Sent, 1);
+    HOST_CHECK_EQUAL(after.Bytes_Sent - before.Bytes_Sent, DELTA_TILE_BYTES);
+    HOST_CHECK_EQUAL(after.Bytes_Saved - before.Bytes_Saved, DELTA_FULL_BYTES - DELTA_TILE_BYTES);
+    HOST_CHECK_EQUAL(panel_bytes, DELTA_TILE_BYTES);
+    HOST_CHECK(Delta_On_Panel());
+
+    // Every pixel: over the threshold, whole again and nothing saved
+    for (int row = 0; row < 120; row++) {
+        for (int col = 0; col < 160; col++) {
+            delta_image[row][col] ^= 0x0841;
+        }
+    }
+    Delta_Render(&before, &panel_bytes);
+    after = tft_delta_stats();
+    HOST_CHECK_EQUAL(after.Full_Frames - before.Full_Frames, 1);
+    HOST_CHECK_EQUAL(after.Tiles_Sent - before.Tiles_Sent, DELTA_TILES);
+    HOST_CHECK_EQUAL(after.Bytes_Sent - before.Bytes_Sent, DELTA_FULL_BYTES);
+    HOST_CHECK_EQUAL(after.Bytes_Saved - before.Bytes_Saved, 0);
+    HOST_CHECK_EQUAL(panel_bytes, DELTA_FULL_BYTES);
+    HOST_CHECK(Delta_On_Panel());
+
+    HOST_CHECK_EQUAL(Host_Panel_Errors, 0);
+
+    printf("  %u frames, %u whole, %u tiles and %u bytes sent, %u bytes saved\n",
+        after.Frames, after.Full_Frames, after.Tiles_Sent, after.Bytes_Sent, after.Bytes_Saved);
+}
+
+// Marker pixels on the panel around an image pixel
+static uint32_t Delta_Marker(int x, int y)
+{
+    uint32_t count = 0;
+
+    for (int row = y - DELTA_MARKER_RADIUS; row <= y + DELTA_MARKER_RADIUS; row++) {
+        for (int col = x - DELTA_MARKER_RADIUS; col <= x + DELTA_MARKER_RADIUS; col++) {
+            count += (Host_Panel[DELTA_Y + _ystart + row][DELTA_X + _xstart + col] == TFT_COLOR_RED);
+        }
+    }
+
+    return count;
+}
+
+static void Test_Delta_Hud(void)
+{
+    TFT_Delta_Stats before, after;
+    uint32_t panel_bytes;
+    int marker;
+
+    Delta_Start();
+    Delta_Render(&before, &panel_bytes);
+
+    // Shown in tile (0, 0): that tile alone
+    marker = tft_hud_add_marker(DELTA_X + 8, DELTA_Y + 5, DELTA_MARKER_RADIUS, TFT_COLOR_RED);
+    Delta_Render(&before, &panel_bytes);
+    after = tft_delta_stats();
+    HOST_CHECK_EQUAL(after.Tiles_Sent - before.Tiles_Sent, 1);
+    HOST_CHECK_EQUAL(panel_bytes, DELTA_TILE_BYTES);
+    HOST_CHECK_EQUAL(after.Bytes_Sent - before.Bytes_Sent, panel_bytes);
+    HOST_CHECK_EQUAL(Delta_Marker(8, 5), 8 * DELTA_MARKER_RADIUS);
+
+    // Moved into tile (1, 0): both, as one run of two tiles
+    tft_hud_move(marker, DELTA_X + 24, DELTA_Y + 5);
+    Delta_Render(&before, &panel_bytes);
+    after = tft_delta_stats();
+    HOST_CHECK_EQUAL(after.Tiles_Sent - before.Tiles_Sent, 2);
+    HOST_CHECK_EQUAL(panel_bytes, DELTA_TILE_BYTES + 16 * 10 * 2 - DELTA_RASET_BYTES);
+    HOST_CHECK_EQUAL(after.Bytes_Sent - before.Bytes_Sent, panel_bytes);
+    HOST_CHECK_EQUAL(Delta_Marker(8, 5), 0);
+    HOST_CHECK_EQUAL(Delta_Marker(24, 5), 8 * DELTA_MARKER_RADIUS);
+
+    // Unchanged, the marker too: nothing
+    Delta_Render(&before, &panel_bytes);
+    HOST_CHECK_EQUAL(panel_bytes, 0);
+
+    // Hidden: its tile, and the image is whole again
+    tft_hud_show(marker, 0);
+    Delta_Render(&before, &panel_bytes);
+    after = tft_delta_stats();
+    HOST_CHECK_EQUAL(after.Tiles_Sent - before.Tiles_Sent, 1);
+    HOST_CHECK_EQUAL(panel_bytes, DELTA_TILE_BYTES - DELTA_RASET_BYTES);
+    HOST_CHECK_EQUAL(after.Bytes_Sent - before.Bytes_Sent, panel_bytes);
+    HOST_CHECK(Delta_On_Panel());
+
+    HOST_CHECK_EQUAL(Host_Panel_Errors, 0);
+}
+
+int main(void)
+{
+    for (primitive = 0; primitive < sizeof(primitives) / sizeof(primitives[0]); primitive++) {
+        Host_Test_Scenario(primitives[primitive].Name, Test_Primitive);
+    }
+    Host_Test_Scenario("bilinear upscaling", Test_Scale_Bilinear);
+    Host_Test_Scenario("upscaling in strips", Test_Scale_Strips);
+    Host_Test_Scenario("delta stats", Test_Delta_Stats);
+    Host_Test_Scenario("delta under the HUD", Test_Delta_Hud);
+
+    return Host_Test_Exit();
+}
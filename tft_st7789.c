@@ -8,8 +8,8 @@
  ******************************************************/
 
 #include <stdint.h>
-#include <xc.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include "tft_st7789.h"
 #include "BSP.h"
 
@@ -59,7 +59,27 @@
 // Externals
 void BSP_Delay_ms(int ms);
 
+// Internals
+static void __tft_render_on_dma_complete(void);
+void __tft_write_wire_buffer(uint16_t *colors, uint32_t len);
+void __tft_pack_flush(void);
+
 // Macros
+#define TFT_SWAP16(c)           ((uint16_t)(((c) >> 8) | ((c) << 8)))   // Native RGB565 <=> wire order
+#define TFT_LINE_MAX            320     // Longest row the line buffers hold
+
+#ifdef TFT_CONFIG_RGB444
+#define TFT_COLMOD              0x53    // 12-bit pixels
+#define TFT_PIXEL_BYTES(n)      ((3 * (uint32_t)(n) + 1) / 2)
+#else
+#define TFT_COLMOD              0x55    // 16-bit pixels
+#define TFT_PIXEL_BYTES(n)      (2 * (uint32_t)(n))
+#endif
+
+#if defined(TFT_CONFIG_RGB444) && (BSP_TFT_BUS_WIDTH != 8)
+#error "TFT_CONFIG_RGB444 packs pixels into bytes, it needs an 8-bit display bus"
+#endif
+
 #define _swap_int16_t(a, b)                                                    \
   {                                                                            \
     int16_t t = a;                                                             \
@@ -87,6 +107,12 @@ uint16_t invertOnCommand;
 uint16_t invertOffCommand;
 uint8_t rotation;
 
+#define TFT_WINDOW_UNKNOWN 0xFFFFFFFF
+
+// Last column and row ranges sent, RAMWR restarts at the window origin so an unchanged range needs no resend
+static uint32_t window_xa = TFT_WINDOW_UNKNOWN;
+static uint32_t window_ya = TFT_WINDOW_UNKNOWN;
+
 void SPI_CS_LOW()
 {
     BSP_Pin_TFT_CS = 0;
@@ -107,10 +133,12 @@ void SPI_DC_HIGH()
     BSP_Pin_TFT_DC = 1;
 }    
 
-uint8_t spiWrite(uint8_t b) {
-    BSP_Register_TFT_SPIBUF = b;
-    while(!BSP_Register_TFT_SPISTAT.SPIRBF) ;
-    return BSP_Register_TFT_SPIBUF;    
+static uint32_t spi_bytes = 0;     // Everything sent to the panel, commands included
+
+// One byte in its own bus cycle, done when this returns
+void spiWrite(uint8_t b) {
+    spi_bytes++;
+    BSP_TFT_Write(b);
 }
 
 void sendCommand(uint8_t commandByte, uint8_t *dataBytes, uint8_t numDataBytes)
@@ -166,6 +194,8 @@ void __tft_set_rotation(uint8_t m) {
     }
 
     sendCommand(ST77XX_MADCTL, &madctl, 1);
+
+    window_xa = window_ya = TFT_WINDOW_UNKNOWN;
 }
 /*!
  @brief   Adafruit_SPITFT Send Command handles complete sending of commands and
@@ -200,7 +230,7 @@ static const uint8_t st7789_init_sequence[] =
     ST77XX_SLPOUT, ST_CMD_DELAY, //  2: Out of sleep mode, no args, w/delay
     10, //      10 ms delay
     ST77XX_COLMOD, 1 + ST_CMD_DELAY, //  3: Set color mode, 1 arg + delay:
-    0x55, //     16-bit color
+    TFT_COLMOD, //     16-bit color, 12-bit with TFT_CONFIG_RGB444
     10, //     10 ms delay
     ST77XX_MADCTL, 1, //  4: Mem access ctrl (directions), 1 arg:
     0x08, //     Row/col addr, bottom-top refresh
@@ -271,9 +301,12 @@ void tft_init(uint16_t width, uint16_t height)
 
     __tft_display_init(st7789_init_sequence);
     __tft_set_rotation(0);
+
+    BSP_Initialize_TFT_DMA(__tft_render_on_dma_complete);
 }
 
 void startWrite(void) {
+    tft_render_wait(); // The bus belongs to the DMA until the pending render is out
     SPI_CS_LOW();
 }
 
@@ -284,6 +317,9 @@ void startWrite(void) {
             for all display types; not an SPI-specific function.
 */
 void endWrite(void) {
+#ifdef TFT_CONFIG_RGB444
+    __tft_pack_flush();
+#endif
     SPI_CS_HIGH();
 }
 
@@ -301,20 +337,200 @@ void SPI_WRITE32(uint32_t l) {
     spiWrite(l);
 }
 
+// One pixel, a single cycle on a 16-bit bus
 void SPI_WRITE16(uint16_t w) {
+#if BSP_TFT_BUS_WIDTH == 16
+    spi_bytes += 2;
+    BSP_TFT_Write(w);
+#else
     spiWrite(w >> 8);
     spiWrite(w);
+#endif
+}
+
+/*******************************************************
+ * Pixel Streaming
+ *
+ * Bulk pixel data is written in 16 or 32-bit words into
+ * the enhanced buffer, waiting only for room in the FIFO
+ * instead of for every byte to come back. CS is released
+ * while the word width changes: the ST7789 pauses a RAM
+ * write on a byte boundary and resumes it afterwards.
+ * On the PMP the words are split into bus cycles.
+ *******************************************************/
+#ifdef TFT_CONFIG_SPI_STREAM_WIDTH
+
+#define TFT_STREAM_MIN_PIXELS   8   // Shorter runs do not pay off the width switch
+
+void __tft_stream_begin(void) {
+    SPI_CS_HIGH();
+    BSP_TFT_Set_Width(TFT_CONFIG_SPI_STREAM_WIDTH);
+    SPI_CS_LOW();
+}
+
+void __tft_stream_end(void) {
+    SPI_CS_HIGH();
+    BSP_TFT_Set_Width(8);
+    SPI_CS_LOW();
+}
+
+static inline void __tft_stream_write(uint32_t word) {
+    spi_bytes += TFT_CONFIG_SPI_STREAM_WIDTH / 8;
+    BSP_TFT_Stream(word);
+}
+
+#endif
+
+/*******************************************************
+ * RGB444 Pixel Packing
+ *
+ * With TFT_CONFIG_RGB444 the panel takes 12-bit pixels,
+ * two in three bytes. Colours and image buffers stay
+ * RGB565; each pixel is cut to 4 bits per channel as it
+ * is queued, and the queue goes out as soon as it holds
+ * whole bytes, in words while streaming. A window may so
+ * be filled by several writes, and a pixel may straddle
+ * a pause of the RAM write. The half byte left by an odd
+ * pixel count is padded when the window ends; the ST7789
+ * drops an incomplete pixel. Palettes of indexed images
+ * are cut once, and kept while the same one is used.
+ *******************************************************/
+#ifdef TFT_CONFIG_RGB444
+
+#define TFT_RGB444(c)           ((uint16_t)((((c) >> 4) & 0xF00) | (((c) >> 3) & 0x0F0) | (((c) >> 1) & 0x00F)))  // From native RGB565
+
+static uint64_t pack_bits;                      // Queued bits, the oldest highest
+static uint8_t pack_count;                      // How many, under 8 between writes
+static uint16_t pack_line[TFT_LINE_MAX];        // A run of pixels cut to 12 bits
+static uint16_t pack_palette[256];
+static const uint16_t *pack_palette_source;     // Palette pack_palette was cut from
+static uint8_t pack_dma[TFT_PIXEL_BYTES(TFT_LINE_MAX) + 1] BSP_DMA_BUFFER;    // A packed row for the DMA
+
+// Queues 12-bit pixels, or len times the same one with step 0, and sends all whole bytes
+static void __tft_pack_write(const uint16_t *pixels, uint8_t step, uint32_t len) {
+
+#ifdef TFT_CONFIG_SPI_STREAM_WIDTH
+    if (len >= TFT_STREAM_MIN_PIXELS) {
+        __tft_stream_begin();
+        for (; len; len--, pixels += step) {
+            pack_bits = (pack_bits << 12) | *pixels;
+            pack_count += 12;
+
+            if (pack_count >= TFT_CONFIG_SPI_STREAM_WIDTH) {
+                pack_count -= TFT_CONFIG_SPI_STREAM_WIDTH;
+                __tft_stream_write((uint32_t)(pack_bits >> pack_count));
+            }
+        }
+        __tft_stream_end();
+    }
+#endif
+
+    // Also what streaming left
+    while (pack_count >= 8) {
+        pack_count -= 8;
+        spiWrite((uint8_t)(pack_bits >> pack_count));
+    }
+
+    for (; len; len--, pixels += step) {
+        pack_bits = (pack_bits << 12) | *pixels;
+        pack_count += 12;
+
+        while (pack_count >= 8) {
+            pack_count -= 8;
+            spiWrite((uint8_t)(pack_bits >> pack_count));
+        }
+    }
+}
+
+// Closes the window, padding a last half byte
+void __tft_pack_flush(void) {
+    if (pack_count) {
+        spiWrite((uint8_t)(pack_bits << (8 - pack_count)));
+        pack_count = 0;
+    }
+}
+
+// Sends wire-order RGB565 pixels
+static void __tft_pack_wire(const uint16_t *colors, uint32_t len) {
+    while (len) {
+        uint16_t n = (len > TFT_LINE_MAX) ? TFT_LINE_MAX : len;
+
+        for (uint16_t i = 0; i < n; i++) {
+            pack_line[i] = TFT_RGB444(TFT_SWAP16(colors[i]));
+        }
+        __tft_pack_write(pack_line, 1, n);
+
+        colors += n;
+        len -= n;
+    }
+}
+
+static const uint16_t *__tft_pack_palette(const uint16_t *palette) {
+    if (palette != pack_palette_source) {
+        for (int i = 0; i < 256; i++) {
+            pack_palette[i] = TFT_RGB444(TFT_SWAP16(palette[i]));
+        }
+        pack_palette_source = palette;
+    }
+
+    return pack_palette;
+}
+
+// Packs a row of wire-order pixels into pack_dma, padded when it ends the window; returns the bytes to send
+static uint16_t __tft_pack_row(const uint16_t *colors, uint16_t len, uint8_t last) {
+    uint8_t *dst = pack_dma;
+
+    for (uint16_t i = 0; i < len; i++) {
+        pack_bits = (pack_bits << 12) | TFT_RGB444(TFT_SWAP16(colors[i]));
+        pack_count += 12;
+
+        while (pack_count >= 8) {
+            pack_count -= 8;
+            *dst++ = (uint8_t)(pack_bits >> pack_count);
+        }
+    }
+
+    if (last && pack_count) {
+        *dst++ = (uint8_t)(pack_bits << (8 - pack_count));
+        pack_count = 0;
+    }
+
+    return dst - pack_dma;
 }
 
+#endif
+
 void writeColor(uint16_t color, uint32_t len) {
 
   if (!len)
     return; // Avoid 0-byte transfers
 
-  uint8_t hi = color >> 8, lo = color;
+#ifdef TFT_CONFIG_RGB444
+  uint16_t packed = TFT_RGB444(color);
+
+  __tft_pack_write(&packed, 0, len);
+  return;
+#endif
+
+#ifdef TFT_CONFIG_SPI_STREAM_WIDTH
+  if (len >= TFT_STREAM_MIN_PIXELS) {
+    __tft_stream_begin();
+#if TFT_CONFIG_SPI_STREAM_WIDTH == 32
+    uint32_t pair = ((uint32_t)color << 16) | color;
+    for (; len >= 2; len -= 2) {
+      __tft_stream_write(pair);
+    }
+#else
+    for (; len; len--) {
+      __tft_stream_write(color);
+    }
+#endif
+    __tft_stream_end();
+  }
+#endif
+
     while (len--) {
-      spiWrite(hi);
-      spiWrite(lo);
+      SPI_WRITE16(color);
     }
 }
 
@@ -329,16 +545,26 @@ void writeColor(uint16_t color, uint32_t len) {
 /**************************************************************************/
 void setAddrWindow(uint16_t x, uint16_t y, uint16_t w,
                                     uint16_t h) {
+#ifdef TFT_CONFIG_RGB444
+  __tft_pack_flush();
+#endif
+
   x += _xstart;
   y += _ystart;
   uint32_t xa = ((uint32_t)x << 16) | (x + w - 1);
   uint32_t ya = ((uint32_t)y << 16) | (y + h - 1);
 
-  writeCommand(ST77XX_CASET); // Column addr set
-  SPI_WRITE32(xa);
+  if (xa != window_xa) {
+    writeCommand(ST77XX_CASET); // Column addr set
+    SPI_WRITE32(xa);
+    window_xa = xa;
+  }
 
-  writeCommand(ST77XX_RASET); // Row addr set
-  SPI_WRITE32(ya);
+  if (ya != window_ya) {
+    writeCommand(ST77XX_RASET); // Row addr set
+    SPI_WRITE32(ya);
+    window_ya = ya;
+  }
 
   writeCommand(ST77XX_RAMWR); // write to RAM
 }
@@ -351,39 +577,51 @@ void writeFillRectPreclipped(int16_t x, int16_t y,
   writeColor(color, (uint32_t)w * h);
 }
 
+/*******************************************************
+ * Span Rasterizer
+ *
+ * Every primitive is broken into the fewest rectangles
+ * (spans) it can be, each clipped here and sent as one
+ * address window plus one colour burst. CS must be low.
+ *******************************************************/
+void __tft_fill_span(int x, int y, int w, int h, uint16_t color) {
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (x + w > _width) {
+        w = _width - x;
+    }
+    if (y + h > _height) {
+        h = _height - y;
+    }
+
+    if ((w > 0) && (h > 0)) {
+        writeFillRectPreclipped(x, y, w, h, color);
+    }
+}
+
 void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
-    if ((x >= 0) && (x < _width) && h) { // X on screen, nonzero height
-        if (h < 0) { // If negative height...
-            y += h + 1; //   Move Y to top edge
-            h = -h; //   Use positive height
-        }
-        if (y < _height) { // Not off bottom
-            int16_t y2 = y + h - 1;
-            if (y2 >= 0) { // Not off top
-                // Line partly or fully overlaps screen
-                if (y < 0) {
-                    y = 0;
-                    h = y2 + 1;
-                } // Clip top
-                if (y2 >= _height) {
-                    h = _height - y;
-                } // Clip bottom
-                writeFillRectPreclipped(x, y, 1, h, color);
-            }
-        }
+    if (h < 0) { // If negative height...
+        y += h + 1; //   Move Y to top edge
+        h = -h; //   Use positive height
     }
+    __tft_fill_span(x, y, 1, h, color);
 }
 
 void tft_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
   startWrite();
-  for (int16_t i = x; i < x + w; i++) {
-    writeFastVLine(i, y, h, color);
-  }
+  __tft_fill_span(x, y, w, h, color);
   endWrite();
 }
 
 void tft_fill_screen(uint16_t color) {
   tft_fill_rect(0, 0, _width, _height, color);
+  tft_delta_invalidate();
 }
 
 
@@ -402,7 +640,7 @@ void __tft_draw_pixel(int16_t x, int16_t y, uint16_t color) {
     if ((x >= 0) && (x < _width) && (y >= 0) && (y < _height)) {
         startWrite();
         setAddrWindow(x, y, 1, 1);
-        SPI_WRITE16(color);
+        writeColor(color, 1);
         endWrite();
     }
 }
@@ -432,13 +670,19 @@ void __tft_write_line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c
         ystep = -1;
     }
 
+    // Pixels sharing a row (a column when steep) go out as one span
+    int16_t run_start = x0;
+
     for (; x0 <= x1; x0++) {
-        if (steep) {
-            __tft_draw_pixel(y0, x0, color);
-        } else {
-            __tft_draw_pixel(x0, y0, color);
-        }
         err -= dy;
+        if ((err < 0) || (x0 == x1)) {
+            if (steep) {
+                __tft_fill_span(y0, run_start, 1, x0 - run_start + 1, color);
+            } else {
+                __tft_fill_span(run_start, y0, x0 - run_start + 1, 1, color);
+            }
+            run_start = x0 + 1;
+        }
         if (err < 0) {
             y0 += ystep;
             err += dx;
@@ -463,16 +707,8 @@ void drawFastHLine(int16_t x, int16_t y, int16_t w,
     if (x < _width) { // Not off right
       int16_t x2 = x + w - 1;
       if (x2 >= 0) { // Not off left
-        // Line partly or fully overlaps screen
-        if (x < 0) {
-          x = 0;
-          w = x2 + 1;
-        } // Clip left
-        if (x2 >= _width) {
-          w = _width - x;
-        } // Clip right
         startWrite();
-        writeFillRectPreclipped(x, y, w, 1, color);
+        __tft_fill_span(x, y, w, 1, color);
         endWrite();
       }
     }
@@ -509,25 +745,47 @@ void tft_draw_pixel_buffer(int16_t x, int16_t y, uint16_t color) {
     if ((x >= 0) && (x < _width) && (y >= 0) && (y < _height)) {
         startWrite();
         setAddrWindow(x, y, 1, 1);
-        SPI_WRITE16(color);
+        writeColor(color, 1);
         endWrite();
     }
 }
 
+// Circle points (+-[xs..xe], +-y) and (+-y, +-[xs..xe]) as row and column spans
+static void __tft_circle_spans(int16_t x0, int16_t y0, int16_t xs, int16_t xe, int16_t y, uint16_t color) {
+    int16_t w = xe - xs + 1;
+
+    if (xs == 0) {
+        // The two mirrored halves meet on the axis
+        __tft_fill_span(x0 - xe, y0 + y, 2 * xe + 1, 1, color);
+        __tft_fill_span(x0 - xe, y0 - y, 2 * xe + 1, 1, color);
+        __tft_fill_span(x0 + y, y0 - xe, 1, 2 * xe + 1, color);
+        __tft_fill_span(x0 - y, y0 - xe, 1, 2 * xe + 1, color);
+    } else {
+        __tft_fill_span(x0 + xs, y0 + y, w, 1, color);
+        __tft_fill_span(x0 - xe, y0 + y, w, 1, color);
+        __tft_fill_span(x0 + xs, y0 - y, w, 1, color);
+        __tft_fill_span(x0 - xe, y0 - y, w, 1, color);
+        __tft_fill_span(x0 + y, y0 + xs, 1, w, color);
+        __tft_fill_span(x0 - y, y0 + xs, 1, w, color);
+        __tft_fill_span(x0 + y, y0 - xe, 1, w, color);
+        __tft_fill_span(x0 - y, y0 - xe, 1, w, color);
+    }
+}
+
 void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
     int16_t f = 1 - r;
     int16_t ddF_x = 1;
     int16_t ddF_y = -2 * r;
     int16_t x = 0;
     int16_t y = r;
+    int16_t run_start = 0;  // First x of the points on the current y
 
     startWrite();
-    __tft_draw_pixel(x0, y0 + r, color);
-    __tft_draw_pixel(x0, y0 - r, color);
-    __tft_draw_pixel(x0 + r, y0, color);
-    __tft_draw_pixel(x0 - r, y0, color);
 
     while (x < y) {
+        int16_t last_x = x;
+        int16_t last_y = y;
+
         if (f >= 0) {
             y--;
             ddF_y += 2;
@@ -537,15 +795,12 @@ void drawCircle(int16_t x0, int16_t y0, int16_t r, uint16_t color) {
         ddF_x += 2;
         f += ddF_x;
 
-        __tft_draw_pixel(x0 + x, y0 + y, color);
-        __tft_draw_pixel(x0 - x, y0 + y, color);
-        __tft_draw_pixel(x0 + x, y0 - y, color);
-        __tft_draw_pixel(x0 - x, y0 - y, color);
-        __tft_draw_pixel(x0 + y, y0 + x, color);
-        __tft_draw_pixel(x0 - y, y0 + x, color);
-        __tft_draw_pixel(x0 + y, y0 - x, color);
-        __tft_draw_pixel(x0 - y, y0 - x, color);
+        if (y != last_y) {
+            __tft_circle_spans(x0, y0, run_start, last_x, last_y, color);
+            run_start = x;
+        }
     }
+    __tft_circle_spans(x0, y0, run_start, x, y, color);
     endWrite();
 }
 
@@ -557,9 +812,11 @@ void __tft_half_circle_helper(int16_t x0, int16_t y0, int16_t r, uint8_t corners
     int16_t y = r;
     int16_t px = x;
     int16_t py = y;
+    int16_t run_start = 0;  // Adjacent columns of the same height, merged into one span
+    int16_t run_end = -1;
+    int16_t run_y = 0;
 
     delta++; // Avoid some +1's in the loop
-    int z = 0;
 
     while (x < y) {
         if (f >= 0) {
@@ -573,10 +830,17 @@ void __tft_half_circle_helper(int16_t x0, int16_t y0, int16_t r, uint8_t corners
         // These checks avoid double-drawing certain lines, important
         // for the SSD1306 library which has an INVERT drawing mode.
         if (x < (y + 1)) {
-            if (corners & 1)
-                writeFastVLine(x0 + x, y0 - y, 1 * y + delta, color);
-            if (corners & 2)
-                writeFastVLine(x0 - x, y0 - y, 1 * y + delta, color);
+            if ((y != run_y) || (x != run_end + 1)) {
+                if (run_end >= run_start) {
+                    if (corners & 1)
+                        __tft_fill_span(x0 + run_start, y0 - run_y, run_end - run_start + 1, run_y + delta, color);
+                    if (corners & 2)
+                        __tft_fill_span(x0 - run_end, y0 - run_y, run_end - run_start + 1, run_y + delta, color);
+                }
+                run_start = x;
+                run_y = y;
+            }
+            run_end = x;
         }
         if (y != py) {
             if (corners & 1)
@@ -586,11 +850,15 @@ void __tft_half_circle_helper(int16_t x0, int16_t y0, int16_t r, uint8_t corners
             py = y;
         }
         px = x;
-        
-        z++;
     }
-}
 
+    if (run_end >= run_start) {
+        if (corners & 1)
+            __tft_fill_span(x0 + run_start, y0 - run_y, run_end - run_start + 1, run_y + delta, color);
+        if (corners & 2)
+            __tft_fill_span(x0 - run_end, y0 - run_y, run_end - run_start + 1, run_y + delta, color);
+    }
+}
 
 void tft_fill_half_circle(int16_t x0, int16_t y0, int16_t r, uint16_t color)
 {
@@ -752,46 +1020,144 @@ uint16_t textbgcolor = 0xFFFF;
 uint8_t wrap = 1;
 uint8_t _cp437 = 0;
 
-void drawChar(int16_t x, int16_t y, unsigned char c,
-                            uint16_t color, uint16_t bg, uint8_t size_x,
-                            uint8_t size_y) {
+/*******************************************************
+ * Glyph Blitting
+ *
+ * Opaque text is expanded from font[] into a cell buffer,
+ * any text size, and a run of characters on one line is
+ * sent through a single address window. Transparent or
+ * partly visible glyphs go out as column spans instead.
+ *******************************************************/
+#define TFT_TEXT_CELLS          2048    // Cell buffer pixels, a 40 character line at size 1
+#define TFT_TEXT_RUN_MAX        64      // Characters blitted in one window
 
+static uint16_t text_cells[TFT_TEXT_CELLS];
 
-    if ((x >= _width) ||              // Clip right
-        (y >= _height) ||             // Clip bottom
-        ((x + 6 * size_x - 1) < 0) || // Clip left
-        ((y + 8 * size_y - 1) < 0))   // Clip top
-      return;
+static inline uint8_t __tft_glyph(unsigned char c) {
+    return (!_cp437 && (c >= 176)) ? c + 1 : c; // Handle 'classic' charset behavior
+}
 
-    if (!_cp437 && (c >= 176))
-      c++; // Handle 'classic' charset behavior
+// Glyph dots as vertical runs of equal colour, the transparent ones skipped
+static void __tft_draw_char_spans(int16_t x, int16_t y, unsigned char c,
+                                  uint16_t color, uint16_t bg, uint8_t size_x,
+                                  uint8_t size_y) {
+    c = __tft_glyph(c);
 
-    startWrite();
     for (int8_t i = 0; i < 5; i++) { // Char bitmap = 5 columns
-      uint8_t line = font[c * 5 + i];
-      for (int8_t j = 0; j < 8; j++, line >>= 1) {
-        if (line & 1) {
-          if (size_x == 1 && size_y == 1)
-            __tft_draw_pixel(x + i, y + j, color);
-          else
-            tft_fill_rect(x + i * size_x, y + j * size_y, size_x, size_y,
-                          color);
-        } else if (bg != color) {
-          if (size_x == 1 && size_y == 1)
-            __tft_draw_pixel(x + i, y + j, bg);
-          else
-            tft_fill_rect(x + i * size_x, y + j * size_y, size_x, size_y, bg);
+        uint8_t line = font[c * 5 + i];
+        int8_t j = 0;
+
+        while (j < 8) {
+            uint8_t dot = (line >> j) & 1;
+            int8_t run_start = j;
+
+            while ((j < 8) && (((line >> j) & 1) == dot)) {
+                j++;
+            }
+
+            if (dot || (bg != color)) {
+                __tft_fill_span(x + i * size_x, y + run_start * size_y, size_x, (j - run_start) * size_y, dot ? color : bg);
+            }
         }
-      }
     }
+
     if (bg != color) { // If opaque, draw vertical line for last column
-      if (size_x == 1 && size_y == 1)
-        writeFastVLine(x + 5, y, 8, bg);
-      else
-        tft_fill_rect(x + 5 * size_x, y, size_x, 8 * size_y, bg);
+        __tft_fill_span(x + 5 * size_x, y, size_x, 8 * size_y, bg);
+    }
+}
+
+// Opaque characters fully on screen, in one window
+static void __tft_blit_text(int16_t x, int16_t y, const char *text, int n,
+                            uint16_t color, uint16_t bg, uint8_t size_x,
+                            uint8_t size_y) {
+    uint16_t width = n * 6 * size_x;
+    uint16_t height = 8 * size_y;
+    uint16_t band = TFT_TEXT_CELLS / width;     // Pixel rows per cell buffer fill
+    uint16_t fg_wire = TFT_SWAP16(color);
+    uint16_t bg_wire = TFT_SWAP16(bg);
+
+    setAddrWindow(x, y, width, height);
+
+    for (uint16_t row = 0; row < height; ) {
+        uint16_t *cell = text_cells;
+        uint16_t rows = (height - row < band) ? height - row : band;
+
+        for (uint16_t r = row; r < row + rows; r++) {
+            uint8_t mask = 1 << (r / size_y);
+
+            for (int k = 0; k < n; k++) {
+                const unsigned char *glyph = &font[__tft_glyph(text[k]) * 5];
+
+                for (int8_t i = 0; i < 6; i++) {
+                    uint16_t dot = ((i < 5) && (glyph[i] & mask)) ? fg_wire : bg_wire;
+
+                    for (uint8_t sx = 0; sx < size_x; sx++) {
+                        *cell++ = dot;
+                    }
+                }
+            }
+        }
+
+        __tft_write_wire_buffer(text_cells, (uint32_t)rows * width);
+        row += rows;
+    }
+}
+
+void __tft_draw_text(int16_t x, int16_t y, const char *text, int n,
+                     uint16_t color, uint16_t bg, uint8_t size_x,
+                     uint8_t size_y) {
+    int16_t char_width = 6 * size_x;
+
+    if ((x >= _width) ||                    // Clip right
+        (y >= _height) ||                   // Clip bottom
+        ((x + n * char_width - 1) < 0) ||   // Clip left
+        ((y + 8 * size_y - 1) < 0))         // Clip top
+      return;
+
+    startWrite();
+
+    // Only opaque text that fits whole rows of the cell buffer is blitted
+    if ((bg == color) || (y < 0) || (y + 8 * size_y > _height) || (char_width > TFT_TEXT_CELLS)) {
+        for (int k = 0; k < n; k++, x += char_width) {
+            __tft_draw_char_spans(x, y, text[k], color, bg, size_x, size_y);
+        }
+    } else {
+        int k = 0;
+
+        // Partly visible characters at either end
+        for (; (k < n) && (x < 0); k++, x += char_width) {
+            __tft_draw_char_spans(x, y, text[k], color, bg, size_x, size_y);
+        }
+
+        while (k < n) {
+            int run = 0;
+
+            while ((k + run < n) && (run < TFT_TEXT_RUN_MAX) && (x + (run + 1) * char_width <= _width) &&
+                   ((run + 1) * char_width <= TFT_TEXT_CELLS)) {
+                run++;
+            }
+
+            if (!run) {
+                __tft_draw_char_spans(x, y, text[k], color, bg, size_x, size_y);
+                run = 1;
+            } else {
+                __tft_blit_text(x, y, &text[k], run, color, bg, size_x, size_y);
+            }
+
+            k += run;
+            x += run * char_width;
+        }
     }
+
     endWrite();
+}
+
+void drawChar(int16_t x, int16_t y, unsigned char c,
+                            uint16_t color, uint16_t bg, uint8_t size_x,
+                            uint8_t size_y) {
+    char text = c;
 
+    __tft_draw_text(x, y, &text, 1, color, bg, size_x, size_y);
 }
 
 uint8_t tft_get_cursor_x() { return cursor_x; }
@@ -822,6 +1188,35 @@ uint8_t tft_write_char(uint8_t c)
     return 1;
 }
 
+// Writes like tft_write_char(), each run of characters that fits the current line drawn at once
+void __tft_write_text(const char *text, int len)
+{
+    while (len > 0) {
+        int run = 0;
+
+        while ((run < len) && (text[run] != '\n') && (text[run] != '\r') &&
+               !(wrap && ((cursor_x + (run + 1) * textsize_x * 6) > _width))) {
+            run++;
+        }
+
+        if (!run) {
+            tft_write_char(*text++);
+            len--;
+            continue;
+        }
+
+        __tft_draw_text(cursor_x, cursor_y, text, run, textcolor, textbgcolor, textsize_x, textsize_y);
+        cursor_x += run * textsize_x * 6;
+        text += run;
+        len -= run;
+
+        if (cursor_y > 320 - textsize_y * 8) {
+            tft_fill_screen(TFT_COLOR_BLACK);
+            cursor_y = 0;
+        }
+    }
+}
+
 void tft_set_text_color(uint16_t c)
 {
     textcolor = textbgcolor = c;
@@ -850,11 +1245,17 @@ void tft_set_text_size(uint8_t s)
     tft_set_text_size_independent(s, s);
 }
 
-void tft_printf(char *format, ...)
+#define TFT_PRINTF_BUFFER       48      // Characters collected before they are drawn
+
+typedef void (*TFT_Text_Sink)(const char *text, int len);
+
+#define TFT_FORMAT_PUT(c)       do { if (n_text == size) { if (!flush) break; flush(text, n_text); n_text = 0; } text[n_text++] = (c); } while (0)
+
+// Formats %c, %%, %d and %u into text, handed to flush each time it fills up or cut short without one, returns the characters left in it
+static int __tft_vformat(char *text, int size, TFT_Text_Sink flush, const char *format, va_list argp)
 {
-    va_list argp;
-    va_start(argp, format);
-    
+    int n_text = 0;
+
     while (*format != '\0')
     {
         if (*format == '%')
@@ -862,88 +1263,1288 @@ void tft_printf(char *format, ...)
             format++;
             if (*format == '%')
             {
-                tft_write_char('%');
+                TFT_FORMAT_PUT('%');
             } else if (*format == 'c')
             {
                 char char_to_print = va_arg(argp, int);
-                tft_write_char(char_to_print);
+                TFT_FORMAT_PUT(char_to_print);
+            } else if ((*format == 'd') || (*format == 'u'))
+            {
+                char digits[10];
+                int n_digits = 0;
+                unsigned int value;
+
+                if (*format == 'd') {
+                    int signed_value = va_arg(argp, int);
+
+                    if (signed_value < 0) {
+                        TFT_FORMAT_PUT('-');
+                    }
+                    value = (signed_value < 0) ? -(unsigned int)signed_value : (unsigned int)signed_value;
+                } else {
+                    value = va_arg(argp, unsigned int);
+                }
+
+                do {
+                    digits[n_digits++] = '0' + value % 10;
+                    value /= 10;
+                } while (value);
+
+                while (n_digits) {
+                    TFT_FORMAT_PUT(digits[--n_digits]);
+                }
             }
         } else
         {
-            tft_write_char(*format);
+            TFT_FORMAT_PUT(*format);
         }
         
         format++;
     }
-    
+
+    return n_text;
+}
+
+void tft_printf(char *format, ...)
+{
+    char text[TFT_PRINTF_BUFFER];
+    int n_text;
+    va_list argp;
+    va_start(argp, format);
+
+    n_text = __tft_vformat(text, sizeof (text), __tft_write_text, format, argp);
+
     va_end(argp);
+
+    __tft_write_text(text, n_text);
 }
 
 /*******************************************************
- * Image Rendering
+ * HUD Overlay
+ *
+ * Text, crosshairs, markers and bitmaps laid over the
+ * images as they are sent, one line at a time, so an
+ * overlay pixel costs no more bus time than the image
+ * pixel it replaces and never flickers. Each render
+ * latches the items when it starts, changes made while
+ * one is in flight show from the next. Coordinates are
+ * screen coordinates; lines that nothing covers are sent
+ * straight from the image as before.
  *******************************************************/
+#define TFT_HUD_ITEMS           12
+#define TFT_HUD_BITMAP_PIXELS   2048    // Bitmap cache shared by all bitmap items
+#define TFT_HUD_CROSSHAIR_GAP   2       // Pixels left clear around the crosshair centre
 
-uint16_t tft_color_u16(uint8_t r, uint8_t g, uint8_t b)
+#define TFT_HUD_TEXT            0
+#define TFT_HUD_CROSSHAIR       1
+#define TFT_HUD_MARKER          2
+#define TFT_HUD_BITMAP          3
+
+typedef struct
 {
-    return (uint16_t)((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    uint8_t Type;
+    uint8_t Visible;
+    uint8_t Size;           // Text scale, crosshair arm or marker radius
+    uint8_t Length;         // Text characters
+    int16_t X;              // Top left of the bounding box
+    int16_t Y;
+    uint16_t Width;
+    uint16_t Height;
+    uint16_t Color;         // Wire order
+    uint16_t Bg;            // Wire order, text is transparent when equal to Color
+    uint32_t Stamp;         // Changes with every edit, for delta rendering
+    uint16_t *Pixels;       // Bitmap, wire order
+    char Text[TFT_HUD_TEXT_MAX];
+} TFT_Hud_Item;
+
+static TFT_Hud_Item hud_items[TFT_HUD_ITEMS];
+static uint8_t hud_count = 0;
+static uint32_t hud_stamp = 0;
+static uint8_t hud_changed = 0;
+static TFT_Hud_Item hud_frame[TFT_HUD_ITEMS];      // Visible items, as latched by the render in flight
+static uint8_t hud_frame_count = 0;
+static uint16_t hud_bitmap_cache[TFT_HUD_BITMAP_PIXELS];
+static uint16_t hud_bitmap_used = 0;
+static uint16_t hud_line[TFT_LINE_MAX] BSP_DMA_BUFFER;
+
+static int __tft_hud_add(uint8_t type, int16_t x, int16_t y, uint16_t width, uint16_t height, uint16_t color)
+{
+    TFT_Hud_Item *item = &hud_items[hud_count];
+
+    if (hud_count == TFT_HUD_ITEMS) {
+        return TFT_HUD_NONE;
+    }
+
+    item->Type = type;
+    item->Visible = 1;
+    item->Size = 1;
+    item->Length = 0;
+    item->X = x;
+    item->Y = y;
+    item->Width = width;
+    item->Height = height;
+    item->Color = TFT_SWAP16(color);
+    item->Bg = item->Color;
+    item->Stamp = ++hud_stamp;
+    item->Pixels = 0;
+    hud_changed = 1;
+
+    return hud_count++;
 }
 
-void __tft_write_pixel_buffer(uint16_t *colors, uint32_t len) {
+static TFT_Hud_Item *__tft_hud_item(int item)
+{
+    if ((item < 0) || (item >= hud_count)) {
+        return 0;
+    }
 
-    if (!len)
-        return; // Avoid 0-byte transfers
+    return &hud_items[item];
+}
 
-    while (len--) {
-        SPI_WRITE16(*colors++);
+// Marks an item changed, delta rendering then resends the tiles under it
+static void __tft_hud_edit(TFT_Hud_Item *item)
+{
+    item->Stamp = ++hud_stamp;
+    hud_changed = 1;
+}
+
+// Text item, transparent when bg equals color
+int tft_hud_add_text(int16_t x, int16_t y, uint8_t size, uint16_t color, uint16_t bg)
+{
+    int item = __tft_hud_add(TFT_HUD_TEXT, x, y, 0, 8 * size, color);
+
+    if (item != TFT_HUD_NONE) {
+        hud_items[item].Size = size;
+        hud_items[item].Bg = TFT_SWAP16(bg);
     }
+
+    return item;
 }
 
-void tft_render_image_raw(uint8_t *data, int x, int y, int width, int height)
+// A plus centred on (x, y), arm pixels on each side
+int tft_hud_add_crosshair(int16_t x, int16_t y, uint8_t arm, uint16_t color)
 {
-    /*
-    uint8_t r;
-    uint8_t g;
-    uint8_t b;
-    
-    uint16_t *color_buffer = (uint16_t *)malloc(sizeof(uint16_t) * width * height);
-    
-    startWrite();
-    setAddrWindow(x, y, width, height);
+    int item = __tft_hud_add(TFT_HUD_CROSSHAIR, x - arm, y - arm, 2 * arm + 1, 2 * arm + 1, color);
 
-    int pos = 0;
-    for (int i = 0; i < 3 * height * width; i += 3) {
-        r = data[i];
-        g = data[i + 1];
-        b = data[i + 2];
-        
-        color_buffer[pos++] = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+    if (item != TFT_HUD_NONE) {
+        hud_items[item].Size = arm;
     }
-    
-    __tft_write_pixel_buffer(color_buffer, width * height);
-    endWrite();
-    
-    free(color_buffer);
-     */
+
+    return item;
 }
 
-void tft_render_image(TFT_Image image, int x, int y)
+// A hollow square centred on (x, y)
+int tft_hud_add_marker(int16_t x, int16_t y, uint8_t radius, uint16_t color)
 {
-    static uint16_t pixbuf[240 * 320];
-    
-    startWrite();
-    setAddrWindow(x, y, image.Width, image.Height);
+    int item = __tft_hud_add(TFT_HUD_MARKER, x - radius, y - radius, 2 * radius + 1, 2 * radius + 1, color);
 
-    uint16_t *pix_ptr = pixbuf;
-    uint16_t* data_ptr = (uint16_t *)image.Data;
-    uint16_t *data_end = data_ptr + image.Height * image.Width; 
-    
-    while (data_ptr != data_end) {
-        *pix_ptr++ = *data_ptr++;
+    if (item != TFT_HUD_NONE) {
+        hud_items[item].Size = radius;
     }
 
-    __tft_write_pixel_buffer(pixbuf, image.Height * image.Width);
-    
-    endWrite();
+    return item;
+}
+
+// Reserves a cached bitmap, to be filled through tft_hud_bitmap()
+int tft_hud_add_bitmap(int16_t x, int16_t y, uint16_t width, uint16_t height)
+{
+    int item;
+
+    if ((uint32_t)width * height > (uint32_t)(TFT_HUD_BITMAP_PIXELS - hud_bitmap_used)) {
+        return TFT_HUD_NONE;
+    }
+
+    item = __tft_hud_add(TFT_HUD_BITMAP, x, y, width, height, 0);
+
+    if (item != TFT_HUD_NONE) {
+        hud_items[item].Pixels = &hud_bitmap_cache[hud_bitmap_used];
+        hud_bitmap_used += width * height;
+    }
+
+    return item;
+}
+
+// The bitmap pixels of an item to fill, in wire order; the item counts as changed
+TFT_Image tft_hud_bitmap(int item)
+{
+    if ((item < 0) || (item >= hud_count) || (hud_items[item].Type != TFT_HUD_BITMAP)) {
+        return TFT_IMAGE(0, 0, 0, 0);
+    }
+
+    // The pixels are read while frames are sent
+    tft_render_wait();
+    __tft_hud_edit(&hud_items[item]);
+
+    return TFT_IMAGE(hud_items[item].Pixels, hud_items[item].Width, hud_items[item].Height, hud_items[item].Width);
+}
+
+// Setting the text already shown is free
+void tft_hud_set_text(int item, const char *text)
+{
+    TFT_Hud_Item *hud = __tft_hud_item(item);
+    uint8_t length = 0;
+
+    if (!hud || (hud->Type != TFT_HUD_TEXT)) {
+        return;
+    }
+
+    while ((length < hud->Length) && (text[length] == hud->Text[length])) {
+        length++;
+    }
+
+    if ((length == hud->Length) && ((length == TFT_HUD_TEXT_MAX) || !text[length])) {
+        return;
+    }
+
+    __tft_hud_edit(hud);
+
+    for (hud->Length = 0; (hud->Length < TFT_HUD_TEXT_MAX) && text[hud->Length]; hud->Length++) {
+        hud->Text[hud->Length] = text[hud->Length];
+    }
+
+    hud->Width = hud->Length * 6 * hud->Size;
+}
+
+void tft_hud_printf(int item, char *format, ...)
+{
+    char text[TFT_HUD_TEXT_MAX + 1];
+    int n_text;
+    va_list argp;
+    va_start(argp, format);
+
+    n_text = __tft_vformat(text, TFT_HUD_TEXT_MAX, 0, format, argp);
+
+    va_end(argp);
+
+    text[n_text] = '\0';
+    tft_hud_set_text(item, text);
+}
+
+// Moves the centre of crosshairs and markers, the top left corner of the others
+void tft_hud_move(int item, int16_t x, int16_t y)
+{
+    TFT_Hud_Item *hud = __tft_hud_item(item);
+
+    if (!hud) {
+        return;
+    }
+
+    if ((hud->Type == TFT_HUD_CROSSHAIR) || (hud->Type == TFT_HUD_MARKER)) {
+        x -= hud->Size;
+        y -= hud->Size;
+    }
+
+    if ((hud->X != x) || (hud->Y != y)) {
+        __tft_hud_edit(hud);
+        hud->X = x;
+        hud->Y = y;
+    }
+}
+
+void tft_hud_show(int item, uint8_t visible)
+{
+    TFT_Hud_Item *hud = __tft_hud_item(item);
+
+    if (hud && (hud->Visible != visible)) {
+        __tft_hud_edit(hud);
+        hud->Visible = visible;
+    }
+}
+
+void tft_hud_clear()
+{
+    hud_count = 0;
+    hud_bitmap_used = 0;
+    hud_changed = 1;
+}
+
+// Takes the items the next render composites, once the previous one is out
+static void __tft_hud_latch(void)
+{
+    tft_render_wait();
+
+    if (!hud_changed) {
+        return;
+    }
+
+    hud_frame_count = 0;
+    for (int i = 0; i < hud_count; i++) {
+        if (hud_items[i].Visible && hud_items[i].Width && hud_items[i].Height) {
+            hud_frame[hud_frame_count++] = hud_items[i];
+        }
+    }
+
+    hud_changed = 0;
+}
+
+static inline uint8_t __tft_hud_hits(const TFT_Hud_Item *item, int x, int y, int width, int height)
+{
+    return (item->X < x + width) && (x < item->X + item->Width) &&
+           (item->Y < y + height) && (y < item->Y + item->Height);
+}
+
+// Whether any latched item covers part of the window
+static uint8_t __tft_hud_touches(int x, int y, int width, int height)
+{
+    for (int i = 0; i < hud_frame_count; i++) {
+        if (__tft_hud_hits(&hud_frame[i], x, y, width, height)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+// Combined stamp of the items covering part of the window, 0 when none does
+static uint32_t __tft_hud_stamp(int x, int y, int width, int height)
+{
+    uint32_t stamp = 0;
+
+    for (int i = 0; i < hud_frame_count; i++) {
+        if (__tft_hud_hits(&hud_frame[i], x, y, width, height)) {
+            stamp = (stamp ^ hud_frame[i].Stamp) * 16777619u;
+        }
+    }
+
+    return stamp;
+}
+
+// Lays the latched items over line, screen row y from column x, wire order
+static void __tft_hud_compose(uint16_t *line, int x, int y, int width)
+{
+    for (int i = 0; i < hud_frame_count; i++) {
+        const TFT_Hud_Item *item = &hud_frame[i];
+        int row = y - item->Y;
+        int from = (item->X > x) ? item->X : x;
+        int to = (item->X + item->Width < x + width) ? item->X + item->Width : x + width;
+
+        if ((row < 0) || (row >= item->Height) || (from >= to)) {
+            continue;
+        }
+
+        switch (item->Type) {
+            case TFT_HUD_TEXT: {
+                uint8_t mask = 1 << (row / item->Size);
+
+                for (int px = from; px < to; px++) {
+                    int column = (px - item->X) / item->Size;
+                    int glyph_column = column % 6;
+
+                    if ((glyph_column < 5) && (font[__tft_glyph(item->Text[column / 6]) * 5 + glyph_column] & mask)) {
+                        line[px - x] = item->Color;
+                    } else if (item->Bg != item->Color) {
+                        line[px - x] = item->Bg;
+                    }
+                }
+                break;
+            }
+
+            case TFT_HUD_CROSSHAIR: {
+                int dy = row - item->Size;
+
+                if (dy == 0) {
+                    for (int px = from; px < to; px++) {
+                        int dx = px - item->X - item->Size;
+
+                        if ((dx > TFT_HUD_CROSSHAIR_GAP) || (dx < -TFT_HUD_CROSSHAIR_GAP)) {
+                            line[px - x] = item->Color;
+                        }
+                    }
+                } else if (((dy > TFT_HUD_CROSSHAIR_GAP) || (dy < -TFT_HUD_CROSSHAIR_GAP)) &&
+                           (from <= item->X + item->Size) && (item->X + item->Size < to)) {
+                    line[item->X + item->Size - x] = item->Color;
+                }
+                break;
+            }
+
+            case TFT_HUD_MARKER:
+                if ((row == 0) || (row == item->Height - 1)) {
+                    for (int px = from; px < to; px++) {
+                        line[px - x] = item->Color;
+                    }
+                } else {
+                    if (from == item->X) {
+                        line[from - x] = item->Color;
+                    }
+                    if (to == item->X + item->Width) {
+                        line[to - 1 - x] = item->Color;
+                    }
+                }
+                break;
+
+            case TFT_HUD_BITMAP: {
+                const uint16_t *src = item->Pixels + row * item->Width + (from - item->X);
+
+                for (int px = from; px < to; px++) {
+                    line[px - x] = *src++;
+                }
+                break;
+            }
+        }
+    }
+}
+
+/*******************************************************
+ * Image Rendering
+ *******************************************************/
+
+uint16_t tft_color_u16(uint8_t r, uint8_t g, uint8_t b)
+{
+    return (uint16_t)((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+}
+
+void __tft_write_pixel_buffer(uint16_t *colors, uint32_t len) {
+
+    if (!len)
+        return; // Avoid 0-byte transfers
+
+#ifdef TFT_CONFIG_RGB444
+    while (len) {
+        uint16_t n = (len > TFT_LINE_MAX) ? TFT_LINE_MAX : len;
+
+        for (uint16_t i = 0; i < n; i++) {
+            pack_line[i] = TFT_RGB444(colors[i]);
+        }
+        __tft_pack_write(pack_line, 1, n);
+
+        colors += n;
+        len -= n;
+    }
+    return;
+#endif
+
+#ifdef TFT_CONFIG_SPI_STREAM_WIDTH
+    if (len >= TFT_STREAM_MIN_PIXELS) {
+        __tft_stream_begin();
+#if TFT_CONFIG_SPI_STREAM_WIDTH == 32
+        for (; len >= 2; len -= 2, colors += 2) {
+            __tft_stream_write(((uint32_t)colors[0] << 16) | colors[1]);
+        }
+#else
+        for (; len; len--) {
+            __tft_stream_write(*colors++);
+        }
+#endif
+        __tft_stream_end();
+    }
+#endif
+
+    while (len--) {
+        SPI_WRITE16(*colors++);
+    }
+}
+
+// Sends pixels already stored in wire order, the words are swapped back since SPI shifts out the MSB first
+void __tft_write_wire_buffer(uint16_t *colors, uint32_t len) {
+
+    if (!len)
+        return; // Avoid 0-byte transfers
+
+#ifdef TFT_CONFIG_RGB444
+    __tft_pack_wire(colors, len);
+    return;
+#endif
+
+#ifdef TFT_CONFIG_SPI_STREAM_WIDTH
+    if (len >= TFT_STREAM_MIN_PIXELS) {
+        __tft_stream_begin();
+#if TFT_CONFIG_SPI_STREAM_WIDTH == 32
+        for (; len >= 2; len -= 2, colors += 2) {
+            __tft_stream_write(((uint32_t)TFT_SWAP16(colors[0]) << 16) | TFT_SWAP16(colors[1]));
+        }
+#else
+        for (; len; len--, colors++) {
+            __tft_stream_write(TFT_SWAP16(*colors));
+        }
+#endif
+        __tft_stream_end();
+    }
+#endif
+
+#if BSP_TFT_BUS_WIDTH == 16
+    for (; len; len--, colors++) {
+        SPI_WRITE16(TFT_SWAP16(*colors));
+    }
+#else
+    uint8_t *bytes = (uint8_t *)colors;
+    uint8_t *bytes_end = bytes + 2 * len;
+
+    while (bytes != bytes_end) {
+        spiWrite(*bytes++);
+    }
+#endif
+}
+
+// Sends a strided window of wire-order pixels as one stream, without restarting it per row
+void __tft_write_wire_rows(const uint16_t *row, uint16_t width, uint16_t height, uint16_t stride) {
+
+    if (stride == width) {
+        __tft_write_wire_buffer((uint16_t *)row, (uint32_t)width * height);
+        return;
+    }
+
+#ifdef TFT_CONFIG_RGB444
+    for (; height; height--, row += stride) {
+        __tft_pack_wire(row, width);
+    }
+    return;
+#endif
+
+#ifdef TFT_CONFIG_SPI_STREAM_WIDTH
+    if (width >= TFT_STREAM_MIN_PIXELS) {
+        __tft_stream_begin();
+#if TFT_CONFIG_SPI_STREAM_WIDTH == 32
+        uint32_t pending = 0;
+        uint8_t has_pending = 0;
+
+        // Pixel pairs may straddle two rows
+        for (; height; height--, row += stride) {
+            for (uint16_t i = 0; i < width; i++) {
+                uint16_t color = TFT_SWAP16(row[i]);
+
+                if (has_pending) {
+                    __tft_stream_write((pending << 16) | color);
+                } else {
+                    pending = color;
+                }
+                has_pending ^= 1;
+            }
+        }
+        __tft_stream_end();
+
+        if (has_pending) {
+            SPI_WRITE16(pending);
+        }
+#else
+        for (; height; height--, row += stride) {
+            for (uint16_t i = 0; i < width; i++) {
+                __tft_stream_write(TFT_SWAP16(row[i]));
+            }
+        }
+        __tft_stream_end();
+#endif
+        return;
+    }
+#endif
+
+    for (; height; height--, row += stride) {
+        __tft_write_wire_buffer((uint16_t *)row, width);
+    }
+}
+
+// Sends a strided window of 8-bit pixels, each looked up in the wire-order palette on its way out
+void __tft_write_indexed_rows(const uint8_t *row, const uint16_t *palette, uint16_t width, uint16_t height, uint16_t stride) {
+    static uint16_t line[TFT_LINE_MAX];
+
+#ifdef TFT_CONFIG_RGB444
+    const uint16_t *packed = __tft_pack_palette(palette);
+
+    for (; height; height--, row += stride) {
+        for (uint16_t done = 0; done < width; ) {
+            uint16_t len = (width - done > TFT_LINE_MAX) ? TFT_LINE_MAX : width - done;
+
+            for (uint16_t i = 0; i < len; i++) {
+                pack_line[i] = packed[row[done + i]];
+            }
+            __tft_pack_write(pack_line, 1, len);
+            done += len;
+        }
+    }
+    return;
+#endif
+
+#ifdef TFT_CONFIG_SPI_STREAM_WIDTH
+    if ((uint32_t)width * height >= TFT_STREAM_MIN_PIXELS) {
+        __tft_stream_begin();
+#if TFT_CONFIG_SPI_STREAM_WIDTH == 32
+        uint32_t pending = 0;
+        uint8_t has_pending = 0;
+
+        // Pixel pairs may straddle two rows
+        for (; height; height--, row += stride) {
+            for (uint16_t i = 0; i < width; i++) {
+                uint16_t color = TFT_SWAP16(palette[row[i]]);
+
+                if (has_pending) {
+                    __tft_stream_write((pending << 16) | color);
+                } else {
+                    pending = color;
+                }
+                has_pending ^= 1;
+            }
+        }
+        __tft_stream_end();
+
+        if (has_pending) {
+            SPI_WRITE16(pending);
+        }
+#else
+        for (; height; height--, row += stride) {
+            for (uint16_t i = 0; i < width; i++) {
+                __tft_stream_write(TFT_SWAP16(palette[row[i]]));
+            }
+        }
+        __tft_stream_end();
+#endif
+        return;
+    }
+#endif
+
+    for (; height; height--, row += stride) {
+        for (uint16_t done = 0; done < width; ) {
+            uint16_t len = (width - done > TFT_LINE_MAX) ? TFT_LINE_MAX : width - done;
+
+            for (uint16_t i = 0; i < len; i++) {
+                line[i] = palette[row[done + i]];
+            }
+            __tft_write_wire_buffer(line, len);
+            done += len;
+        }
+    }
+}
+
+// Renders packed RGB888 data, converted one row at a time into a short line buffer
+void tft_render_image_raw(uint8_t *data, int x, int y, int width, int height)
+{
+    static uint16_t line[TFT_LINE_MAX];
+
+    if ((width <= 0) || (width > TFT_LINE_MAX) || (height <= 0))
+        return;
+
+    startWrite();
+    setAddrWindow(x, y, width, height);
+
+    for (int row = 0; row < height; row++) {
+        for (int i = 0; i < width; i++, data += 3) {
+            line[i] = TFT_RGB565_WIRE(data[0], data[1], data[2]);
+        }
+
+        __tft_write_wire_buffer(line, width);
+    }
+
+    endWrite();
+}
+
+// Narrows an image to a window of itself, sharing the pixel buffer
+TFT_Image tft_image_crop(TFT_Image image, int x, int y, int width, int height)
+{
+    if (image.Palette) {
+        image.Indices += y * image.Stride + x;
+    } else {
+        image.Data += y * image.Stride + x;
+    }
+    image.Width = width;
+    image.Height = height;
+
+    return image;
+}
+
+// One image row as wire-order pixels, expanded into the line buffer given when the image is indexed
+static const uint16_t *__tft_image_row(TFT_Image image, int row, uint16_t *line)
+{
+    const uint8_t *src;
+
+    if (!image.Palette) {
+        return image.Data + row * image.Stride;
+    }
+
+    src = image.Indices + row * image.Stride;
+    for (uint16_t i = 0; i < image.Width; i++) {
+        line[i] = image.Palette[src[i]];
+    }
+
+    return line;
+}
+
+// Sends rows of the image as they are, from the given one on
+static void __tft_write_image_rows(TFT_Image image, int row, uint16_t rows)
+{
+    if (image.Palette) {
+        __tft_write_indexed_rows(image.Indices + row * image.Stride, image.Palette, image.Width, rows, image.Stride);
+    } else {
+        __tft_write_wire_rows(image.Data + row * image.Stride, image.Width, rows, image.Stride);
+    }
+}
+
+// Streams the image placed at (x, y) into the open window, rows under the overlay go through the line buffer
+static void __tft_write_image(TFT_Image image, int x, int y)
+{
+    uint16_t rows = 0;
+
+    if ((image.Width > TFT_LINE_MAX) || !__tft_hud_touches(x, y, image.Width, image.Height)) {
+        __tft_write_image_rows(image, 0, image.Height);
+        return;
+    }
+
+    for (uint16_t r = 0; r <= image.Height; r++) {
+        if ((r < image.Height) && !__tft_hud_touches(x, y + r, image.Width, 1)) {
+            rows++;
+            continue;
+        }
+
+        // Rows nothing covers go out together
+        if (rows) {
+            __tft_write_image_rows(image, r - rows, rows);
+            rows = 0;
+        }
+
+        if (r < image.Height) {
+            const uint16_t *row = __tft_image_row(image, r, hud_line);
+
+            if (row != hud_line) {
+                for (uint16_t i = 0; i < image.Width; i++) {
+                    hud_line[i] = row[i];
+                }
+            }
+            __tft_hud_compose(hud_line, x, y + r, image.Width);
+            __tft_write_wire_buffer(hud_line, image.Width);
+        }
+    }
+}
+
+// Streams straight from the image buffer
+void tft_render_image(TFT_Image image, int x, int y)
+{
+    __tft_hud_latch();
+
+    startWrite();
+    setAddrWindow(x, y, image.Width, image.Height);
+
+    __tft_write_image(image, x, y);
+
+    endWrite();
+}
+
+/*******************************************************
+ * Asynchronous Image Rendering
+ *
+ * The image is sent by DMA straight from the caller's
+ * buffer, which must stay untouched until the render
+ * completes. Each row, or the whole image when its rows
+ * are contiguous, is sent in blocks of at most one DMA
+ * transfer, chained from the completion interrupt. A new
+ * render, or any other drawing, first waits for the
+ * pending one. Rows under the HUD overlay are composited
+ * into the line buffer by the interrupt and sent from it,
+ * as are all rows of an indexed image, expanded through
+ * its palette on the way. In RGB444, or on a 16-bit bus
+ * where the DMA reads native halfwords, every row is
+ * converted into a buffer of its own first.
+ *******************************************************/
+static volatile uint8_t render_busy = 0;
+static const uint8_t *render_row;
+static const uint8_t *render_next;
+static uint32_t render_row_bytes;
+static uint32_t render_row_remaining;
+static uint32_t render_stride_bytes;
+static uint16_t render_rows;                // Rows left after the current one
+static uint8_t render_compose;              // Row by row, through the overlay
+static const uint16_t *render_palette;      // Row by row, expanding 8-bit pixels
+static int16_t render_x;
+static int16_t render_y;                    // Screen row of the current row
+static uint16_t render_width;
+static TFT_Render_Callback render_on_complete;
+
+#if defined(TFT_CONFIG_RGB444) || (BSP_TFT_BUS_WIDTH == 16)
+#define TFT_RENDER_CONVERTS     1       // No row goes out straight from the image
+#else
+#define TFT_RENDER_CONVERTS     0
+#endif
+
+#if BSP_TFT_BUS_WIDTH == 16
+static uint16_t render_native[TFT_LINE_MAX] BSP_DMA_BUFFER;
+#endif
+
+static void __tft_render_next_block(void)
+{
+    uint16_t len;
+
+    if (!render_row_remaining) {
+        render_rows--;
+        render_row += render_stride_bytes;
+        render_next = render_row;
+        render_row_remaining = render_row_bytes;
+        render_y++;
+    }
+
+    if (render_next == render_row) {
+        uint8_t covered = render_compose && __tft_hud_touches(render_x, render_y, render_width, 1);
+
+        if (render_palette) {
+            for (uint16_t i = 0; i < render_width; i++) {
+                hud_line[i] = render_palette[render_row[i]];
+            }
+        } else if (covered) {
+            const uint16_t *src = (const uint16_t *)render_row;
+
+            for (uint16_t i = 0; i < render_width; i++) {
+                hud_line[i] = src[i];
+            }
+        }
+
+        if (covered) {
+            __tft_hud_compose(hud_line, render_x, render_y, render_width);
+        }
+
+#if defined(TFT_CONFIG_RGB444)
+        render_row_remaining = __tft_pack_row((render_palette || covered) ? hud_line : (const uint16_t *)render_row, render_width, !render_rows);
+        render_next = pack_dma;
+#elif BSP_TFT_BUS_WIDTH == 16
+        const uint16_t *src = (render_palette || covered) ? hud_line : (const uint16_t *)render_row;
+
+        for (uint16_t i = 0; i < render_width; i++) {
+            render_native[i] = TFT_SWAP16(src[i]);
+        }
+        render_next = (const uint8_t *)render_native;
+#else
+        if (render_palette || covered) {
+            render_next = (const uint8_t *)hud_line;
+        }
+#endif
+    }
+
+    len = (render_row_remaining > BSP_TFT_DMA_MAX_LEN) ? BSP_TFT_DMA_MAX_LEN : render_row_remaining;
+
+    render_row_remaining -= len;
+    spi_bytes += len;
+    BSP_TFT_DMA_Start(render_next, len);
+    render_next += len;
+}
+
+static void __tft_render_on_dma_complete(void)
+{
+    if (render_row_remaining || render_rows) {
+        __tft_render_next_block();
+        return;
+    }
+
+    endWrite();
+    render_busy = 0;
+
+    if (render_on_complete) {
+        render_on_complete();
+    }
+}
+
+// Sends the image by DMA into the address window already open at (x, y), CS is released on completion
+static void __tft_render_dma(TFT_Image image, int x, int y, uint8_t compose, TFT_Render_Callback on_complete)
+{
+    render_on_complete = on_complete;
+
+    if (!image.Width || !image.Height) {
+        endWrite();
+        if (on_complete) {
+            on_complete();
+        }
+        return;
+    }
+
+    if ((image.Palette || TFT_RENDER_CONVERTS) && (image.Width > TFT_LINE_MAX)) {
+        __tft_write_image_rows(image, 0, image.Height);
+        endWrite();
+        if (on_complete) {
+            on_complete();
+        }
+        return;
+    }
+
+    render_palette = image.Palette;
+    render_row = image.Palette ? image.Indices : (const uint8_t *)image.Data;
+    render_next = render_row;
+    render_stride_bytes = (image.Palette ? 1 : 2) * (uint32_t)image.Stride;
+    render_compose = compose && (image.Width <= TFT_LINE_MAX) && __tft_hud_touches(x, y, image.Width, image.Height);
+    render_x = x;
+    render_y = y;
+    render_width = image.Width;
+
+#if TFT_RENDER_CONVERTS
+    // Every row is converted on its way, a packed one sets its length then
+    render_row_bytes = TFT_PIXEL_BYTES(image.Width);
+    render_rows = image.Height - 1;
+#else
+    if ((image.Stride == image.Width) && !render_compose && !render_palette) {
+        render_row_bytes = 2 * (uint32_t)image.Width * image.Height;
+        render_rows = 0;
+    } else {
+        render_row_bytes = 2 * (uint32_t)image.Width;
+        render_rows = image.Height - 1;
+    }
+#endif
+
+    render_row_remaining = render_row_bytes;
+    render_busy = 1;
+    __tft_render_next_block();
+}
+
+void tft_render_image_async(TFT_Image image, int x, int y, TFT_Render_Callback on_complete)
+{
+    __tft_hud_latch();
+
+    startWrite();
+    setAddrWindow(x, y, image.Width, image.Height);
+
+    __tft_render_dma(image, x, y, 1, on_complete);
+}
+
+uint32_t tft_spi_byte_count()
+{
+    return spi_bytes;
+}
+
+uint8_t tft_render_busy()
+{
+    return render_busy;
+}
+
+void tft_render_wait()
+{
+    while (render_busy) {
+#ifdef BSP_CONFIG_HOST
+        BSP_Host_Poll(); // No DMA interrupts on the host, the capture goes on while the transfer completes
+#endif
+    }
+}
+
+/*******************************************************
+ * Upscaled Image Rendering
+ *
+ * Renders the image 1.5 times larger, every 2 source
+ * pixels giving 3 on screen in both directions. Output
+ * lines are built one at a time into two line buffers:
+ * while the DMA sends one, the next is being built. CS
+ * is released between lines, the RAM write resumes.
+ *
+ * Bilinear blends RGB565 in a spread form, the three
+ * fields of a pixel 5 bits apart in one word, so a pair
+ * is weighted with 2 multiplies. The 1/3 and 2/3 taps
+ * are 11/32 and 21/32; rows at the image edge repeat.
+ * An image sent in strips, TFT_SCALE_CONTINUED on all
+ * but the last, holds back the last line of each strip
+ * until the next one brings the source row it blends
+ * with, so no seam shows between them; a strip not
+ * followed right below flushes it with the row repeated.
+ * The HUD overlay is laid over each line once scaled.
+ * Indexed source rows are expanded as they are read.
+ *******************************************************/
+#define TFT_SPREAD_MASK         0x07E0F81Fu
+#define TFT_SPREAD_ROUND        0x02008010u // Half an LSB in each field, for the >> 5
+#define TFT_SPREAD(c)           (((((uint32_t)(c)) << 16) | (c)) & TFT_SPREAD_MASK)
+#define TFT_UNSPREAD(s)         ((uint16_t)(((s) & 0xF81F) | (((s) >> 16) & 0x07E0)))
+#define TFT_BLEND_1_3(a, b)     (((11 * (a) + 21 * (b) + TFT_SPREAD_ROUND) >> 5) & TFT_SPREAD_MASK)
+
+static uint16_t scale_lines[2][TFT_LINE_MAX] BSP_DMA_BUFFER;
+static uint32_t scale_rows[3][TFT_LINE_MAX];    // Horizontally scaled source rows, spread
+static int16_t scale_row_source[3];             // Source row held by each slot
+static uint16_t scale_source[TFT_LINE_MAX];     // An indexed source row, expanded
+static uint32_t scale_held[TFT_LINE_MAX];       // Last source row of a continued strip, spread
+static int scale_held_x, scale_held_y = -1;     // Where its line goes, y -1 for none
+static uint16_t scale_held_width;
+
+// One source row scaled horizontally, in spread form, kept in a ring of 3
+static const uint32_t *__tft_scale_row(TFT_Image image, int row)
+{
+    uint32_t *dst = scale_rows[row % 3];
+    const uint16_t *src;
+
+    if (scale_row_source[row % 3] == row) {
+        return dst;
+    }
+
+    src = __tft_image_row(image, row, scale_source);
+
+    for (int i = 0; i < image.Width; i += 2, dst += 3) {
+        uint32_t a = TFT_SPREAD(TFT_SWAP16(src[i]));
+        uint32_t b = TFT_SPREAD(TFT_SWAP16(src[i + 1]));
+        uint32_t c = (i + 2 < image.Width) ? TFT_SPREAD(TFT_SWAP16(src[i + 2])) : b;
+
+        dst[0] = a;
+        dst[1] = TFT_BLEND_1_3(a, b);
+        dst[2] = TFT_BLEND_1_3(c, b);
+    }
+
+    scale_row_source[row % 3] = row;
+
+    return scale_rows[row % 3];
+}
+
+// The held line, blended with the first row of the strip below, or alone at the bottom edge
+static void __tft_scale_held_line(const uint32_t *below, uint16_t *line)
+{
+    for (int i = 0; i < scale_held_width; i++) {
+        line[i] = TFT_SWAP16(TFT_UNSPREAD(below ? TFT_BLEND_1_3(below[i], scale_held[i]) : scale_held[i]));
+    }
+
+    __tft_hud_compose(line, scale_held_x, scale_held_y, scale_held_width);
+}
+
+// Image width and height must be even, the scaled width must fit TFT_LINE_MAX
+void tft_render_image_scaled(TFT_Image image, int x, int y, uint8_t filter)
+{
+    uint8_t hold = (filter == (TFT_SCALE_BILINEAR | TFT_SCALE_CONTINUED));
+    uint16_t width = image.Width * 3 / 2;
+    uint16_t height = image.Height * 3 / 2;
+    uint16_t *line = 0;
+    int held, lines;
+
+    filter &= ~TFT_SCALE_CONTINUED;
+
+    if ((width > TFT_LINE_MAX) || !width || !height || (image.Width & 1) || (image.Height & 1))
+        return;
+
+    for (int slot = 0; slot < 3; slot++) {
+        scale_row_source[slot] = -1;
+    }
+
+    __tft_hud_latch();
+
+    // A held line goes out first when this strip continues its strip, on its own otherwise
+    held = (scale_held_y >= 0) && (filter == TFT_SCALE_BILINEAR) && (x == scale_held_x) && (y == scale_held_y + 1) && (width == scale_held_width);
+
+    if ((scale_held_y >= 0) && !held) {
+        startWrite();
+        setAddrWindow(scale_held_x, scale_held_y, scale_held_width, 1);
+        __tft_scale_held_line(0, scale_lines[0]);
+        __tft_render_dma(TFT_IMAGE(scale_lines[0], scale_held_width, 1, scale_held_width), scale_held_x, scale_held_y, 0, 0);
+    }
+    scale_held_y = -1;
+
+    lines = held + height - hold;
+
+    startWrite();
+    setAddrWindow(x, y - held, width, lines);
+
+    for (int n = 0; n < lines; n++) {
+        int row = n - held;
+        int phase = row % 3;
+        int source = row / 3 * 2 + (phase == 2);
+        uint8_t fresh = (filter == TFT_SCALE_BILINEAR) || (phase != 1) || __tft_hud_touches(x, y + row - 1, width, 2);
+
+        if (row < 0) {
+            // The line held back by the strip above, composed already
+            line = scale_lines[n & 1];
+            __tft_scale_held_line(__tft_scale_row(image, 0), line);
+            fresh = 0;
+        } else if (filter == TFT_SCALE_BILINEAR) {
+            line = scale_lines[n & 1];
+
+            // Only touch the buffer the previous line is not being sent from
+            if (phase == 0) {
+                const uint32_t *a = __tft_scale_row(image, source);
+
+                for (int i = 0; i < width; i++) {
+                    line[i] = TFT_SWAP16(TFT_UNSPREAD(a[i]));
+                }
+            } else {
+                const uint32_t *a = __tft_scale_row(image, source);
+                const uint32_t *b = __tft_scale_row(image, (source + 1 < image.Height) ? source + 1 : source);
+
+                // Phase 1: 1/3 row 2k + 2/3 row 2k+1, phase 2: 2/3 row 2k+1 + 1/3 row 2k+2
+                const uint32_t *third = (phase == 1) ? a : b;
+                const uint32_t *two_thirds = (phase == 1) ? b : a;
+
+                for (int i = 0; i < width; i++) {
+                    line[i] = TFT_SWAP16(TFT_UNSPREAD(TFT_BLEND_1_3(third[i], two_thirds[i])));
+                }
+            }
+        } else if (fresh) {
+            // Nearest: rows 3k and 3k+1 repeat source row 2k, the same line goes out twice unless the overlay differs
+            const uint16_t *src = __tft_image_row(image, source, scale_source);
+
+            line = (line == scale_lines[0]) ? scale_lines[1] : scale_lines[0];
+
+            for (int i = 0, o = 0; i < image.Width; i += 2, o += 3) {
+                line[o] = src[i];
+                line[o + 1] = src[i];
+                line[o + 2] = src[i + 1];
+            }
+        }
+
+        if (fresh) {
+            __tft_hud_compose(line, x, y + row, width);
+        }
+
+        if (n) {
+            tft_render_wait();
+            SPI_CS_LOW();
+        }
+        __tft_render_dma(TFT_IMAGE(line, width, 1, width), x, y + row, 0, 0);
+    }
+
+    if (hold) {
+        // Its source rows are both in the ring, the held one is the last
+        const uint32_t *last = __tft_scale_row(image, image.Height - 1);
+
+        for (int i = 0; i < width; i++) {
+            scale_held[i] = last[i];
+        }
+        scale_held_x = x;
+        scale_held_y = y + height - 1;
+        scale_held_width = width;
+    }
+
+    // The last line is still going out, the next render waits for it
+}
+
+/*******************************************************
+ * Delta Image Rendering
+ *
+ * The image is split into tiles and each tile is hashed.
+ * Only tiles whose hash differs from the last one sent
+ * to the same screen position go out, adjacent changed
+ * tiles of a tile row sharing one address window. When
+ * most tiles changed, the whole image is sent at once.
+ * The hash of a tile covers the HUD items over it, so
+ * an overlay edit resends only the tiles it touches.
+ * For an indexed image it covers the indices and which
+ * palette they go through, switching palettes resends
+ * the whole image.
+ * Drawing anything else over a delta-rendered region
+ * needs tft_delta_invalidate().
+ *******************************************************/
+#define TFT_TILE_WIDTH          16
+#define TFT_TILE_HEIGHT         10      // Divides the 30 rows of a Lepton segment
+#define TFT_TILES_X             (320 / TFT_TILE_WIDTH)      // Covers the panel in any rotation
+#define TFT_TILES_Y             (320 / TFT_TILE_HEIGHT)
+#define TFT_DELTA_FULL_PERCENT  75      // Changed tiles above which the whole image is sent
+#define TFT_WINDOW_BYTES        11      // CASET, RASET and RAMWR with their parameters
+#define TFT_ADDRESS_BYTES       5       // CASET or RASET with its parameters, left out when unchanged
+
+static uint32_t tile_hash[TFT_TILES_Y][TFT_TILES_X];       // 0 until the tile has been sent
+static TFT_Delta_Stats delta_stats;
+
+// FNV-1a over the tile pixels, never 0
+static uint32_t __tft_tile_hash(TFT_Image tile)
+{
+    uint32_t hash = 2166136261u;
+
+    if (tile.Palette) {
+        const uint8_t *row = tile.Indices;
+
+        hash = (hash ^ (uint32_t)(uintptr_t)tile.Palette) * 16777619u;
+        for (uint16_t height = tile.Height; height; height--, row += tile.Stride) {
+            for (uint16_t i = 0; i < tile.Width; i++) {
+                hash = (hash ^ row[i]) * 16777619u;
+            }
+        }
+    } else {
+        const uint16_t *row = tile.Data;
+
+        for (uint16_t height = tile.Height; height; height--, row += tile.Stride) {
+            for (uint16_t i = 0; i < tile.Width; i++) {
+                hash = (hash ^ row[i]) * 16777619u;
+            }
+        }
+    }
+
+    return hash | 1;
+}
+
+// What setAddrWindow() sends for the window, as it stands
+static uint32_t __tft_window_bytes(int x, int y, int width, int height)
+{
+    uint16_t x0 = x + _xstart;
+    uint16_t y0 = y + _ystart;
+    uint32_t xa = ((uint32_t)x0 << 16) | (uint16_t)(x0 + width - 1);
+    uint32_t ya = ((uint32_t)y0 << 16) | (uint16_t)(y0 + height - 1);
+
+    return TFT_WINDOW_BYTES - ((xa == window_xa) ? TFT_ADDRESS_BYTES : 0) - ((ya == window_ya) ? TFT_ADDRESS_BYTES : 0);
+}
+
+void tft_render_image_delta(TFT_Image image, int x, int y)
+{
+    static uint8_t dirty[TFT_TILES_Y][TFT_TILES_X];
+    int tiles_x = (image.Width + TFT_TILE_WIDTH - 1) / TFT_TILE_WIDTH;
+    int tiles_y = (image.Height + TFT_TILE_HEIGHT - 1) / TFT_TILE_HEIGHT;
+    int first_x = x / TFT_TILE_WIDTH;
+    int first_y = y / TFT_TILE_HEIGHT;
+    uint32_t full_bytes = TFT_WINDOW_BYTES + TFT_PIXEL_BYTES((uint32_t)image.Width * image.Height);
+    uint32_t sent_bytes = 0;
+    int n_dirty = 0;
+
+    __tft_hud_latch();
+
+    delta_stats.Frames++;
+
+    // Off the tile grid, nothing to compare against
+    if ((x < 0) || (y < 0) || (first_x + tiles_x > TFT_TILES_X) || (first_y + tiles_y > TFT_TILES_Y)) {
+        tft_render_image(image, x, y);
+        delta_stats.Full_Frames++;
+        delta_stats.Bytes_Sent += full_bytes;
+        return;
+    }
+
+    for (int ty = 0; ty < tiles_y; ty++) {
+        for (int tx = 0; tx < tiles_x; tx++) {
+            TFT_Image tile = tft_image_crop(image, tx * TFT_TILE_WIDTH, ty * TFT_TILE_HEIGHT,
+                                            (tx == tiles_x - 1) ? image.Width - tx * TFT_TILE_WIDTH : TFT_TILE_WIDTH,
+                                            (ty == tiles_y - 1) ? image.Height - ty * TFT_TILE_HEIGHT : TFT_TILE_HEIGHT);
+            uint32_t hash = (__tft_tile_hash(tile) ^
+                             __tft_hud_stamp(x + tx * TFT_TILE_WIDTH, y + ty * TFT_TILE_HEIGHT, tile.Width, tile.Height)) | 1;
+            uint32_t *sent_hash = &tile_hash[first_y + ty][first_x + tx];
+
+            dirty[ty][tx] = (hash != *sent_hash);
+            n_dirty += dirty[ty][tx];
+            *sent_hash = hash;
+        }
+    }
+
+    if (n_dirty * 100 > TFT_DELTA_FULL_PERCENT * tiles_x * tiles_y) {
+        delta_stats.Full_Frames++;
+        delta_stats.Tiles_Sent += tiles_x * tiles_y;
+        delta_stats.Bytes_Sent += full_bytes - TFT_WINDOW_BYTES + __tft_window_bytes(x, y, image.Width, image.Height);
+        tft_render_image(image, x, y);
+        return;
+    }
+
+    startWrite();
+
+    for (int ty = 0; ty < tiles_y; ty++) {
+        for (int tx = 0; tx < tiles_x; ) {
+            int run_start = tx;
+            TFT_Image run;
+
+            if (!dirty[ty][tx]) {
+                tx++;
+                continue;
+            }
+
+            while ((tx < tiles_x) && dirty[ty][tx]) {
+                tx++;
+            }
+
+            run = tft_image_crop(image, run_start * TFT_TILE_WIDTH, ty * TFT_TILE_HEIGHT,
+                                 ((tx == tiles_x) ? image.Width : tx * TFT_TILE_WIDTH) - run_start * TFT_TILE_WIDTH,
+                                 (ty == tiles_y - 1) ? image.Height - ty * TFT_TILE_HEIGHT : TFT_TILE_HEIGHT);
+
+            sent_bytes += __tft_window_bytes(x + run_start * TFT_TILE_WIDTH, y + ty * TFT_TILE_HEIGHT, run.Width, run.Height) +
+                          TFT_PIXEL_BYTES((uint32_t)run.Width * run.Height);
+
+            setAddrWindow(x + run_start * TFT_TILE_WIDTH, y + ty * TFT_TILE_HEIGHT, run.Width, run.Height);
+            __tft_write_image(run, x + run_start * TFT_TILE_WIDTH, y + ty * TFT_TILE_HEIGHT);
+        }
+    }
+
+    endWrite();
+
+    delta_stats.Tiles_Sent += n_dirty;
+    delta_stats.Bytes_Sent += sent_bytes;
+    if (sent_bytes < full_bytes) {
+        delta_stats.Bytes_Saved += full_bytes - sent_bytes;
+    }
+}
+
+void tft_delta_invalidate()
+{
+    for (int ty = 0; ty < TFT_TILES_Y; ty++) {
+        for (int tx = 0; tx < TFT_TILES_X; tx++) {
+            tile_hash[ty][tx] = 0;
+        }
+    }
+}
+
+TFT_Delta_Stats tft_delta_stats()
+{
+    return delta_stats;
 }
 
 #ifdef TFT_CONFIG_USE_SDCARD
@@ -966,7 +2567,7 @@ void tft_render_image_sdcard(char *filename, int x, int y, int width, int height
         } while (bytes_read > 0 && bytes_read < 3 * width);
         bytes_read = 0;
 
-        tft_render_image(buffer, x, y+i, width, 1);
+        tft_render_image_raw(buffer, x, y+i, width, 1);
     }
     
     f_close(&file);
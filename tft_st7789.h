@@ -14,6 +14,8 @@
  * TFT module configuration
  *******************************************************/
 //#define TFT_CONFIG_USE_SDCARD
+#define TFT_CONFIG_SPI_STREAM_WIDTH 32      // Bulk pixel writes in 16 or 32-bit SPI words, comment out for byte writes
+//#define TFT_CONFIG_RGB444                   // 12-bit pixels on the panel (COLMOD 0x53), two in 3 bytes: a quarter less SPI2 traffic
 
 /* End TFT module configuration */
 
@@ -30,19 +32,56 @@
 #define TFT_COLOR_YELLOW    0xFFE0
 #define TFT_COLOR_ORANGE    0xFC00
 
+// Compile-time RGB565, same packing as tft_color_u16()
+#define TFT_RGB565(r, g, b)         ((uint16_t)((((r) & 0xF8) << 8) | (((g) & 0xFC) << 3) | ((b) >> 3)))
+
+// RGB565 in ST7789 wire order (MSB first in memory), as expected in TFT_Image data
+#define TFT_RGB565_WIRE(r, g, b)    ((uint16_t)((TFT_RGB565(r, g, b) >> 8) | (TFT_RGB565(r, g, b) << 8)))
+
 #define TFT_COLOR_LUNAR_BLUE_DARK tft_color_u16(120, 120, 255)
 #define TFT_COLOR_LUNAR_BLUE_LIGHT tft_color_u16(200, 200, 255)
 
 /******************************************************
  * Data Structures
  ******************************************************/
+// A window into a pixel buffer of RGB565 in wire order, see TFT_RGB565_WIRE(),
+// or of 8-bit indices into a palette of such colours, looked up as they are sent
 typedef struct
 {
-    uint8_t Height;
-    uint8_t Width;
-    uint16_t **Data;
+    uint16_t Height;
+    uint16_t Width;
+    uint16_t Stride;            // Pixels from the start of one row to the next
+    uint16_t *Data;             // First pixel of the first row
+    const uint8_t *Indices;     // First pixel of an indexed image, in place of Data
+    const uint16_t *Palette;    // 256 colours of an indexed image, 0 for RGB565 data
 } TFT_Image;
 
+#define TFT_IMAGE(data, width, height, stride) ((TFT_Image) { .Height = (height), .Width = (width), .Stride = (stride), .Data = (data) })
+#define TFT_IMAGE_INDEXED(indices, palette, width, height, stride) \
+    ((TFT_Image) { .Height = (height), .Width = (width), .Stride = (stride), .Indices = (indices), .Palette = (palette) })
+
+// Filters of tft_render_image_scaled()
+#define TFT_SCALE_NEAREST   0
+#define TFT_SCALE_BILINEAR  1
+#define TFT_SCALE_CONTINUED 0x80    // Or'd in: the image goes on right below, its last line waits for it
+
+// Called in interrupt context when an asynchronous render has been sent
+typedef void (*TFT_Render_Callback)(void);
+
+// Delta rendering totals
+typedef struct
+{
+    uint32_t Frames;
+    uint32_t Full_Frames;   // Sent whole, most tiles had changed
+    uint32_t Tiles_Sent;
+    uint32_t Bytes_Sent;    // SPI2 bytes, address windows included
+    uint32_t Bytes_Saved;   // Against sending every frame whole
+} TFT_Delta_Stats;
+
+// HUD overlay items, composited into every image rendered under them
+#define TFT_HUD_NONE        (-1)    // No item, the overlay is full
+#define TFT_HUD_TEXT_MAX    24      // Characters of a text item
+
 void tft_init(uint16_t width, uint16_t height);
 void tft_fill_screen(uint16_t color);
 void tft_fill_rect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
@@ -59,13 +98,32 @@ void tft_set_text_size(uint8_t s);
 void tft_test_bitmap();
 uint16_t tft_color_u16(uint8_t r, uint8_t g, uint8_t b);
 void tft_render_image_raw(uint8_t *data, int x, int y, int width, int height);
+TFT_Image tft_image_crop(TFT_Image image, int x, int y, int width, int height);
 void tft_render_image(TFT_Image image, int x, int y);
+void tft_render_image_async(TFT_Image image, int x, int y, TFT_Render_Callback on_complete);
+uint8_t tft_render_busy();
+void tft_render_wait();
+void tft_render_image_scaled(TFT_Image image, int x, int y, uint8_t filter);
+void tft_render_image_delta(TFT_Image image, int x, int y);
+void tft_delta_invalidate();
+TFT_Delta_Stats tft_delta_stats();
 void tft_printf(char *format, ...);
 uint8_t tft_get_cursor_x();
 uint8_t tft_get_cursor_y();
 uint8_t tft_get_char_pixels_x();
 uint8_t tft_get_char_pixels_y();
 void tft_draw_pixel_buffer(int16_t x, int16_t y, uint16_t color);
+uint32_t tft_spi_byte_count();
+int tft_hud_add_text(int16_t x, int16_t y, uint8_t size, uint16_t color, uint16_t bg);
+int tft_hud_add_crosshair(int16_t x, int16_t y, uint8_t arm, uint16_t color);
+int tft_hud_add_marker(int16_t x, int16_t y, uint8_t radius, uint16_t color);
+int tft_hud_add_bitmap(int16_t x, int16_t y, uint16_t width, uint16_t height);
+TFT_Image tft_hud_bitmap(int item);
+void tft_hud_set_text(int item, const char *text);
+void tft_hud_printf(int item, char *format, ...);
+void tft_hud_move(int item, int16_t x, int16_t y);
+void tft_hud_show(int item, uint8_t visible);
+void tft_hud_clear();
 
 #ifdef TFT_CONFIG_USE_SDCARD
 void tft_render_image_sdcard(char *filename, int x, int y, int width, int height);